@@ -0,0 +1,45 @@
+/**
+ * Helpers shared by the binary file formats of the graphs and of the weighted
+ * digraph's ALT index.
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+
+#include "binary_file.h"
+#include <stdint.h>
+
+
+/**
+ * Rounds x up to a multiple of BINARY_FILE_ALIGNMENT.
+ */
+size_t align_up(size_t x) {
+    return (x + BINARY_FILE_ALIGNMENT - 1) / BINARY_FILE_ALIGNMENT * BINARY_FILE_ALIGNMENT;
+}
+
+
+/**
+ * Checks whether the machine stores numbers little-endian.
+ */
+bool little_endian(void) {
+    uint16_t x = 1;
+    return *((uint8_t*) &x) == 1;
+}
+
+
+/**
+ *      Writes zeros to the file until its size is a multiple of 
+ * BINARY_FILE_ALIGNMENT.
+ *
+ * @param f the file, opened for writing.
+ * @param written number of bytes written to the file so far, since its last
+ * aligned offset.
+ * @return true if the zeros were written; false otherwise.
+ */
+bool write_padding(FILE *f, size_t written)
+{
+    static const char zeros[BINARY_FILE_ALIGNMENT] = {0};
+    size_t pad = align_up(written) - written;
+    return fwrite(zeros, 1, pad, f) == pad;
+}
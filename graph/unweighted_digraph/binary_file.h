@@ -0,0 +1,31 @@
+/**
+ * Helpers shared by the binary file formats of the graphs (see 
+ * graph_save_binary()) and of the weighted digraph's ALT index. The files are
+ * stored little-endian, with sections that start at offsets aligned to 
+ * BINARY_FILE_ALIGNMENT bytes, so they can be mapped into memory and read in
+ * place.
+ *
+ * Example of use:
+ *      if(!little_endian())
+ *          return false;
+ *      ok = fwrite(&header, sizeof(header), 1, f) == 1 && write_padding(f, sizeof(header));
+ *      size_t next_at = align_up(sizeof(header));
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+#ifndef BINARY_FILE_H
+    #define BINARY_FILE_H
+    #include <stdio.h>
+    #include <stdbool.h>
+    #include <stddef.h>
+
+    /* Constants */
+    #define BINARY_FILE_ALIGNMENT 64      // every section of a file starts at a multiple of it
+
+    /* Helpers */
+    size_t align_up(size_t x);
+    bool little_endian(void);
+    bool write_padding(FILE *f, size_t written);
+#endif
@@ -1,20 +1,47 @@
 /**
  * Implementation of an unweighted directed graph. 
  * 
- * Each vertex is identified by it's index in the graph's array of adjacency lists. This array's initial size can be chosen by the client (alternatively, default values can be used, hiding the internal details from the client). Note that when a vertex v has an ID greater than the graph's array of adjacency lists, the array must be expanded (memory reallocation). This might be improved later on through the use of hashing.
+ * Each vertex is identified by it's index in the graph's array of adjacency lists. This array's initial size can be chosen by the client (alternatively, default values can be used, hiding the internal details from the client). Note that when a vertex v has an ID greater than the graph's array of adjacency lists, the array must be expanded (memory reallocation). By default, the array doubles in size each time (so n insertions cost O(n) copies in total); graph_reserve() allocates it ahead of a bulk load and graph_shrink_to_fit() gives the unused memory back.
  * 
- * @todo function to shrink the graph's array of adjacency lists to a desired size.
- * @todo reduce, by the use of hashing, the memory required by the graph to store its adjacency lists.
+ * Optionally (see graph_enable_in_edges()), the graph also keeps, for each vertex, a list with the tails of the edges arriving at it. The index doubles the memory used by the edges, but it makes the removal of a vertex proportional to the degrees of the vertex and of its neighbours (instead of O(|V| + |E|)), turns in-degree queries into O(1) operations and allows reverse traversals (see graph_in_edges()).
  * 
+ * Vertices with sparse identifiers (64-bit keys) should be added through graph_vertex_slot(), which maps each key to the lowest free index (slot) of the array with a hash map (see vertex_map.h): the array's size then depends on the number of vertices, not on the highest key. All the other functions work on the slots.
+ * 
+ * The graph can be saved to a binary file (see graph_save_binary()) and loaded back without parsing text (see graph_load_binary()). The file has the same layout as the one of the weighted digraph (without the weights section).
+ *
  * @version 1.0
  * @author Gabriel Nogueira (Talendar)
  */
 
 
+#define _POSIX_C_SOURCE 200112L
 #include "unweighted_digraph.h"
 #include "singly_linked_list.h"
+#include "vertex_map.h"
+#include "binary_file.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/* Binary file */
+#define GRAPH_FILE_MAGIC "DIGRAPH\0"   // 8 bytes
+#define GRAPH_FILE_VERSION 1
+
+
+/**
+ * Header of the binary file. It's followed by the sections exists (one byte, 0 or 1, per vertex), offsets (size + 1 int32; the edges leaving v are at the positions [offsets[v], offsets[v+1]) of targets) and targets (num_edges int32), each one starting at an offset aligned to BINARY_FILE_ALIGNMENT bytes. Everything is stored little-endian. Files saved by the weighted digraph have the first bit of flags set and a fourth section (weights) after targets.
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version, flags, size, num_vertices;
+    uint64_t num_edges;
+} GraphFileHeader;
 
 
 /**
@@ -22,8 +49,12 @@
  */
 struct UnweightedDigraph {
     List **adj_lists;       // array of adjacency lists; each index represents a vertex in the graph; if adj_lists[i] is NULL, then the vertex i is not in the graph.
+    List **in_lists;        // NULL if the in-edge index is disabled; otherwise, in_lists[i] holds the tails of the edges arriving at the vertex i (NULL if i is not in the graph)
+    VertexMap *key_map;     // NULL if no vertex was added through a key; otherwise, maps the vertices' keys to their slots
+    long long *keys;        // NULL if key_map is NULL; otherwise, keys[i] is the key of the slot i (GRAPH_NO_KEY if the slot isn't associated with a key)
+    int next_slot;          // no slot below it is free (lower bound for the next slot given to a key)
     int adj_size,           // the current size of adj_lists
-        delta_realloc;      // defines how much adj_lists will grow in each realloc
+        delta_realloc;      // defines how much adj_lists will grow in each realloc (if it's not positive, the size of adj_lists doubles instead)
 
     int num_vertices,       // number of vertices in the graph
         num_edges;          // number of edges in the graph (parallel edges do NOT count as a single edge)
@@ -34,7 +65,7 @@ struct UnweightedDigraph {
  * Creates a new empty unweighted digraph and returns a pointer to it. With this function the caller can specify the graph's adjacency lists array initial size as well as how much it will grow in each realloc.
  * 
  * @param initial_size initial size of the graph's adjacency lists array (once it's full, realloc will be called to increase its size).
- * @param delta_realloc defines how much the graph's adjacency lists array will grow in each realloc.
+ * @param delta_realloc defines how much the graph's adjacency lists array will grow in each realloc; use ADJ_LISTS_ARRAY_GEOMETRIC_GROWTH (or any value that isn't positive) to double its size instead.
  * @return a pointer to the newly created graph if all the required memory could be allocated; NULL otherwise.
  */
 Graph* graph_create_full(int initial_size, int delta_realloc) 
@@ -47,6 +78,10 @@ Graph* graph_create_full(int initial_size, int delta_realloc)
             for(int i = 0; i < initial_size; i++)
                 g->adj_lists[i] = NULL;
 
+            g->in_lists = NULL;
+            g->key_map = NULL;
+            g->keys = NULL;
+            g->next_slot = 0;
             g->adj_size = initial_size;
             g->delta_realloc = delta_realloc;
             g->num_vertices = g->num_edges = 0;
@@ -80,38 +115,126 @@ void graph_free(Graph **g) {
     for(int i = 0; i < (*g)->adj_size; i++) {
         if((*g)->adj_lists[i] != NULL)
             list_free(&((*g)->adj_lists[i]), &free);
+        if((*g)->in_lists != NULL && (*g)->in_lists[i] != NULL)
+            list_free(&((*g)->in_lists[i]), &free);
     }
 
     free((*g)->adj_lists);
+    free((*g)->in_lists);
+    free((*g)->keys);
+    if((*g)->key_map != NULL)
+        vmap_free(&(*g)->key_map);
     free((*g));
     (*g) = NULL;
 }
 
 
 /**
- * Increases the size of a graph's adjacency lists array by g->delta_realloc.
+ * Changes the size of a graph's adjacency lists array (and of the arrays that go along with it). When shrinking, the slots being dropped must be empty.
  * 
  * @param g a pointer to the graph.
- * @param num the array will be increased by num*g->delta_realloc.
- * @return true if the operation was successful; false if the memory couldn't be reallocated (in this case, g->adj_lists will remain unchanged).
+ * @param new_size the new size of the array (at least 1).
+ * @return true if the operation was successful; false if the memory couldn't be reallocated (in this case, g->adj_size will be the smallest of the old and the new sizes).
  */
-static bool graph_grow(Graph *g, int num) 
+static bool graph_resize(Graph *g, int new_size) 
 {
-    int new_size = g->adj_size + num*g->delta_realloc;
+    int old_size = g->adj_size;
     List **new_arr = realloc(g->adj_lists, new_size*sizeof(List*));
 
     if(new_arr == NULL)
         return false;    // realloc failed
 
-    for(int i = g->adj_size; i < new_size; i++)
+    for(int i = old_size; i < new_size; i++)
         new_arr[i] = NULL;
-
     g->adj_lists = new_arr;
+    if(new_size < old_size)
+        g->adj_size = new_size;     // the other arrays are, at least, this big
+
+    if(g->in_lists != NULL) {
+        new_arr = realloc(g->in_lists, new_size*sizeof(List*));
+        if(new_arr == NULL)
+            return false;
+
+        for(int i = old_size; i < new_size; i++)
+            new_arr[i] = NULL;
+        g->in_lists = new_arr;
+    }
+
+    if(g->keys != NULL) {
+        long long *new_keys = realloc(g->keys, new_size*sizeof(long long));
+        if(new_keys == NULL)
+            return false;
+
+        for(int i = old_size; i < new_size; i++)
+            new_keys[i] = GRAPH_NO_KEY;
+        g->keys = new_keys;
+    }
+
     g->adj_size = new_size;
     return true;
 }
 
 
+/**
+ * Increases the size of a graph's adjacency lists array so that it holds at least min_size slots: by multiples of g->delta_realloc or, if it isn't positive, by doubling its size.
+ * 
+ * @param g a pointer to the graph.
+ * @param min_size minimum size of the array after the call.
+ * @return true if the operation was successful; false if the memory couldn't be reallocated (in this case, g->adj_size will remain unchanged).
+ */
+static bool graph_grow(Graph *g, int min_size) 
+{
+    int new_size;
+    if(g->delta_realloc > 0) {
+        int steps = (min_size - g->adj_size + g->delta_realloc - 1) / g->delta_realloc;
+        new_size = g->adj_size + steps * g->delta_realloc;
+    }
+    else {
+        new_size = (g->adj_size > 0) ? 2 * g->adj_size : ADJ_LISTS_ARRAY_INITIAL_SIZE;
+        if(new_size < min_size)
+            new_size = min_size;
+    }
+
+    return graph_resize(g, new_size);
+}
+
+
+/**
+ * Prepares the graph for a bulk load: the adjacency lists array grows, at once, to hold the vertices in the range [0, vertices). Since each edge is stored in its own list node, the expected number of edges isn't used (it's accepted for compatibility with the weighted digraph). Nothing is shrunk by this function.
+ * 
+ * @param g a pointer to the graph.
+ * @param vertices number of slots of the adjacency lists array.
+ * @param edges expected number of edges (ignored).
+ * @return true if the operation was successful; false if the memory couldn't be allocated.
+ */
+bool graph_reserve(Graph *g, int vertices, int edges) 
+{
+    (void) edges;
+    if(vertices <= g->adj_size)
+        return true;
+    return graph_resize(g, vertices);
+}
+
+
+/**
+ * Gives back the memory the graph isn't using: the adjacency lists array loses the empty slots after the highest indexed vertex.
+ * 
+ * @param g a pointer to the graph.
+ * @return true if the operation was successful; false if the memory couldn't be reallocated (the graph remains valid, just not as compact).
+ */
+bool graph_shrink_to_fit(Graph *g) 
+{
+    int new_size = g->adj_size;
+    while(new_size > 1 && !graph_has_vertex(g, new_size - 1))
+        new_size--;
+
+    bool ok = (new_size < g->adj_size) ? graph_resize(g, new_size) : true;
+    if(g->next_slot > g->adj_size)
+        g->next_slot = g->adj_size;
+    return ok;
+}
+
+
 /**
  * Checks whether the vertex v is in the graph g.
  * 
@@ -202,7 +325,7 @@ bool graph_has_cycle(Graph *g)
 
 
 /**
- * Finds all the source vertices of the graph. Source vertices are those that don't have any edges pointing to them.
+ * Finds all the source vertices of the graph. Source vertices are those that don't have any edges pointing to them. Runs in O(|V|) if the in-edge index is enabled and in O(|V| + |E|) otherwise.
  */
 List* graph_find_sources(Graph *g) 
 {
@@ -213,7 +336,13 @@ List* graph_find_sources(Graph *g)
 
     /* Finding sources */
     for(int v = 0; v < g->adj_size; v++) {
-        if(g->adj_lists[v] != NULL) {
+        if(g->in_lists != NULL) {
+            if(g->adj_lists[v] == NULL || list_size(g->in_lists[v]) > 0) {
+                is_source[v] = false;   // O(1) with the in-edge index
+                source_count--;
+            }
+        }
+        else if(g->adj_lists[v] != NULL) {
             int *adj_v = graph_adj_to(g, v);
             for(int i = 0; i < graph_adj_count(g, v); i++) {
                 int w = adj_v[i];
@@ -253,7 +382,7 @@ List* graph_find_sources(Graph *g)
 /**
  * Adds a new vertex v to the graph. Initially, the vertex's adjacency list will be empty. If the graph's adjacency lists array's size is less than v, it will be reallocated in order to store the new vertex.
  * 
- * WARNING: be careful when adding/removing vertices from a graph, for the graphs in this implementation will have an adjacency lists array with a size greater than or equal to the highest indexed vertex added to it. Once a graph's adjacency lists array is increased in size, it won't automatically be shrunk back!
+ * WARNING: be careful when adding/removing vertices from a graph, for the graphs in this implementation will have an adjacency lists array with a size greater than or equal to the highest indexed vertex added to it. Once a graph's adjacency lists array is increased in size, it won't automatically be shrunk back (see graph_shrink_to_fit())!
  * 
  * @param g a pointer to the graph.
  * @param v the identifier (index) of the new vertex.
@@ -264,10 +393,7 @@ bool graph_add_vertex(Graph *g, int v)
 {   
     /* Checking whether the graph's adjacency lists array's size should be increased */
     if(v >= g->adj_size) {             
-        int n = 1;
-        while(v >= (g->adj_size + (n++) * g->delta_realloc));
-        
-        if(!graph_grow(g, --n))
+        if(!graph_grow(g, v + 1))
             return false;               // realloc failed (graph's adjacency lists array couldn't grow)
     }
     /* Checking if v is already in the graph */
@@ -278,6 +404,14 @@ bool graph_add_vertex(Graph *g, int v)
     g->adj_lists[v] = list_create();
     if(g->adj_lists[v] == NULL)
         return false;                   // couldn't allocate the needed memory for v's adjacency list
+
+    if(g->in_lists != NULL) {
+        g->in_lists[v] = list_create();
+        if(g->in_lists[v] == NULL) {
+            list_free(&g->adj_lists[v], &free);
+            return false;
+        }
+    }
     
     g->num_vertices++;
     return true;
@@ -316,36 +450,101 @@ bool graph_add_edge(Graph *g, int v, int w, bool create_if_needed)
     /* Adding the edge v->w */
     int *w_cpy = malloc(sizeof(int));  (*w_cpy) = w;
     list_append(g->adj_lists[v], w_cpy);
+    if(g->in_lists != NULL) {
+        int *v_cpy = malloc(sizeof(int));  (*v_cpy) = v;
+        list_append(g->in_lists[w], v_cpy);
+    }
     g->num_edges++;
     return true;            // edge v->w successfuly added
 }
 
 
 /**
- * @todo NOT IMPLEMENTED 
+ * Returns true if the given integers are equal or false otherwise. Auxiliary function.
+ */
+static bool compare_ints(void *a, void *b) {
+    return *((int*) a) == *((int*) b);
+}
+
+
+/**
+ * Forgets the key of the slot v (if any), since the vertex in it was removed. Auxiliary function.
+ */
+static void release_slot(Graph *g, int v) 
+{
+    if(g->keys != NULL && g->keys[v] != GRAPH_NO_KEY) {
+        vmap_remove(g->key_map, g->keys[v]);
+        g->keys[v] = GRAPH_NO_KEY;
+    }
+    if(v < g->next_slot)
+        g->next_slot = v;
+}
+
+
+/**
+ * Enables the in-edge index: from now on, the graph keeps, for each vertex, the tails of the edges arriving at it. The index is built in O(|V| + |E|) and then kept up to date by the insertions and removals. It can't be disabled.
  * 
- * @param g 
- * @param num 
- * @return true 
- * @return false 
+ * @param g a pointer to the graph.
+ * @return true if the index is enabled; false if the memory couldn't be allocated (in this case, the graph remains unchanged).
  */
-static bool graph_shrink(Graph *g, int num) {
-    return false;
+bool graph_enable_in_edges(Graph *g) 
+{
+    if(g->in_lists != NULL)
+        return true;
+
+    List **in = calloc(g->adj_size > 0 ? g->adj_size : 1, sizeof(List*));
+    if(in == NULL)
+        return false;
+
+    bool failed = false;
+    for(int v = 0; v < g->adj_size && !failed; v++) {
+        if(g->adj_lists[v] != NULL)
+            failed = (in[v] = list_create()) == NULL;
+    }
+
+    for(int v = 0; v < g->adj_size && !failed; v++) {
+        if(g->adj_lists[v] == NULL)
+            continue;
+
+        Node *n = list_head(g->adj_lists[v]);
+        while(n != NULL && !failed) {
+            int *v_cpy = malloc(sizeof(int));
+            if(v_cpy == NULL)
+                failed = true;
+            else {
+                (*v_cpy) = v;
+                list_append(in[*((int*) list_node_item(n))], v_cpy);
+                n = list_next_node(n);
+            }
+        }
+    }
+
+    if(failed) {
+        for(int v = 0; v < g->adj_size; v++) {
+            if(in[v] != NULL)
+                list_free(&in[v], &free);
+        }
+        free(in);
+        return false;
+    }
+
+    g->in_lists = in;
+    return true;
 }
 
 
 /**
- * Returns true if the given integers are equal or false otherwise. Auxiliary function.
+ * Returns true if the graph's in-edge index is enabled.
  */
-static bool compare_ints(void *a, void *b) {
-    return *((int*) a) == *((int*) b);
+bool graph_has_in_edges(Graph *g) {
+    return g->in_lists != NULL;
 }
 
 
 /**
- * Removes a vertex from the given graph (along with all the edges that points to it).
+ * Removes a vertex from the given graph (along with all the edges that points to it). If the in-edge index is enabled, only the adjacency lists of v's neighbours are visited; otherwise, all of them are.
  * 
-* WARNING: be careful when adding/removing vertices from a graph, for the graphs in this implementation will have an adjacency lists array with a size greater than or equal to the highest indexed vertex added to it. Once a graph's adjacency lists array is increased in size, it won't automatically be shrunk back!
+* WARNING: be careful when adding/removing vertices from a graph, for the graphs in this implementation will have an adjacency lists array with a size greater than or equal to the highest indexed vertex added to it. Once a graph's adjacency lists array is increased in size, it won't automatically be shrunk back (see graph_shrink_to_fit())!
  * 
  * @param g pointer to the graph.
  * @param v index that identifies the vertex.
@@ -359,8 +558,36 @@ bool graph_remove_vertex(Graph *g, int v)
     g->num_vertices--;
     g->num_edges -= list_size(g->adj_lists[v]);
 
+    if(g->in_lists != NULL) {
+        /* Removing the edges pointing to v from the lists of their tails */
+        Node *n = list_head(g->in_lists[v]);
+        while(n != NULL) {
+            int u = *((int*) list_node_item(n));
+            if(u != v)      // self-loops are removed with v's adjacency list
+                g->num_edges -= list_remove_all(g->adj_lists[u], &v, &compare_ints, &free);
+            n = list_next_node(n);
+        }
+
+        /* Removing v from the in-lists of the heads of its edges */
+        n = list_head(g->adj_lists[v]);
+        while(n != NULL) {
+            int w = *((int*) list_node_item(n));
+            if(w != v)
+                list_remove_all(g->in_lists[w], &v, &compare_ints, &free);
+            n = list_next_node(n);
+        }
+
+        list_free(&g->in_lists[v], &free);
+        g->in_lists[v] = NULL;
+        list_free(&g->adj_lists[v], &free);
+        g->adj_lists[v] = NULL;
+        release_slot(g, v);
+        return true;
+    }
+
     list_free(&g->adj_lists[v], &free);
     g->adj_lists[v] = NULL;
+    release_slot(g, v);
 
     for(int w = 0; w < g->adj_size; w++) {
         if(g->adj_lists[w] != NULL) 
@@ -371,6 +598,89 @@ bool graph_remove_vertex(Graph *g, int v)
 }
 
 
+/**
+ * Returns the slot (index) of the vertex identified by the given key, adding the vertex to the graph, in the lowest free slot, if needed. The slot can then be used with all the other functions. Once the vertex is removed (with graph_remove_vertex()), the key is forgotten and the slot may be given to another key.
+ * 
+ * @param g a pointer to the graph.
+ * @param key the vertex's key (any value but GRAPH_NO_KEY).
+ * @param create_if_needed should the vertex be added to g if there's no vertex with the given key?
+ * @return the vertex's slot or -1 if: there's no vertex with the key and create_if_needed is false OR the required memory couldn't be allocated.
+ */
+int graph_vertex_slot(Graph *g, long long key, bool create_if_needed) 
+{
+    if(key == GRAPH_NO_KEY)
+        return -1;
+
+    if(g->key_map != NULL) {
+        int slot = vmap_get(g->key_map, key);
+        if(slot >= 0 || !create_if_needed)
+            return slot;
+    }
+    else {
+        if(!create_if_needed)
+            return -1;
+
+        // the map and the array of keys are only created when the first key is used
+        g->key_map = vmap_create(0);
+        g->keys = malloc(sizeof(long long) * (g->adj_size > 0 ? g->adj_size : 1));
+        if(g->key_map == NULL || g->keys == NULL) {
+            if(g->key_map != NULL)
+                vmap_free(&g->key_map);
+            free(g->keys);
+            g->keys = NULL;
+            return -1;
+        }
+
+        for(int i = 0; i < g->adj_size; i++)
+            g->keys[i] = GRAPH_NO_KEY;
+    }
+
+    int slot = g->next_slot;
+    while(graph_has_vertex(g, slot))
+        slot++;
+
+    if(!graph_add_vertex(g, slot))
+        return -1;
+    if(!vmap_put(g->key_map, key, slot)) {
+        graph_remove_vertex(g, slot);
+        return -1;
+    }
+
+    g->keys[slot] = key;
+    g->next_slot = slot + 1;
+    return slot;
+}
+
+
+/**
+ * Returns the key of the vertex in the slot v or GRAPH_NO_KEY if v isn't in the graph or if it wasn't added through a key.
+ */
+long long graph_vertex_key(Graph *g, int v) {
+    if(g->keys == NULL || !graph_has_vertex(g, v))
+        return GRAPH_NO_KEY;
+    return g->keys[v];
+}
+
+
+/**
+ * Adds a directed edge between the vertices with the given keys (see graph_vertex_slot()).
+ * 
+ * @param g a pointer to the graph.
+ * @param v the key of vertex v.
+ * @param w the key of vertex w.
+ * @param create_if_needed should the vertices be added to g if they do not exist?
+ * @return true if the edge was successfuly added; false otherwise.
+ */
+bool graph_add_edge_keys(Graph *g, long long v, long long w, bool create_if_needed) 
+{
+    int sv = graph_vertex_slot(g, v, create_if_needed), 
+        sw = graph_vertex_slot(g, w, create_if_needed);
+    if(sv < 0 || sw < 0)
+        return false;
+    return graph_add_edge(g, sv, sw, false);
+}
+
+
 /**
  * Removes the edge v->w from the graph. Parallel edges are also removed.
  * 
@@ -384,6 +694,8 @@ bool graph_remove_edge(Graph *g, int v, int w) {
         return false;
 
     int count = list_remove_all(g->adj_lists[v], &w, &compare_ints, &free);
+    if(count > 0 && g->in_lists != NULL)
+        list_remove_all(g->in_lists[w], &v, &compare_ints, &free);
     g->num_edges -= count;
     return count > 0;
 }
@@ -434,6 +746,62 @@ int* graph_adj_to(Graph *g, int v) {
 }
 
 
+/**
+ * Returns an array containing the vertices that have edges pointing to v (a vertex appears once for each of its edges to v). Requires the in-edge index (see graph_enable_in_edges()).
+ * 
+ * @param g a pointer to the graph.
+ * @param v the identifier (index) of vertex v.
+ * @return an array containing the tails of the edges arriving at v or NULL if there are no such edges, if v doesn't exist or if the in-edge index is disabled.
+ */
+int* graph_in_edges(Graph *g, int v) {
+    if(g->in_lists == NULL || !graph_has_vertex(g, v))
+        return NULL;
+
+    int size = list_size(g->in_lists[v]);
+    if(size == 0)  
+        return NULL;
+
+    int i = 0, *arr = malloc(size * sizeof(int));
+    Node *n = list_head(g->in_lists[v]);
+
+    while(n != NULL) {
+        arr[i++] = *((int*) list_node_item(n));
+        n = list_next_node(n);
+    }
+
+    return arr;
+}
+
+
+/**
+ * Returns the number of edges pointing to the vertex v: O(1) if the in-edge index is enabled; O(|V| + |E|) otherwise.
+ * 
+ * @param g a pointer to the graph.
+ * @param v the identifier (index) of vertex v.
+ * @return v's in-degree or 0 if it's not in the graph.
+ */
+int graph_in_degree(Graph *g, int v) 
+{
+    if(!graph_has_vertex(g, v))
+        return 0;
+    if(g->in_lists != NULL)
+        return list_size(g->in_lists[v]);
+
+    int count = 0;
+    for(int u = 0; u < g->adj_size; u++) {
+        if(g->adj_lists[u] == NULL)
+            continue;
+
+        Node *n = list_head(g->adj_lists[u]);
+        while(n != NULL) {
+            count += *((int*) list_node_item(n)) == v;
+            n = list_next_node(n);
+        }
+    }
+    return count;
+}
+
+
 /**
  * Returns the amount of neighbours of the vertex v.
  * 
@@ -446,6 +814,126 @@ int graph_adj_count(Graph *g, int v) {
 }
 
 
+/**
+ * Checks that the offsets of a mapped file start at 0, never decrease and end at m, so every range [offsets[v], offsets[v+1]) lies inside the targets section. Auxiliary function.
+ */
+static bool valid_offsets(const int32_t *offsets, size_t size, size_t m) {
+    if(offsets[0] != 0 || offsets[size] != (int32_t) m)
+        return false;
+
+    for(size_t v = 0; v < size; v++) {
+        if(offsets[v] > offsets[v + 1])
+            return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Saves the graph to a binary file (versioned, little-endian, with the sections aligned to 64 bytes; see GraphFileHeader) that can be loaded with graph_load_binary(). The keys of the vertices (see graph_vertex_slot()) aren't saved.
+ *
+ * @param g a pointer to the graph.
+ * @param path the path of the file (overwritten if it exists).
+ * @return true if the file was written; false otherwise (including when the machine isn't little-endian).
+ */
+bool graph_save_binary(Graph *g, const char *path)
+{
+    if(!little_endian())
+        return false;
+
+    size_t size = g->adj_size, m = g->num_edges;
+    uint8_t *exists = malloc(size);
+    int32_t *offsets = malloc((size + 1) * sizeof(int32_t)), *targets = malloc((m > 0 ? m : 1) * sizeof(int32_t));
+    FILE *f = (exists != NULL && offsets != NULL && targets != NULL) ? fopen(path, "wb") : NULL;
+
+    bool ok = f != NULL;
+    if(ok) {
+        size_t pos = 0;
+        for(size_t v = 0; v < size; v++) {
+            exists[v] = g->adj_lists[v] != NULL;
+            offsets[v] = pos;
+            for(Node *n = exists[v] ? list_head(g->adj_lists[v]) : NULL; n != NULL; n = list_next_node(n))
+                targets[pos++] = *((int*) list_node_item(n));
+        }
+        offsets[size] = pos;
+
+        GraphFileHeader header = {{0}, GRAPH_FILE_VERSION, 0, size, g->num_vertices, m};
+        memcpy(header.magic, GRAPH_FILE_MAGIC, sizeof(header.magic));
+
+        ok = fwrite(&header, sizeof(header), 1, f) == 1 && write_padding(f, sizeof(header))
+          && fwrite(exists, 1, size, f) == size && write_padding(f, size)
+          && fwrite(offsets, sizeof(int32_t), size + 1, f) == size + 1 && write_padding(f, sizeof(int32_t) * (size + 1))
+          && fwrite(targets, sizeof(int32_t), m, f) == m;
+        ok = fclose(f) == 0 && ok;
+    }
+
+    free(exists);
+    free(offsets);
+    free(targets);
+    return ok;
+}
+
+
+/**
+ * Loads a graph saved with graph_save_binary(). The file is mapped into memory and the adjacency lists are built straight from its arrays (a single pass, with the graph's array allocated once), so no text is parsed. Unlike the weighted digraph's graph_mmap_open(), the loaded graph can't be backed by the mapping, since its adjacency lists are linked lists; the file is unmapped before returning. Files saved by the weighted digraph are also accepted (the weights are ignored).
+ *
+ * @param path the path of the file.
+ * @return a pointer to the loaded graph or NULL if the file couldn't be read, isn't a valid graph file or if the memory needed couldn't be allocated.
+ */
+Graph* graph_load_binary(const char *path)
+{
+    if(!little_endian())
+        return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+        return NULL;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(GraphFileHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // the mapping stays valid
+    if(map == MAP_FAILED)
+        return NULL;
+
+    GraphFileHeader *header = map;
+    size_t size = header->size, m = header->num_edges,
+           offsets_at = align_up(sizeof(GraphFileHeader)) + align_up(size),
+           targets_at = offsets_at + align_up(sizeof(int32_t) * (size + 1));
+    const uint8_t *exists = (uint8_t*) map + align_up(sizeof(GraphFileHeader));
+    const int32_t *offsets = (int32_t*) ((char*) map + offsets_at), *targets = (int32_t*) ((char*) map + targets_at);
+
+    Graph *g = NULL;
+    if(memcmp(header->magic, GRAPH_FILE_MAGIC, sizeof(header->magic)) == 0 && header->version == GRAPH_FILE_VERSION
+            && size > 0 && size < INT32_MAX && m <= INT32_MAX && targets_at + sizeof(int32_t) * m <= (size_t) st.st_size
+            && valid_offsets(offsets, size, m))
+        g = graph_create_full(size, ADJ_LISTS_ARRAY_DELTA_REALLOC);
+
+    bool ok = g != NULL;
+    for(size_t v = 0; ok && v < size; v++) {
+        if(exists[v])
+            ok = graph_add_vertex(g, v);
+    }
+
+    for(size_t v = 0; ok && v < size; v++) {
+        for(int32_t e = offsets[v]; ok && e < offsets[v + 1]; e++) {
+            int w = targets[e];
+            ok = exists[v] && w >= 0 && (size_t) w < size && exists[w] && graph_add_edge(g, v, w, false);
+        }
+    }
+
+    munmap(map, st.st_size);
+    if(!ok && g != NULL)
+        graph_free(&g);
+    return g;
+}
+
+
 /**
  * Auxialiary function used by list_print.
  */
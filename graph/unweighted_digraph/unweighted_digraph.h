@@ -1,10 +1,7 @@
 /**
  * Implementation of an unweighted directed graph. 
  * 
- * Each vertex is identified by it's index in the graph's array of adjacency lists. This array's initial size can be chosen by the client (alternatively, default values can be used, hiding the internal details from the client). Note that when a vertex v has an ID greater than the graph's array of adjacency lists, the array must be expanded (memory reallocation). This might be improved later on through the use of hashing.
- * 
- * @todo function to shrink the graph's array of adjacency lists to a desired size.
- * @todo reduce, by the use of hashing, the memory required by the graph to store its adjacency lists.
+ * Each vertex is identified by it's index in the graph's array of adjacency lists. This array's initial size can be chosen by the client (alternatively, default values can be used, hiding the internal details from the client). Note that when a vertex v has an ID greater than the graph's array of adjacency lists, the array must be expanded (memory reallocation); by default, its size doubles each time (see also graph_reserve() and graph_shrink_to_fit()). For sparse identifiers, the vertices can instead be added through 64-bit keys (see graph_vertex_slot()), which a hash map associates with dense indices (slots).
  * 
  * @version 1.0
  * @author Gabriel Nogueira (Talendar)
@@ -14,11 +11,14 @@
 #ifndef UNWEIGHTED_DIGRAPH_H
     #define UNWEIGHTED_DIGRAPH_H
     #include <stdbool.h>
+    #include <limits.h>
     #include "singly_linked_list.h"
 
     /* Constants */
     static const int ADJ_LISTS_ARRAY_INITIAL_SIZE = 20;        // the initial size of a graph's adjacency lists array
-    static const int ADJ_LISTS_ARRAY_DELTA_REALLOC = 10;       // how much a graph's adjacency lists array will grow in each realloc
+    static const int ADJ_LISTS_ARRAY_GEOMETRIC_GROWTH = 0;     // delta_realloc that makes a graph's adjacency lists array double in size when full
+    static const int ADJ_LISTS_ARRAY_DELTA_REALLOC = 0;        // default growth of a graph's adjacency lists array (doubles when full)
+    static const long long GRAPH_NO_KEY = LLONG_MIN;           // key of the vertices that weren't added through a key
 
     /* Structs */
     typedef struct UnweightedDigraph Graph;
@@ -27,11 +27,22 @@
     Graph* graph_create_full(int initial_size, int delta_realloc);
     Graph* graph_create();
     void graph_free(Graph **g);
+    bool graph_reserve(Graph *g, int vertices, int edges);
+    bool graph_shrink_to_fit(Graph *g);
+
+    /* In-edge index */
+    bool graph_enable_in_edges(Graph *g);
+    bool graph_has_in_edges(Graph *g);
 
     /* Insertions */
     bool graph_add_vertex(Graph *g, int v);
     bool graph_add_edge(Graph *g, int v, int w, bool create_if_needed);
 
+    /* Keyed vertices */
+    int graph_vertex_slot(Graph *g, long long key, bool create_if_needed);
+    long long graph_vertex_key(Graph *g, int v);
+    bool graph_add_edge_keys(Graph *g, long long v, long long w, bool create_if_needed);
+
     /* Removals */
     bool graph_remove_vertex(Graph *g, int v);
     bool graph_remove_edge(Graph *g, int v, int w);
@@ -48,6 +59,12 @@
     int* graph_vertices(Graph *g);
     int* graph_adj_to(Graph *g, int v);
     int graph_adj_count(Graph *g, int v);
+    int* graph_in_edges(Graph *g, int v);
+    int graph_in_degree(Graph *g, int v);
+
+    /* Binary file */
+    bool graph_save_binary(Graph *g, const char *path);
+    Graph* graph_load_binary(const char *path);
 
     /* Others */
     void graph_print(Graph *g);
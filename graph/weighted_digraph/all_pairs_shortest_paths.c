@@ -0,0 +1,746 @@
+/**
+ * Simple API for resolving all-pairs shortest paths problems.
+ *
+ * Johnson's algorithm (johnson_apsp()) handles sparse graphs with negative
+ * edge weights: the weights are made non-negative, once, with potentials found
+ * by the Bellman-Ford algorithm and then one Dijkstra's search is run from each
+ * vertex, in parallel. For small dense graphs, apsp_floyd_warshall() runs the
+ * Floyd-Warshall algorithm on a contiguous matrix, tile by tile, using AVX2
+ * instructions when the processor supports them (x86 builds only).
+ *
+ * Distance tables between a set of sources and a set of targets
+ * (sp_distance_table()) are filled by Dijkstra's searches that stop as soon as
+ * all the targets are settled, run in parallel, each thread with its own
+ * workspace (see spw_create()).
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+
+#define _POSIX_C_SOURCE 200112L
+#include "all_pairs_shortest_paths.h"
+#include "indexed_heap.h"
+#include "shortest_paths.h"
+#include "thread_team.h"
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <pthread.h>
+
+/* The AVX2 kernel of apsp_floyd_warshall_matrix() is only built for x86 */
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define APSP_FW_X86
+#endif
+
+
+/* Number of sources taken at once by each thread of johnson_apsp() */
+#define JOHNSON_CHUNK_SIZE 8
+
+
+/**
+ *      State shared by the threads of johnson_apsp(). The graph is frozen into
+ * flat arrays (the edges leaving the vertex v are at the positions
+ * [offset[v], offset[v+1]) of the arrays to and weight), so the threads only
+ * read immutable memory.
+ *
+ * Attributes:
+ *      . size: size of the graph's array of adjacency lists.
+ *      . exists: whether each position of the array holds a vertex.
+ *      . offset, to, weight: the frozen edges, with the reduced weights
+ *      w(u, v) + h(u) - h(v), which are never negative.
+ *      . potential: the potential h(v) of each vertex.
+ *      . matrix: the output matrix or NULL if the rows go to the callback.
+ *      . row, ctx: the callback of johnson_apsp_rows() and its context.
+ *      . next_source, lock: the next source to be taken by a thread.
+ */
+typedef struct {
+    int size;
+    bool *exists;
+
+    int *offset, *to;
+    double *weight, *potential;
+
+    double *matrix;
+    void (*row)(int s, const double *dist, void *ctx);
+    void *ctx;
+
+    int next_source;
+    pthread_mutex_t lock;
+} Johnson;
+
+
+/**
+ *      Freezes the graph's edges into the flat arrays of jo. Returns false if
+ * the memory couldn't be allocated. Auxiliary function.
+ */
+static bool johnson_freeze(Johnson *jo, Graph *g)
+{
+    int m = graph_num_edges(g);
+    jo->exists = malloc(sizeof(bool) * jo->size);
+    jo->offset = malloc(sizeof(int) * (jo->size + 1));
+    jo->to = malloc(sizeof(int) * (m > 0 ? m : 1));
+    jo->weight = malloc(sizeof(double) * (m > 0 ? m : 1));
+    jo->potential = calloc(jo->size > 0 ? jo->size : 1, sizeof(double));
+
+    if(jo->exists == NULL || jo->offset == NULL || jo->to == NULL || jo->weight == NULL || jo->potential == NULL)
+        return false;
+
+    int pos = 0;
+    for(int v = 0; v < jo->size; v++) {
+        jo->exists[v] = graph_has_vertex(g, v);
+        jo->offset[v] = pos;
+
+        Edge *e;
+        EdgeIter it = graph_edges_begin(g, v);
+        while(edge_next(&it, &e)) {
+            jo->to[pos] = edge_dest(e);
+            jo->weight[pos++] = edge_weight(e);
+        }
+    }
+    jo->offset[jo->size] = pos;
+
+    return true;
+}
+
+
+/**
+ *      Finds the potentials of the vertices: the distances from a virtual
+ * vertex linked, by edges of weight 0, to all the vertices of the graph. The
+ * virtual vertex isn't materialized: the queue-based Bellman-Ford algorithm
+ * just starts with every vertex at distance 0. A vertex whose path from the
+ * virtual vertex has |V| edges is on a negative cycle. Then, the weights of the
+ * frozen edges are replaced by the reduced ones.
+ *
+ *      If the graph has no negative weights, the potentials are all 0 and the
+ * Bellman-Ford pass is skipped. Returns false if the graph has a negative cycle
+ * or the memory couldn't be allocated. Auxiliary function.
+ */
+static bool johnson_reweight(Johnson *jo, int num_vertices)
+{
+    int m = jo->offset[jo->size];
+    bool negative = false;
+    for(int e = 0; e < m && !negative; e++)
+        negative = jo->weight[e] < 0;
+    if(!negative)
+        return true;
+
+    int *queue = malloc(sizeof(int) * (jo->size > 0 ? jo->size : 1)),
+        *num_edges = calloc(jo->size > 0 ? jo->size : 1, sizeof(int));
+    bool *queued = malloc(sizeof(bool) * (jo->size > 0 ? jo->size : 1));
+    if(queue == NULL || num_edges == NULL || queued == NULL) {
+        free(queue);  free(num_edges);  free(queued);
+        return false;
+    }
+
+    // ring buffer: each vertex is in the queue at most once
+    int head = 0, count = 0;
+    for(int v = 0; v < jo->size; v++) {
+        queued[v] = jo->exists[v];
+        if(queued[v])
+            queue[count++] = v;
+    }
+
+    bool cycle = false;
+    double *h = jo->potential;
+    while(count > 0 && !cycle) {
+        int v = queue[head];
+        head = (head + 1) % jo->size;
+        count--;
+        queued[v] = false;
+
+        for(int e = jo->offset[v]; e < jo->offset[v + 1]; e++) {
+            int w = jo->to[e];
+            if(h[v] + jo->weight[e] >= h[w])
+                continue;
+
+            h[w] = h[v] + jo->weight[e];
+            num_edges[w] = num_edges[v] + 1;
+            if(num_edges[w] >= num_vertices) {
+                cycle = true;
+                break;
+            }
+
+            if(!queued[w]) {
+                queued[w] = true;
+                queue[(head + count++) % jo->size] = w;
+            }
+        }
+    }
+
+    free(queue);  free(num_edges);  free(queued);
+    if(cycle)
+        return false;
+
+    for(int v = 0; v < jo->size; v++) {
+        for(int e = jo->offset[v]; e < jo->offset[v + 1]; e++) {
+            double w = jo->weight[e] + h[v] - h[jo->to[e]];
+            jo->weight[e] = (w > 0) ? w : 0;    // rounding errors
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ *      Runs a Dijkstra's search, on the reduced weights, from the vertex s and
+ * writes the real distances to dist. Auxiliary function.
+ */
+static void johnson_search(Johnson *jo, IndexedHeap *heap, int s, double *dist)
+{
+    for(int v = 0; v < jo->size; v++)
+        dist[v] = INFINITY;
+
+    dist[s] = 0;
+    iheap_insert(heap, s, 0);
+    while(!iheap_empty(heap)) {
+        int v = iheap_pop_min(heap);
+        for(int e = jo->offset[v]; e < jo->offset[v + 1]; e++) {
+            int w = jo->to[e];
+            double d = dist[v] + jo->weight[e];
+            if(d >= dist[w])
+                continue;
+
+            if(isinf(dist[w]))
+                iheap_insert(heap, w, d);
+            else
+                iheap_decrease_key(heap, w, d);
+            dist[w] = d;
+        }
+    }
+
+    // d(s, v) = d'(s, v) - h(s) + h(v)
+    for(int v = 0; v < jo->size; v++) {
+        if(!isinf(dist[v]))
+            dist[v] += jo->potential[v] - jo->potential[s];
+    }
+}
+
+
+/**
+ *      Main function of the threads of johnson_apsp(): takes chunks of sources
+ * until there are none left. Each thread has its own heap and, when streaming,
+ * its own row buffer.
+ */
+static void* johnson_worker(void *arg)
+{
+    Johnson *jo = arg;
+    IndexedHeap *heap = iheap_create(jo->size);
+    double *buffer = (jo->matrix == NULL) ? malloc(sizeof(double) * (jo->size > 0 ? jo->size : 1)) : NULL;
+    if(heap == NULL || (jo->matrix == NULL && buffer == NULL)) {
+        if(heap != NULL)
+            iheap_free(&heap);
+        free(buffer);
+        return NULL;    // the other threads take the work
+    }
+
+    while(1) {
+        pthread_mutex_lock(&jo->lock);
+        int first = jo->next_source;
+        jo->next_source += JOHNSON_CHUNK_SIZE;
+        pthread_mutex_unlock(&jo->lock);
+
+        if(first >= jo->size)
+            break;
+
+        int last = (first + JOHNSON_CHUNK_SIZE < jo->size) ? first + JOHNSON_CHUNK_SIZE : jo->size;
+        for(int s = first; s < last; s++) {
+            double *dist = (jo->matrix != NULL) ? &jo->matrix[(size_t) s * jo->size] : buffer;
+            if(!jo->exists[s]) {
+                for(int v = 0; jo->matrix != NULL && v < jo->size; v++)
+                    dist[v] = INFINITY;
+                continue;
+            }
+
+            johnson_search(jo, heap, s, dist);
+            if(jo->matrix == NULL)
+                jo->row(s, dist, jo->ctx);
+        }
+    }
+
+    iheap_free(&heap);
+    free(buffer);
+    return NULL;
+}
+
+
+/**
+ *      Runs Johnson's algorithm, writing the rows either to the matrix or to
+ * the callback. Auxiliary function.
+ */
+static bool johnson_run(Graph *g, int nthreads, double *matrix,
+                        void (*row)(int s, const double *dist, void *ctx), void *ctx)
+{
+    Johnson jo = {0};
+    jo.size = graph_array_size(g);
+    jo.matrix = matrix;
+    jo.row = row;
+    jo.ctx = ctx;
+    if(nthreads < 1)
+        nthreads = 1;
+
+    pthread_t *threads = malloc(sizeof(pthread_t) * nthreads);
+    bool ok = threads != NULL && johnson_freeze(&jo, g) && johnson_reweight(&jo, graph_num_vertices(g));
+
+    if(ok) {
+        pthread_mutex_init(&jo.lock, NULL);
+
+        // the calling thread is one of the workers
+        int started = 1;
+        for(; started < nthreads; started++) {
+            if(pthread_create(&threads[started], NULL, &johnson_worker, &jo) != 0)
+                break;
+        }
+        johnson_worker(&jo);
+        for(int t = 1; t < started; t++)
+            pthread_join(threads[t], NULL);
+
+        pthread_mutex_destroy(&jo.lock);
+        ok = jo.next_source >= jo.size;   // false if no thread could allocate its heap
+    }
+
+    free(threads);
+    free(jo.exists);  free(jo.offset);  free(jo.to);
+    free(jo.weight);  free(jo.potential);
+    return ok;
+}
+
+
+/**
+ *      Implements Johnson's algorithm for the all-pairs shortest paths problem.
+ * First, the Bellman-Ford algorithm finds a potential h(v) for each vertex such
+ * that the reduced weights w(u, v) + h(u) - h(v) are never negative (skipped if
+ * the graph has no negative weights); then, one Dijkstra's search is run from
+ * each vertex on the reduced weights. Runs in O(V*E + V*E*log(V)).
+ *
+ *      The graph's edges are frozen into flat arrays before the searches, which
+ * are split among nthreads threads, so the graph must not be changed during the
+ * call.
+ *
+ * @param g a pointer to the graph (expects a weighted digraph).
+ * @param nthreads number of threads (including the calling thread).
+ * @return a size*size row-major matrix (size = graph_array_size(g)) with the
+ * distances, which must be freed by the caller with free(), or NULL if the
+ * graph has a negative cycle or the memory couldn't be allocated.
+ */
+double* johnson_apsp(Graph *g, int nthreads)
+{
+    size_t size = graph_array_size(g);
+    double *matrix = malloc(sizeof(double) * (size > 0 ? size * size : 1));
+    if(matrix != NULL && !johnson_run(g, nthreads, matrix, NULL, NULL)) {
+        free(matrix);
+        matrix = NULL;
+    }
+
+    return matrix;
+}
+
+
+/**
+ *      Same as johnson_apsp(), but, instead of building the matrix, hands each
+ * row to a callback as soon as it's computed, so only O(size) memory per thread
+ * is needed for the distances. The callback is called once for each vertex of
+ * the graph, in no particular order and concurrently by the worker threads (it
+ * must be thread-safe); the row is only valid during the call.
+ *
+ * @param g a pointer to the graph (expects a weighted digraph).
+ * @param nthreads number of threads (including the calling thread).
+ * @param row the callback: receives the source s, the distances from s to each
+ * vertex (indexed by the vertices' identifiers) and ctx.
+ * @param ctx pointer passed to the callback.
+ * @return true if all the rows were computed; false if the graph has a negative
+ * cycle (no row is computed in that case) or the memory couldn't be allocated.
+ */
+bool johnson_apsp_rows(Graph *g, int nthreads,
+                       void (*row)(int s, const double *dist, void *ctx), void *ctx) {
+    return johnson_run(g, nthreads, NULL, row, ctx);
+}
+
+
+/**
+ *      State shared by the threads of apsp_floyd_warshall_matrix(). The matrix
+ * is padded so that its order (stride) is a multiple of APSP_FW_TILE_SIZE and
+ * it's split into num_tiles x num_tiles square tiles.
+ *
+ * Attributes:
+ *      . m, stride: the padded matrix (64-byte aligned) and its order.
+ *      . num_tiles: number of tiles in each row/column of the matrix.
+ *      . avx2: whether the AVX2 kernel should be used (always false on 
+ *      non-x86 targets).
+ *      . team: the threads running the phases, synchronized by its barrier 
+ *      (see thread_team.h).
+ */
+typedef struct {
+    double *m;
+    int stride, num_tiles;
+    bool avx2;
+
+    ThreadTeam team;
+} FloydWarshall;
+
+
+/**
+ * Arguments of a worker thread of apsp_floyd_warshall_matrix().
+ */
+typedef struct {
+    FloydWarshall *fw;
+    int id;
+} FloydWarshallWorker;
+
+
+/**
+ *      Updates the tile c with the paths through the vertices of the tile
+ * column/row k: c[i][j] = min(c[i][j], a[i][k] + b[k][j]), where a is the tile
+ * in c's row and b the tile in c's column. The tiles may be the same (the
+ * updates are done in place, in the same order as in the classic algorithm).
+ * Auxiliary function.
+ */
+static void fw_tile(double *c, const double *a, const double *b, int stride)
+{
+    for(int k = 0; k < APSP_FW_TILE_SIZE; k++) {
+        const double *bk = &b[(size_t) k * stride];
+        for(int i = 0; i < APSP_FW_TILE_SIZE; i++) {
+            double aik = a[(size_t) i * stride + k];
+            if(isinf(aik))
+                continue;
+
+            double *ci = &c[(size_t) i * stride];
+            for(int j = 0; j < APSP_FW_TILE_SIZE; j++) {
+                double d = aik + bk[j];
+                if(d < ci[j])
+                    ci[j] = d;
+            }
+        }
+    }
+}
+
+
+#ifdef APSP_FW_X86
+/**
+ * Same as fw_tile(), but processes 4 columns per instruction with AVX2.
+ */
+__attribute__((target("avx2")))
+static void fw_tile_avx2(double *c, const double *a, const double *b, int stride)
+{
+    for(int k = 0; k < APSP_FW_TILE_SIZE; k++) {
+        const double *bk = &b[(size_t) k * stride];
+        for(int i = 0; i < APSP_FW_TILE_SIZE; i++) {
+            double aik = a[(size_t) i * stride + k];
+            if(isinf(aik))
+                continue;
+
+            double *ci = &c[(size_t) i * stride];
+            __m256d vaik = _mm256_set1_pd(aik);
+            for(int j = 0; j < APSP_FW_TILE_SIZE; j += 4) {
+                __m256d d = _mm256_add_pd(vaik, _mm256_load_pd(&bk[j]));
+                _mm256_store_pd(&ci[j], _mm256_min_pd(_mm256_load_pd(&ci[j]), d));
+            }
+        }
+    }
+}
+#endif
+
+
+/**
+ *      Updates the tile (ti, tj) with the paths through the vertices of the
+ * tile column/row tk. Auxiliary function.
+ */
+static void fw_update(FloydWarshall *fw, int ti, int tj, int tk)
+{
+    size_t t = APSP_FW_TILE_SIZE;
+    double *c = &fw->m[ti * t * fw->stride + tj * t],
+           *a = &fw->m[ti * t * fw->stride + tk * t],
+           *b = &fw->m[tk * t * fw->stride + tj * t];
+
+#ifdef APSP_FW_X86
+    if(fw->avx2) {
+        fw_tile_avx2(c, a, b, fw->stride);
+        return;
+    }
+#endif
+    fw_tile(c, a, b, fw->stride);
+}
+
+
+/**
+ *      Main function of the threads of apsp_floyd_warshall_matrix(). For each
+ * tile row/column k, there are three phases, separated by barriers: the
+ * diagonal tile (k, k) is updated (by the thread 0), then the other tiles of
+ * the row k and of the column k (which only depend on the diagonal one) and,
+ * finally, all the remaining tiles, split among the threads by tile rows.
+ */
+static void* fw_worker(void *arg)
+{
+    FloydWarshallWorker *worker = arg;
+    FloydWarshall *fw = worker->fw;
+    int id = worker->id, nt = fw->num_tiles;
+
+    team_wait(&fw->team);
+    int T = fw->team.nthreads;
+
+    for(int k = 0; k < nt; k++) {
+        if(id == 0)
+            fw_update(fw, k, k, k);
+        pthread_barrier_wait(&fw->team.barrier);
+
+        for(int t = id; t < 2*nt; t += T) {
+            int x = t % nt;
+            if(x == k)
+                continue;
+            if(t < nt)
+                fw_update(fw, k, x, k);     // tile row k
+            else
+                fw_update(fw, x, k, k);     // tile column k
+        }
+        pthread_barrier_wait(&fw->team.barrier);
+
+        for(int i = id; i < nt; i += T) {
+            for(int j = 0; j < nt && i != k; j++) {
+                if(j != k)
+                    fw_update(fw, i, j, k);
+            }
+        }
+        pthread_barrier_wait(&fw->team.barrier);
+    }
+
+    return NULL;
+}
+
+
+/**
+ *      Runs the Floyd-Warshall algorithm on a distance matrix, in place. The
+ * matrix is copied into a padded, aligned buffer and processed in square tiles
+ * of APSP_FW_TILE_SIZE x APSP_FW_TILE_SIZE entries (sized to fit in the L1/L2
+ * caches) with the blocked algorithm of Venkataraman et al. (2003). The inner
+ * loop uses AVX2 instructions if the processor supports them (on x86; other 
+ * targets always use the portable loop). The tiles of each
+ * phase are split among nthreads threads. Runs in O(n^3).
+ *
+ * @param dist a n*n row-major matrix: dist[i*n + j] holds the weight of the
+ * edge i->j (INFINITY if there's none; usually 0 if i = j). By the end of the
+ * call, it holds the distances.
+ * @param n the order of the matrix.
+ * @param nthreads number of threads (including the calling thread).
+ * @return true if the distances were computed; false if the graph has a
+ * negative cycle (some dist[v*n + v] < 0) or the memory couldn't be allocated
+ * (the matrix is left untouched in that case).
+ */
+bool apsp_floyd_warshall_matrix(double *dist, int n, int nthreads)
+{
+    if(n <= 0)
+        return true;
+    if(nthreads < 1)
+        nthreads = 1;
+
+    FloydWarshall fw = {0};
+    fw.num_tiles = (n + APSP_FW_TILE_SIZE - 1) / APSP_FW_TILE_SIZE;
+    fw.stride = fw.num_tiles * APSP_FW_TILE_SIZE;
+#ifdef APSP_FW_X86
+    fw.avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+    pthread_t *threads = malloc(sizeof(pthread_t) * nthreads);
+    FloydWarshallWorker *workers = malloc(sizeof(FloydWarshallWorker) * nthreads);
+    if(threads == NULL || workers == NULL
+            || posix_memalign((void**) &fw.m, 64, sizeof(double) * fw.stride * fw.stride) != 0) {
+        free(threads);  free(workers);
+        return false;
+    }
+
+    // the padding vertices are isolated
+    for(size_t i = 0; i < (size_t) fw.stride; i++) {
+        double *row = &fw.m[i * fw.stride];
+        int from = 0;
+        if(i < (size_t) n) {
+            memcpy(row, &dist[i * n], sizeof(double) * n);
+            from = n;
+        }
+        for(int j = from; j < fw.stride; j++)
+            row[j] = INFINITY;
+    }
+
+    // runs with the threads that could be created (the calling thread is the thread 0)
+    for(int t = 0; t < nthreads; t++) {
+        workers[t].fw = &fw;
+        workers[t].id = t;
+    }
+    team_start(&fw.team, threads, nthreads, &fw_worker, workers, sizeof(FloydWarshallWorker));
+    fw_worker(&workers[0]);
+    team_finish(&fw.team, threads);
+
+    bool cycle = false;
+    for(int v = 0; v < n && !cycle; v++)
+        cycle = fw.m[(size_t) v * fw.stride + v] < 0;
+
+    for(size_t i = 0; i < (size_t) n && !cycle; i++)
+        memcpy(&dist[i * n], &fw.m[i * fw.stride], sizeof(double) * n);
+
+    free(fw.m);  free(threads);  free(workers);
+    return !cycle;
+}
+
+
+/**
+ *      Finds the distances between all the pairs of vertices of the graph with
+ * the Floyd-Warshall algorithm (see apsp_floyd_warshall_matrix()). Better
+ * suited than johnson_apsp() for small dense graphs.
+ *
+ * @param g a pointer to the graph (expects a weighted digraph).
+ * @param nthreads number of threads (including the calling thread).
+ * @return a size*size row-major matrix (size = graph_array_size(g)) with the
+ * distances, which must be freed by the caller with free(), or NULL if the
+ * graph has a negative cycle or the memory couldn't be allocated.
+ */
+double* apsp_floyd_warshall(Graph *g, int nthreads)
+{
+    size_t size = graph_array_size(g);
+    double *dist = malloc(sizeof(double) * (size > 0 ? size * size : 1));
+    if(dist == NULL)
+        return NULL;
+
+    for(size_t i = 0; i < size * size; i++)
+        dist[i] = INFINITY;
+
+    for(size_t v = 0; v < size; v++) {
+        if(graph_has_vertex(g, v))
+            dist[v * size + v] = 0;
+
+        Edge *e;
+        EdgeIter it = graph_edges_begin(g, v);
+        while(edge_next(&it, &e)) {
+            double *d = &dist[v * size + edge_dest(e)];
+            if(edge_weight(e) < *d)
+                *d = edge_weight(e);    // parallel edges and self-loops
+        }
+    }
+
+    if(!apsp_floyd_warshall_matrix(dist, size, nthreads)) {
+        free(dist);
+        dist = NULL;
+    }
+
+    return dist;
+}
+
+
+/**
+ *      State shared by the threads of sp_distance_table().
+ *
+ * Attributes:
+ *      . g: the graph (only read by the threads).
+ *      . sources, ns, targets, nt: the rows and the columns of the table.
+ *      . table: the output matrix (ns rows and nt columns).
+ *      . next_source, lock: the index (in sources) of the next row to be 
+ *      taken by a thread.
+ *      . rows_done: number of rows filled (protected by lock).
+ */
+typedef struct {
+    Graph *g;
+    const int *sources, *targets;
+    int ns, nt;
+    double *table;
+
+    int next_source, rows_done;
+    pthread_mutex_t lock;
+} DistanceTable;
+
+
+/**
+ *      Main function of the threads of sp_distance_table(): takes sources 
+ * until there are none left and fills their rows. Each thread has its own 
+ * workspace, so no memory is allocated or initialized per source.
+ */
+static void* distance_table_worker(void *arg)
+{
+    DistanceTable *dt = arg;
+    SPWorkspace *ws = spw_create(graph_array_size(dt->g));
+    if(ws == NULL)
+        return NULL;    // the other threads take the work
+
+    int done = 0;
+    while(1) {
+        pthread_mutex_lock(&dt->lock);
+        int i = dt->next_source++;
+        pthread_mutex_unlock(&dt->lock);
+
+        if(i >= dt->ns)
+            break;
+
+        double *row = &dt->table[(size_t) i * dt->nt];
+        bool searched = spw_dijkstra_full(ws, dt->g, dt->sources[i], dt->targets, dt->nt, INFINITY);
+        for(int j = 0; j < dt->nt; j++)
+            row[j] = searched ? spw_path_dist(ws, dt->targets[j]) : INFINITY;
+        done++;
+    }
+
+    pthread_mutex_lock(&dt->lock);
+    dt->rows_done += done;
+    pthread_mutex_unlock(&dt->lock);
+    spw_free(&ws);
+    return NULL;
+}
+
+
+/**
+ *      Computes the distances from each of the given sources to each of the 
+ * given targets. A Dijkstra's search is run from each source, stopping as soon
+ * as all the targets are settled (see spw_dijkstra_full()), so only the part 
+ * of the graph closer to the source than the farthest target is explored. The
+ * searches are split among nthreads threads (the calling thread is one of 
+ * them), each with its own workspace. Negative weights are not supported.
+ *
+ * @param g a pointer to the graph (expects a weighted digraph).
+ * @param sources the sources (the rows of the table).
+ * @param ns the number of sources.
+ * @param targets the targets (the columns of the table).
+ * @param nt the number of targets.
+ * @param nthreads number of threads.
+ * @return a contiguous row-major matrix with ns rows and nt columns, where
+ * table[i*nt + j] is the distance from sources[i] to targets[j] (INFINITY if
+ * there is no path or if either of them isn't a vertex of g), to be freed by 
+ * the caller; or NULL if the memory couldn't be allocated.
+ */
+double* sp_distance_table(Graph *g, const int *sources, int ns, const int *targets, int nt, int nthreads)
+{
+    if(ns < 0 || nt < 0)
+        return NULL;
+
+    DistanceTable dt = {0};
+    dt.g = g;
+    dt.sources = sources;
+    dt.targets = targets;
+    dt.ns = ns;
+    dt.nt = nt;
+    dt.table = malloc(sizeof(double) * ((size_t) ns * nt > 0 ? (size_t) ns * nt : 1));
+    if(nthreads > ns)
+        nthreads = ns;
+    if(nthreads < 1)
+        nthreads = 1;
+
+    pthread_t *threads = malloc(sizeof(pthread_t) * nthreads);
+    if(dt.table == NULL || threads == NULL) {
+        free(dt.table);
+        free(threads);
+        return NULL;
+    }
+
+    pthread_mutex_init(&dt.lock, NULL);
+    int started = 1;
+    for(; started < nthreads; started++) {
+        if(pthread_create(&threads[started], NULL, &distance_table_worker, &dt) != 0)
+            break;
+    }
+    distance_table_worker(&dt);
+    for(int t = 1; t < started; t++)
+        pthread_join(threads[t], NULL);
+    pthread_mutex_destroy(&dt.lock);
+    free(threads);
+
+    if(dt.rows_done < ns) {     // no thread could allocate its workspace
+        free(dt.table);
+        return NULL;
+    }
+    return dt.table;
+}
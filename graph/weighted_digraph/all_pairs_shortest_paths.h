@@ -0,0 +1,45 @@
+/**
+ * Simple API for resolving all-pairs shortest paths problems.
+ *
+ * The distances are returned as a dense row-major matrix with one row and one
+ * column per position of the graph's array of adjacency lists (see
+ * graph_array_size()): dist[s*size + v] is the distance from s to v
+ * (INFINITY if v is unreachable from s or if either vertex doesn't exist).
+ *
+ * Example of use:
+ *      double *dist = johnson_apsp(g, 8);      // 8 threads
+ *      int size = graph_array_size(g);
+ *      printf("%f\n", dist[s*size + v]);       // distance from s to v
+ *      free(dist);
+ *
+ * Since the matrix has size^2 entries, johnson_apsp_rows() can be used
+ * instead to stream the rows, one by one, to a callback. For small dense
+ * graphs, apsp_floyd_warshall() is usually faster than johnson_apsp();
+ * apsp_floyd_warshall_matrix() works directly on a weight matrix.
+ *
+ * When only the distances between two sets of vertices are needed (e.g. a
+ * 1000x1000 table for a routing layer), sp_distance_table() computes just
+ * those, in a contiguous |S|x|T| matrix:
+ *      double *table = sp_distance_table(g, sources, ns, targets, nt, 8);
+ *      printf("%f\n", table[i*nt + j]);      // from sources[i] to targets[j]
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+#ifndef ALL_PAIRS_SHORTEST_PATHS_H
+    #define ALL_PAIRS_SHORTEST_PATHS_H
+    #include "weighted_digraph.h"
+    #include <stdbool.h>
+
+    /* Constants */
+    #define APSP_FW_TILE_SIZE 64     // order of the square tiles of apsp_floyd_warshall() (64x64 doubles = 32 KB)
+
+    /* Pathfinders */
+    double* johnson_apsp(Graph *g, int nthreads);
+    bool johnson_apsp_rows(Graph *g, int nthreads,
+                           void (*row)(int s, const double *dist, void *ctx), void *ctx);
+    double* apsp_floyd_warshall(Graph *g, int nthreads);
+    bool apsp_floyd_warshall_matrix(double *dist, int n, int nthreads);
+    double* sp_distance_table(Graph *g, const int *sources, int ns, const int *targets, int nt, int nthreads);
+#endif
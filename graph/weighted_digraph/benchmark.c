@@ -0,0 +1,1738 @@
+/**
+ * Simple program to benchmark my shortest paths implementations on randomly
+ * generated weighted digraphs.
+ *
+ * Usage:
+ *      ./benchmark [section] [num_vertices] [num_edges]
+ *
+ * If no section is given, all of them are executed. Sections:
+ *      dijkstra   - linear search Dijkstra vs. heap-based Dijkstra
+ *      dial       - heap-based Dijkstra vs. Dial's algorithm (integer weights)
+ *      bellman    - naive |V|-pass Bellman-Ford vs. queue-based Bellman-Ford, 
+ *                   on the test*.txt graphs and on a graph with negative weights
+ *      delta      - delta-stepping with 1, 2, 4, 8 and 16 threads vs. Dijkstra and 
+ *                   a check of its distances on smaller random graphs
+ *      p2p        - dijkstra_sp() + spt_path_to() vs. bidirectional Dijkstra,
+ *                   without and with the in-edge index
+ *      astar      - A* (Manhattan distance) vs. Dijkstra on a grid with ~|V| 
+ *                   vertices (settled vertices, relaxed edges and time)
+ *      ch         - contraction hierarchies on a grid with ~|V| vertices: 
+ *                   preprocessing time and query time vs. Dijkstra
+ *      alt        - ALT landmarks on a grid with ~|V| vertices: preprocessing 
+ *                   with 1 and 4 threads, save/load time and queries vs. A* 
+ *                   (Manhattan distance) and Dijkstra
+ *      johnson    - Johnson's algorithm with 1, 2, 4 and 8 threads vs. |V| calls
+ *                   to dijkstra_sp() (at most 2000 vertices and 5 edges per
+ *                   vertex), then on a graph with negative weights, checked 
+ *                   against bellman_ford_sp()
+ *      floyd      - Floyd-Warshall (tiled, AVX2) with 1 and 4 threads vs. |V| 
+ *                   calls to dijkstra_sp() and Johnson's algorithm on random 
+ *                   graphs with 512, 2048 and 8192 vertices (only the sizes 
+ *                   up to |V|) and 16 edges per vertex
+ *      alloc      - number of memory allocations done to build the graph and by
+ *                   dijkstra_sp() and dijkstra_sp_int() vs. the number of 
+ *                   relaxed edges
+ *      scan       - neighbour scans per second: edges_from_vertix() (copies) 
+ *                   vs. graph_edges_begin()/edge_next() (no copies)
+ *      csr        - graph_freeze() time, then dijkstra_sp() vs. dijkstra_sp_csr() 
+ *                   and a BFS on the CSR snapshot; also checks the distances
+ *                   of the other *_csr() searches against the graph's ones
+ *      churn      - removal of |V|/10 vertices without and with the in-edge 
+ *                   index
+ *      sparse     - insertions, lookups and memory footprint of |V| vertices 
+ *                   with sparse identifiers: used as indices vs. mapped to 
+ *                   slots by keys (identifiers up to 10^7 and random 64-bit 
+ *                   keys)
+ *      load       - bulk load of 10^7 edges (10^6 vertices, added in increasing
+ *                   order) with the old fixed growth of the array of adjacency
+ *                   lists (10 slots per realloc), with geometric growth and 
+ *                   with graph_reserve() (ignores |V| and |E|)
+ *      bulk       - 10^7 random edges (10^6 vertices) added with graph_add_edge()
+ *                   vs. graph_add_edges_bulk_full() without and with the radix
+ *                   sort (ignores |V| and |E|)
+ *      binary     - startup time: text commands ("1 s d w", parsed as main.c 
+ *                   does) vs. graph_save_binary() + graph_mmap_open(), then 
+ *                   dijkstra_sp_csr() and csr_validate() on the mapped snapshot
+ *      text       - |E| edges as text commands ("1 s d w"): scanf() (like 
+ *                   main.c) vs. graph_load_text() with 1 and 4 threads
+ *      bounded    - dijkstra_sp() vs. dijkstra_sp_bounded() for 5 nearby 
+ *                   targets and for a small radius
+ *      workspace  - fresh SPTs vs. a reused SPWorkspace: whole trees 
+ *                   (dijkstra_sp() vs. spw_dijkstra()) and radius queries 
+ *                   (dijkstra_sp_bounded() vs. spw_dijkstra_full())
+ *      table      - 200x200 distance table between vertices of a region of
+ *                   a grid with ~|V| vertices: one dijkstra_sp() per source 
+ *                   vs. sp_distance_table() with 1 and 4 threads
+ *      dynamic    - 1000 random edge weight changes: a new dijkstra_sp() after
+ *                   each one vs. spt_apply_edge_update(), without and with 
+ *                   the in-edge index
+ *      mst        - minimum spanning forests with Prim's, Kruskal's and
+ *                   Boruvka's (1 and 4 threads) algorithms on a sparse random
+ *                   graph (|V|, |E|) and on a dense one (|V|/10 vertices, |E|
+ *                   edges)
+ *
+ * The allocations are counted by wrapping malloc(), calloc() and realloc() at 
+ * link time (see the bench target of the makefile).
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "weighted_digraph.h"
+#include "shortest_paths.h"
+#include "indexed_heap.h"
+#include "singly_linked_list.h"
+#include "contraction_hierarchies.h"
+#include "landmarks.h"
+#include "all_pairs_shortest_paths.h"
+#include "csr_graph.h"
+#include "text_loader.h"
+#include "mst.h"
+
+
+/* Default sizes of the generated graphs */
+#define BENCH_DEFAULT_VERTICES 20000
+#define BENCH_DEFAULT_EDGES 100000
+#define BENCH_QUERIES 5
+#define BENCH_SPARSE_MAX_ID 10000000     // highest identifier of the [sparse] benchmark's indexed vertices
+#define BENCH_LOAD_VERTICES 1000000
+#define BENCH_LOAD_EDGES 10000000
+#define BENCH_BOUNDED_RADIUS 500          // radius of the [bounded] benchmark's queries
+#define BENCH_TABLE_SIZE 200              // number of sources and of targets of the [table] benchmark
+#define BENCH_DYNAMIC_UPDATES 1000        // number of weight changes of the [dynamic] benchmark
+
+
+/**
+ * State of the pseudo-random number generator (xorshift32). A fixed seed is
+ * used so that every run generates the same graphs.
+ */
+static unsigned int rng_state = 2463534242u;
+
+static unsigned int rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+
+/**
+ *      Number of calls to malloc(), calloc() and realloc() so far. The linker 
+ * redirects the calls made by every object of the benchmark to the wrappers 
+ * below (-Wl,--wrap=malloc ...).
+ */
+static long long num_allocs;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void *ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    __atomic_fetch_add(&num_allocs, 1, __ATOMIC_RELAXED);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+    __atomic_fetch_add(&num_allocs, 1, __ATOMIC_RELAXED);
+    return __real_calloc(n, size);
+}
+
+void* __wrap_realloc(void *ptr, size_t size) {
+    __atomic_fetch_add(&num_allocs, 1, __ATOMIC_RELAXED);
+    return __real_realloc(ptr, size);
+}
+
+
+/**
+ * Returns the current time, in seconds, of a monotonic clock.
+ */
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+/**
+ *      Generates a random weighted digraph with n vertices (0 to n-1) and m
+ * edges. In order to make most of the vertices reachable from the vertex 0, the
+ * first n-1 edges form a path 0->1->...->n-1; the remaining edges are random.
+ * The weights are integers in the range [1, max_weight].
+ */
+static Graph* random_graph(int n, int m, int max_weight)
+{
+    Graph *g = graph_create_full(n, n);
+    for(int v = 0; v < n; v++)
+        graph_add_vertex(g, v);
+
+    for(int i = 0; i < m; i++) {
+        int v, w;
+        if(i < n - 1) {
+            v = i;  w = i + 1;
+        }
+        else {
+            v = rng_next() % n;  w = rng_next() % n;
+        }
+        graph_add_edge(g, v, w, 1 + rng_next() % max_weight, false);
+    }
+
+    return g;
+}
+
+
+/**
+ *      Generates a random weighted digraph, just like random_graph(), but with 
+ * negative weights and no negative cycles: each vertex v gets a random 
+ * potential p(v) and the weight of an edge v->w is r + p(v) - p(w), where r is 
+ * a random integer in the range [0, max_weight]. The weight of any cycle is 
+ * the sum of the r's of its edges (the potentials cancel out), so it's never 
+ * negative.
+ */
+static Graph* random_graph_negative(int n, int m, int max_weight)
+{
+    Graph *g = graph_create_full(n, n);
+    int *p = malloc(sizeof(int) * n);
+    for(int v = 0; v < n; v++) {
+        graph_add_vertex(g, v);
+        p[v] = rng_next() % max_weight;
+    }
+
+    for(int i = 0; i < m; i++) {
+        int v, w;
+        if(i < n - 1) {
+            v = i;  w = i + 1;
+        }
+        else {
+            v = rng_next() % n;  w = rng_next() % n;
+        }
+        graph_add_edge(g, v, w, (int) (rng_next() % (max_weight + 1)) + p[v] - p[w], false);
+    }
+
+    free(p);
+    return g;
+}
+
+
+/**
+ *      Builds a graph by replaying the commands of one of the test*.txt files 
+ * (only the commands that change the graph are considered; see main.c). 
+ * Returns NULL if the file couldn't be opened.
+ */
+static Graph* load_test_graph(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if(f == NULL)
+        return NULL;
+
+    Graph *g = graph_create();
+    int opt, v, w;  double weight;
+    while(fscanf(f, " %d", &opt) == 1 && opt != 0) {
+        if(opt == 1 && fscanf(f, " %d %d %lf", &v, &w, &weight) == 3)
+            graph_add_edge(g, v, w, weight, true);
+        else if(opt == 2 && fscanf(f, " %d %d", &v, &w) == 2)
+            graph_remove_edge(g, v, w);
+        else if(opt == 3 && fscanf(f, " %d", &v) == 1)
+            graph_add_vertex(g, v);
+        else if(opt == 4 && fscanf(f, " %d", &v) == 1)
+            graph_remove_vertex(g, v);
+        else if((opt == 7 || opt == 8) && fscanf(f, " %d %d", &v, &w) != 2)
+            break;
+    }
+
+    fclose(f);
+    return g;
+}
+
+
+/**
+ * Checks whether two SPTs hold the same distances. Auxiliary function.
+ */
+static bool same_distances(SPT *a, SPT *b)
+{
+    if(spt_size(a) != spt_size(b))
+        return false;
+
+    for(int v = 0; v < spt_size(a); v++) {
+        double da = spt_path_dist(a, v), db = spt_path_dist(b, v);
+        if(da != db && !(isinf(da) && isinf(db)))
+            return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Runs the given pathfinder from a few fixed sources and returns the average
+ * time, in milliseconds, of each query. The SPT of the last query is stored in
+ * last (if it isn't NULL).
+ */
+static double time_sssp(SPT* (*sp)(Graph*, int), Graph *g, SPT **last)
+{
+    double total = 0;
+    for(int q = 0; q < BENCH_QUERIES; q++) {
+        int s = (q * (graph_num_vertices(g) / BENCH_QUERIES)) % graph_num_vertices(g);
+
+        double start = now();
+        SPT *spt = sp(g, s);
+        total += now() - start;
+
+        if(last != NULL && q == BENCH_QUERIES - 1)
+            *last = spt;
+        else
+            spt_free(&spt);
+    }
+
+    return 1000 * total / BENCH_QUERIES;
+}
+
+
+/**
+ * [dijkstra] Linear search Dijkstra vs. heap-based Dijkstra on the same graph.
+ */
+static void bench_dijkstra(int n, int m)
+{
+    Graph *g = random_graph(n, m, 1000);
+    SPT *a = NULL, *b = NULL;
+
+    double t_linear = time_sssp(&dijkstra_sp_linear, g, &a);
+    double t_heap = time_sssp(&dijkstra_sp, g, &b);
+
+    printf("[dijkstra] |V| = %d  |E| = %d\n", n, m);
+    printf("    linear search: %10.3f ms/query\n", t_linear);
+    printf("    %d-ary heap:    %10.3f ms/query  (speedup: %.1fx)\n",
+            IHEAP_DEFAULT_ARITY, t_heap, t_linear / t_heap);
+    printf("    same distances: %s\n\n", same_distances(a, b) ? "yes" : "NO");
+
+    spt_free(&a);  spt_free(&b);
+    graph_free(&g);
+}
+
+
+/**
+ * Wrapper for dijkstra_sp_int() with the weights used by bench_dial().
+ */
+static SPT* dial_sp(Graph *g, int s) {
+    return dijkstra_sp_int(g, s, 1023);
+}
+
+
+/**
+ * [dial] Heap-based Dijkstra vs. Dial's algorithm on a graph with weights in 
+ * the range [1, 1023].
+ */
+static void bench_dial(int n, int m)
+{
+    Graph *g = random_graph(n, m, 1023);
+    SPT *a = NULL, *b = NULL;
+
+    double t_heap = time_sssp(&dijkstra_sp, g, &a);
+    double t_dial = time_sssp(&dial_sp, g, &b);
+
+    printf("[dial] |V| = %d  |E| = %d  (weights in [1, 1023])\n", n, m);
+    printf("    %d-ary heap:    %10.3f ms/query\n", IHEAP_DEFAULT_ARITY, t_heap);
+    printf("    dial buckets:  %10.3f ms/query  (speedup: %.1fx)\n", t_dial, t_heap / t_dial);
+    printf("    same distances: %s\n\n", same_distances(a, b) ? "yes" : "NO");
+
+    spt_free(&a);  spt_free(&b);
+    graph_free(&g);
+}
+
+
+/**
+ *      Naive version of the Bellman-Ford algorithm: relaxes every edge of the 
+ * graph in each pass, stopping after |V|-1 passes or after a pass in which no 
+ * distance changed. Returns the array of distances from s (the caller must 
+ * free it).
+ */
+static double* naive_bellman_ford(Graph *g, int s)
+{
+    int size = graph_array_size(g);
+    double *dist = malloc(sizeof(double) * size);
+    for(int v = 0; v < size; v++)
+        dist[v] = INFINITY;
+    dist[s] = 0;
+
+    for(int pass = 1; pass < graph_num_vertices(g); pass++) {
+        bool changed = false;
+        for(int v = 0; v < size; v++) {
+            if(isinf(dist[v]))
+                continue;
+
+            Edge *e;
+            EdgeIter it = graph_edges_begin(g, v);
+            while(edge_next(&it, &e)) {
+                int w = edge_dest(e);
+                if(dist[v] + edge_weight(e) < dist[w]) {
+                    dist[w] = dist[v] + edge_weight(e);
+                    changed = true;
+                }
+            }
+        }
+
+        if(!changed)
+            break;
+    }
+
+    return dist;
+}
+
+
+/**
+ *      Times the naive Bellman-Ford and bellman_ford_sp() from every vertex 
+ * in the list of sources and prints the results. Auxiliary function.
+ */
+static void compare_bellman_ford(const char *name, Graph *g, int *sources, int num_sources)
+{
+    double t_naive = 0, t_queue = 0;
+    bool same = true;
+
+    for(int i = 0; i < num_sources; i++) {
+        double start = now();
+        double *dist = naive_bellman_ford(g, sources[i]);
+        t_naive += now() - start;
+
+        start = now();
+        SPT *spt = bellman_ford_sp(g, sources[i]);
+        t_queue += now() - start;
+
+        for(int v = 0; v < graph_array_size(g); v++) {
+            if(dist[v] != spt_path_dist(spt, v) && !(isinf(dist[v]) && isinf(spt_path_dist(spt, v))))
+                same = false;
+        }
+        free(dist);
+        spt_free(&spt);
+    }
+
+    printf("    %-12s |V| = %-8d |E| = %-8d naive: %10.3f ms/query   queue: %10.3f ms/query   same distances: %s\n",
+            name, graph_num_vertices(g), graph_num_edges(g), 
+            1000 * t_naive / num_sources, 1000 * t_queue / num_sources, same ? "yes" : "NO");
+}
+
+
+/**
+ *      [bellman] Naive Bellman-Ford vs. queue-based Bellman-Ford on the graphs 
+ * described by the test*.txt files (from all of their vertices) and on a random 
+ * graph with negative weights.
+ */
+static void bench_bellman_ford(int n, int m)
+{
+    printf("[bellman]\n");
+    for(int i = 1; i <= 5; i++) {
+        char path[32];
+        sprintf(path, "test%d.txt", i);
+        Graph *g = load_test_graph(path);
+        if(g == NULL)
+            continue;
+
+        int *sources = graph_vertices(g);
+        if(sources != NULL)
+            compare_bellman_ford(path, g, sources, graph_num_vertices(g));
+        free(sources);
+        graph_free(&g);
+    }
+
+    Graph *g = random_graph_negative(n, m, 1000);
+    int sources[BENCH_QUERIES];
+    for(int q = 0; q < BENCH_QUERIES; q++)
+        sources[q] = q * (n / BENCH_QUERIES);
+
+    compare_bellman_ford("random", g, sources, BENCH_QUERIES);
+    printf("\n");
+    graph_free(&g);
+}
+
+
+/**
+ *      [delta] Scaling of delta_stepping_sp() with the number of threads and a 
+ * check that its distances match the ones found by dijkstra_sp() on a few 
+ * smaller random graphs.
+ */
+static void bench_delta_stepping(int n, int m)
+{
+    int threads[] = {1, 2, 4, 8, 16};
+    Graph *g = random_graph(n, m, 1000);
+    int s = 0;
+
+    double start = now();
+    SPT *expected = dijkstra_sp(g, s);
+    double t_dijkstra = now() - start;
+
+    printf("[delta] |V| = %d  |E| = %d\n", n, m);
+    printf("    dijkstra_sp:          %10.3f ms\n", 1000 * t_dijkstra);
+    for(int i = 0; i < 5; i++) {
+        start = now();
+        SPT *spt = delta_stepping_sp(g, s, 0, threads[i]);
+        double t = now() - start;
+
+        printf("    delta-stepping (%2d): %10.3f ms  (speedup over dijkstra_sp: %.2fx)  same distances: %s\n",
+                threads[i], 1000 * t, t_dijkstra / t, same_distances(expected, spt) ? "yes" : "NO");
+        spt_free(&spt);
+    }
+    spt_free(&expected);
+    graph_free(&g);
+
+    int ok = 0, total = 0;
+    for(int i = 0; i < 20; i++) {
+        int gn = 50 + rng_next() % 2000, gm = gn + rng_next() % (8 * gn);
+        Graph *rg = random_graph(gn, gm, 1 + rng_next() % 100);
+        int src = rng_next() % gn;
+        double delta = (i % 2 == 0) ? 0 : 1 + rng_next() % 50;
+
+        SPT *a = dijkstra_sp(rg, src), *b = delta_stepping_sp(rg, src, delta, 1 + i % 8);
+        ok += same_distances(a, b);
+        total++;
+
+        spt_free(&a);  spt_free(&b);
+        graph_free(&rg);
+    }
+    printf("    random graphs with the same distances as dijkstra_sp: %d/%d\n\n", ok, total);
+}
+
+
+/**
+ *      [p2p] Point-to-point queries: dijkstra_sp() followed by spt_path_to() vs.
+ * dijkstra_p2p(), on random pairs of vertices, without and with the graph's 
+ * in-edge index.
+ */
+static void bench_p2p(int n, int m)
+{
+    Graph *g = random_graph(n, m, 1000);
+    double t_full = 0, t_p2p = 0, t_indexed = 0;
+    int same = 0, pairs[BENCH_QUERIES][2];
+
+    for(int q = 0; q < BENCH_QUERIES; q++) {
+        int s = pairs[q][0] = rng_next() % n, t = pairs[q][1] = rng_next() % n;
+
+        double start = now();
+        SPT *spt = dijkstra_sp(g, s);
+        List *path = spt_path_to(spt, t);
+        t_full += now() - start;
+
+        double dist;
+        start = now();
+        List *path2 = dijkstra_p2p(g, s, t, &dist);
+        t_p2p += now() - start;
+
+        same += (dist == spt_path_dist(spt, t)) && ((path == NULL) == (path2 == NULL));
+        if(path != NULL)
+            list_free(&path, &free);
+        if(path2 != NULL)
+            list_free(&path2, &free);
+        spt_free(&spt);
+    }
+
+    graph_enable_in_edges(g);
+    for(int q = 0; q < BENCH_QUERIES; q++) {
+        double dist, start = now();
+        List *path = dijkstra_p2p(g, pairs[q][0], pairs[q][1], &dist);
+        t_indexed += now() - start;
+
+        if(path != NULL)
+            list_free(&path, &free);
+    }
+
+    printf("[p2p] |V| = %d  |E| = %d\n", n, m);
+    printf("    dijkstra_sp + spt_path_to: %10.3f ms/query\n", 1000 * t_full / BENCH_QUERIES);
+    printf("    dijkstra_p2p:              %10.3f ms/query  (speedup: %.1fx)\n", 
+            1000 * t_p2p / BENCH_QUERIES, t_full / t_p2p);
+    printf("    dijkstra_p2p (in-edges):   %10.3f ms/query  (speedup: %.1fx)\n", 
+            1000 * t_indexed / BENCH_QUERIES, t_full / t_indexed);
+    printf("    same distances: %d/%d\n\n", same, BENCH_QUERIES);
+    graph_free(&g);
+}
+
+
+/**
+ *      Generates a width x width grid in which each cell (vertex r*width + c) 
+ * is linked to its 4 neighbours by edges (one in each direction) with random 
+ * weights in the range [1, 10]. Road networks look a lot more like this than 
+ * like the graphs generated by random_graph().
+ */
+static Graph* grid_graph(int width)
+{
+    int n = width * width;
+    Graph *g = graph_create_full(n, n);
+    for(int v = 0; v < n; v++) {
+        int r = v / width, c = v % width;
+        if(c + 1 < width) {
+            graph_add_edge(g, v, v + 1, 1 + rng_next() % 10, true);
+            graph_add_edge(g, v + 1, v, 1 + rng_next() % 10, true);
+        }
+        if(r + 1 < width) {
+            graph_add_edge(g, v, v + width, 1 + rng_next() % 10, true);
+            graph_add_edge(g, v + width, v, 1 + rng_next() % 10, true);
+        }
+    }
+
+    return g;
+}
+
+
+/**
+ * Width of the grid generated by bench_astar(), used by grid_heuristic().
+ */
+static int grid_width;
+
+
+/**
+ *      Heuristic used by bench_astar(): Manhattan distance between the vertex v
+ * and the target (pointed by ctx) on the grid. Since the weights are at least 1, 
+ * it never overestimates the distance.
+ */
+static double grid_heuristic(int v, void *ctx)
+{
+    int t = *((int*) ctx);
+    return abs(v / grid_width - t / grid_width) + abs(v % grid_width - t % grid_width);
+}
+
+
+/**
+ *      [astar] A* with the Manhattan distance as heuristic vs. Dijkstra stopping 
+ * at the target vs. the full dijkstra_sp() on a grid where each cell is linked to
+ * its 4 neighbours by edges with weights in the range [1, 10].
+ */
+static void bench_astar(int n)
+{
+    grid_width = (int) sqrt(n);
+    n = grid_width * grid_width;
+    Graph *g = grid_graph(grid_width);
+
+    double t_astar = 0, t_early = 0, t_full = 0;
+    long long settled[3] = {0}, relaxed[3] = {0};
+    int same = 0;
+
+    for(int q = 0; q < BENCH_QUERIES; q++) {
+        int s = rng_next() % n, t = rng_next() % n;
+
+        double start = now();
+        SPT *a = astar_sp(g, s, t, &grid_heuristic, &t);
+        t_astar += now() - start;
+
+        start = now();
+        SPT *b = astar_sp(g, s, t, NULL, NULL);
+        t_early += now() - start;
+
+        start = now();
+        SPT *c = dijkstra_sp(g, s);
+        t_full += now() - start;
+
+        SPT *spts[3] = {a, b, c};
+        for(int i = 0; i < 3; i++) {
+            settled[i] += spt_num_settled(spts[i]);
+            relaxed[i] += spt_num_relaxed(spts[i]);
+        }
+        same += spt_path_dist(a, t) == spt_path_dist(c, t) && spt_path_dist(b, t) == spt_path_dist(c, t);
+        spt_free(&a);  spt_free(&b);  spt_free(&c);
+    }
+
+    printf("[astar] %dx%d grid\n", grid_width, grid_width);
+    printf("    A* (manhattan):     %10.3f ms/query   settled: %10lld   relaxed: %10lld\n", 
+            1000 * t_astar / BENCH_QUERIES, settled[0] / BENCH_QUERIES, relaxed[0] / BENCH_QUERIES);
+    printf("    dijkstra (stop @t): %10.3f ms/query   settled: %10lld   relaxed: %10lld\n", 
+            1000 * t_early / BENCH_QUERIES, settled[1] / BENCH_QUERIES, relaxed[1] / BENCH_QUERIES);
+    printf("    dijkstra_sp:        %10.3f ms/query   settled: %10lld   relaxed: %10lld\n", 
+            1000 * t_full / BENCH_QUERIES, settled[2] / BENCH_QUERIES, relaxed[2] / BENCH_QUERIES);
+    printf("    same distances: %d/%d\n\n", same, BENCH_QUERIES);
+    graph_free(&g);
+}
+
+
+/**
+ * Sums the weights of the edges in a path. Auxiliary function.
+ */
+static double path_weight(List *path)
+{
+    double total = 0;
+    for(Node *n = list_head(path); n != NULL; n = list_next_node(n))
+        total += edge_weight(list_node_item(n));
+    return total;
+}
+
+
+/**
+ *      [ch] Contraction hierarchies on a grid: preprocessing time, then query 
+ * time (with the paths unpacked) vs. dijkstra_sp() + spt_path_to() and 
+ * dijkstra_p2p(). The paths' weights are checked against dijkstra_sp().
+ */
+static void bench_ch(int n)
+{
+    int width = (int) sqrt(n);
+    Graph *g = grid_graph(width);
+
+    double start = now();
+    CH *ch = ch_create(g);
+    double t_pre = now() - start;
+
+    printf("[ch] %dx%d grid  (|V| = %d  |E| = %d)\n", width, width, graph_num_vertices(g), graph_num_edges(g));
+    printf("    preprocessing:              %10.3f ms  (%d shortcuts)\n", 1000 * t_pre, ch_num_shortcuts(ch));
+
+    int queries = 1000, same = 0;
+    long long settled = 0;
+    double t_ch = 0;
+    for(int q = 0; q < queries; q++) {
+        int s = rng_next() % (width * width), t = rng_next() % (width * width);
+        double dist;
+
+        start = now();
+        List *path = ch_path(ch, s, t, &dist);
+        t_ch += now() - start;
+        settled += ch_last_settled(ch);
+
+        // checks a few of the queries against Dijkstra
+        if(q < BENCH_QUERIES) {
+            SPT *spt = dijkstra_sp(g, s);
+            same += dist == spt_path_dist(spt, t) && path != NULL && path_weight(path) == dist;
+            spt_free(&spt);
+        }
+        if(path != NULL)
+            list_free(&path, &free);
+    }
+
+    double t_full = 0, t_p2p = 0;
+    for(int q = 0; q < BENCH_QUERIES; q++) {
+        int s = rng_next() % (width * width), t = rng_next() % (width * width);
+        double dist;
+
+        start = now();
+        SPT *spt = dijkstra_sp(g, s);
+        List *path = spt_path_to(spt, t);
+        t_full += now() - start;
+        list_free(&path, &free);
+        spt_free(&spt);
+
+        start = now();
+        path = dijkstra_p2p(g, s, t, &dist);
+        t_p2p += now() - start;
+        list_free(&path, &free);
+    }
+
+    printf("    ch_path:                    %10.4f ms/query  (settled: %lld)\n", 
+            1000 * t_ch / queries, settled / queries);
+    printf("    dijkstra_sp + spt_path_to:  %10.4f ms/query\n", 1000 * t_full / BENCH_QUERIES);
+    printf("    dijkstra_p2p:               %10.4f ms/query\n", 1000 * t_p2p / BENCH_QUERIES);
+    printf("    same distances as dijkstra_sp: %d/%d\n\n", same, BENCH_QUERIES);
+
+    ch_free(&ch);
+    graph_free(&g);
+}
+
+
+/**
+ *      [alt] ALT on a grid: preprocessing time (farthest landmarks, 1 and 4 
+ * threads), time to save and to load (mmap) the index, then settled vertices 
+ * and query time vs. A* with the Manhattan distance and Dijkstra stopping at 
+ * the target. The distances are checked against dijkstra_sp().
+ */
+static void bench_alt(int n)
+{
+    grid_width = (int) sqrt(n);
+    n = grid_width * grid_width;
+    Graph *g = grid_graph(grid_width);
+    const int k = 16;
+    const char *path = "benchmark.alt";
+
+    printf("[alt] %dx%d grid, %d landmarks\n", grid_width, grid_width, k);
+    int nthreads[] = {1, 4};
+    ALT *alt = NULL;
+    for(int i = 0; i < 2; i++) {
+        double start = now();
+        ALT *a = alt_create(g, k, ALT_SELECT_FARTHEST, nthreads[i]);
+        printf("    preprocessing (%d thread%s): %10.3f ms\n", nthreads[i], 
+                nthreads[i] > 1 ? "s" : " ", 1000 * (now() - start));
+        if(alt != NULL)
+            alt_free(&alt);
+        alt = a;
+    }
+
+    double start = now();
+    bool saved = alt_save(alt, path);
+    double t_save = now() - start;
+    alt_free(&alt);
+
+    start = now();
+    alt = saved ? alt_load(path) : NULL;
+    double t_load = now() - start;
+    if(alt == NULL) {
+        printf("    couldn't save/load the index!\n\n");
+        graph_free(&g);
+        return;
+    }
+    printf("    alt_save: %.3f ms   alt_load: %.3f ms\n", 1000 * t_save, 1000 * t_load);
+
+    int queries = 100, same = 0;
+    double times[3] = {0};
+    long long settled[3] = {0};
+    for(int q = 0; q < queries; q++) {
+        int s = rng_next() % n, t = rng_next() % n;
+        SPT *spts[3];
+
+        start = now();
+        spts[0] = alt_sp(alt, g, s, t);
+        times[0] += now() - start;
+
+        start = now();
+        spts[1] = astar_sp(g, s, t, &grid_heuristic, &t);
+        times[1] += now() - start;
+
+        start = now();
+        spts[2] = astar_sp(g, s, t, NULL, NULL);
+        times[2] += now() - start;
+
+        for(int i = 0; i < 3; i++)
+            settled[i] += spt_num_settled(spts[i]);
+
+        if(q < BENCH_QUERIES) {
+            SPT *full = dijkstra_sp(g, s);
+            same += spt_path_dist(spts[0], t) == spt_path_dist(full, t);
+            spt_free(&full);
+        }
+        for(int i = 0; i < 3; i++)
+            spt_free(&spts[i]);
+    }
+
+    const char *names[3] = {"ALT", "A* (manhattan)", "dijkstra (stop @t)"};
+    for(int i = 0; i < 3; i++)
+        printf("    %-20s %10.4f ms/query   settled: %10lld\n", names[i], 
+                1000 * times[i] / queries, settled[i] / queries);
+    printf("    same distances as dijkstra_sp: %d/%d\n\n", same, BENCH_QUERIES);
+
+    alt_free(&alt);
+    remove(path);
+    graph_free(&g);
+}
+
+
+/**
+ * Checks whether a row of a distance matrix matches the distances of a SPT.
+ */
+static bool same_row(const double *row, SPT *spt)
+{
+    for(int v = 0; v < spt_size(spt); v++) {
+        double d = spt_path_dist(spt, v);
+        if(row[v] != d && !(isinf(row[v]) && isinf(d)))
+            return false;
+    }
+    return true;
+}
+
+
+/* Number of finite distances seen by count_row() */
+static long long rows_finite;
+
+/**
+ * Callback of johnson_apsp_rows() that just counts the finite distances.
+ */
+static void count_row(int s, const double *dist, void *ctx)
+{
+    (void) s;
+    long long count = 0;
+    for(int v = 0; v < graph_array_size(ctx); v++)
+        count += !isinf(dist[v]);
+    __atomic_fetch_add(&rows_finite, count, __ATOMIC_RELAXED);
+}
+
+
+/**
+ *      [johnson] Johnson's algorithm (dense matrix and streamed rows) vs. |V| 
+ * calls to dijkstra_sp() on a random graph with positive weights; then, on a 
+ * graph with negative weights, a few rows are checked against 
+ * bellman_ford_sp().
+ */
+static void bench_johnson(int n)
+{
+    if(n > 2000)
+        n = 2000;
+    Graph *g = random_graph(n, 5*n, 100);
+    printf("[johnson] |V| = %d  |E| = %d\n", graph_num_vertices(g), graph_num_edges(g));
+
+    double start = now();
+    for(int s = 0; s < n; s++) {
+        SPT *spt = dijkstra_sp(g, s);
+        spt_free(&spt);
+    }
+    printf("    |V| x dijkstra_sp:          %10.3f ms\n", 1000 * (now() - start));
+
+    int nthreads[] = {1, 2, 4, 8}, same = 0;
+    for(int i = 0; i < 4; i++) {
+        start = now();
+        double *dist = johnson_apsp(g, nthreads[i]);
+        printf("    johnson_apsp (%d thread%s):   %10.3f ms\n", nthreads[i], 
+                nthreads[i] > 1 ? "s" : " ", 1000 * (now() - start));
+
+        for(int s = 0; i == 0 && s < BENCH_QUERIES; s++) {
+            SPT *spt = dijkstra_sp(g, s);
+            same += same_row(&dist[(size_t) s * n], spt);
+            spt_free(&spt);
+        }
+        free(dist);
+    }
+
+    rows_finite = 0;
+    start = now();
+    johnson_apsp_rows(g, 4, &count_row, g);
+    printf("    johnson_apsp_rows (4 threads): %7.3f ms  (%lld finite distances)\n", 
+            1000 * (now() - start), rows_finite);
+    printf("    same rows as dijkstra_sp: %d/%d\n", same, BENCH_QUERIES);
+    graph_free(&g);
+
+    g = random_graph_negative(n, 5*n, 100);
+    start = now();
+    double *dist = johnson_apsp(g, 4);
+    printf("    negative weights, johnson_apsp (4 threads): %10.3f ms\n", 1000 * (now() - start));
+
+    same = 0;
+    for(int s = 0; dist != NULL && s < BENCH_QUERIES; s++) {
+        SPT *spt = bellman_ford_sp(g, s);
+        same += same_row(&dist[(size_t) s * n], spt);
+        spt_free(&spt);
+    }
+    printf("    same rows as bellman_ford_sp: %d/%d\n\n", same, BENCH_QUERIES);
+
+    free(dist);
+    graph_free(&g);
+}
+
+
+/**
+ *      [floyd] Floyd-Warshall vs. |V| calls to dijkstra_sp() and vs. 
+ * johnson_apsp() on random graphs with 16 edges per vertex. The matrices are 
+ * compared with each other.
+ */
+static void bench_floyd_warshall(int max_n)
+{
+    int sizes[] = {512, 2048, 8192};
+    for(int i = 0; i < 3 && sizes[i] <= max_n; i++) {
+        int n = sizes[i];
+        Graph *g = random_graph(n, 16*n, 100);
+        printf("[floyd] |V| = %d  |E| = %d\n", n, graph_num_edges(g));
+
+        double start = now();
+        for(int s = 0; s < n; s++) {
+            SPT *spt = dijkstra_sp(g, s);
+            spt_free(&spt);
+        }
+        printf("    |V| x dijkstra_sp:                %10.3f ms\n", 1000 * (now() - start));
+
+        start = now();
+        double *johnson = johnson_apsp(g, 1);
+        printf("    johnson_apsp (1 thread):          %10.3f ms\n", 1000 * (now() - start));
+
+        double *fw = NULL;
+        int nthreads[] = {1, 4};
+        for(int t = 0; t < 2; t++) {
+            free(fw);
+            start = now();
+            fw = apsp_floyd_warshall(g, nthreads[t]);
+            printf("    apsp_floyd_warshall (%d thread%s):  %10.3f ms\n", nthreads[t], 
+                    nthreads[t] > 1 ? "s" : " ", 1000 * (now() - start));
+        }
+
+        bool same = johnson != NULL && fw != NULL;
+        for(size_t k = 0; same && k < (size_t) n * n; k++)
+            same = johnson[k] == fw[k] || (isinf(johnson[k]) && isinf(fw[k]));
+        printf("    same matrices: %s\n\n", same ? "yes" : "NO");
+
+        free(johnson);  free(fw);
+        graph_free(&g);
+    }
+}
+
+
+/**
+ *      [alloc] Counts the allocations done to build the graph (the edges are 
+ * stored in per-vertex arrays that double when full, so there are O(log(degree)) 
+ * of them per vertex) and by a search from the vertex 0. The searches only 
+ * allocate their own structures (the SPT, the priority queue, ...), so the 
+ * count doesn't depend on the number of relaxations.
+ */
+static void bench_allocs(int n, int m)
+{
+    long long before = num_allocs;
+    Graph *g = random_graph(n, m, 100);
+    printf("[alloc] |V| = %d  |E| = %d\n", n, m);
+    printf("    %-16s allocations: %lld\n", "random_graph", num_allocs - before);
+
+    const char *names[2] = {"dijkstra_sp", "dijkstra_sp_int"};
+    for(int i = 0; i < 2; i++) {
+        long long before = num_allocs;
+        SPT *spt = (i == 0) ? dijkstra_sp(g, 0) : dijkstra_sp_int(g, 0, 100);
+        printf("    %-16s relaxed: %9lld   allocations: %lld\n", 
+                names[i], spt_num_relaxed(spt), num_allocs - before);
+        spt_free(&spt);
+    }
+    printf("\n");
+    graph_free(&g);
+}
+
+
+/**
+ *      [scan] Visits every edge of the graph several times, summing the 
+ * weights, with edges_from_vertix() and with the edge iterator.
+ */
+static void bench_scan(int n, int m)
+{
+    Graph *g = random_graph(n, m, 100);
+    const int rounds = 20;
+    double sums[2] = {0}, times[2];
+
+    double start = now();
+    for(int r = 0; r < rounds; r++) {
+        for(int v = 0; v < n; v++) {
+            int deg = vertex_adj_size(g, v);
+            Edge **edges = edges_from_vertix(g, v);
+            for(int e = 0; e < deg; e++)
+                sums[0] += edge_weight(edges[e]);
+            if(edges != NULL)
+                free_edges_array(&edges, deg);
+        }
+    }
+    times[0] = now() - start;
+
+    start = now();
+    for(int r = 0; r < rounds; r++) {
+        for(int v = 0; v < n; v++) {
+            Edge *e;
+            EdgeIter it = graph_edges_begin(g, v);
+            while(edge_next(&it, &e))
+                sums[1] += edge_weight(e);
+        }
+    }
+    times[1] = now() - start;
+
+    double scanned = (double) rounds * graph_num_edges(g);
+    printf("[scan] |V| = %d  |E| = %d  (%d rounds)\n", n, m, rounds);
+    printf("    edges_from_vertix:  %10.2f M edges/s\n", scanned / times[0] / 1e6);
+    printf("    edge iterator:      %10.2f M edges/s  (speedup: %.1fx)\n", 
+            scanned / times[1] / 1e6, times[0] / times[1]);
+    printf("    same sums: %s\n\n", sums[0] == sums[1] ? "yes" : "NO");
+    graph_free(&g);
+}
+
+
+/**
+ *      [churn] Removes a tenth of the vertices (in random order) from the same
+ * graph, without and with the in-edge index.
+ */
+static void bench_churn(int n, int m)
+{
+    int count = n / 10, *order = malloc(sizeof(int) * n);
+    for(int v = 0; v < n; v++)
+        order[v] = v;
+    for(int i = n - 1; i > 0; i--) {
+        int j = rng_next() % (i + 1), t = order[i];
+        order[i] = order[j];  order[j] = t;
+    }
+
+    printf("[churn] |V| = %d  |E| = %d  (%d removals)\n", n, m, count);
+    double times[2];
+    int edges[2];
+    unsigned int seed = rng_state;
+    for(int indexed = 0; indexed < 2; indexed++) {
+        rng_state = seed;   // same graph
+        Graph *g = random_graph(n, m, 100);
+        if(indexed)
+            graph_enable_in_edges(g);
+
+        double start = now();
+        for(int i = 0; i < count; i++)
+            graph_remove_vertex(g, order[i]);
+        times[indexed] = now() - start;
+        edges[indexed] = graph_num_edges(g);
+        graph_free(&g);
+    }
+
+    printf("    graph_remove_vertex:              %10.4f ms/removal\n", 1000 * times[0] / count);
+    printf("    graph_remove_vertex (in-edges):   %10.4f ms/removal  (speedup: %.1fx)\n", 
+            1000 * times[1] / count, times[0] / times[1]);
+    printf("    same edges left: %s\n\n", edges[0] == edges[1] ? "yes" : "NO");
+    free(order);
+}
+
+
+/**
+ * Adds the keys to an empty graph and then looks them (and as many missing keys) 
+ * up, printing the rates and the memory footprint.
+ */
+static void sparse_keys(const char *name, const long long *keys, const long long *missing, int n)
+{
+    Graph *g = graph_create();
+    double start = now();
+    for(int i = 0; i < n; i++)
+        graph_vertex_slot(g, keys[i], true);
+    double t_insert = now() - start;
+
+    int found = 0;
+    start = now();
+    for(int i = 0; i < n; i++) {
+        found += graph_vertex_slot(g, keys[i], false) >= 0;
+        found += graph_vertex_slot(g, missing[i], false) >= 0;
+    }
+    double t_lookup = now() - start;
+
+    printf("    %-24s %8.2f M inserts/s  %8.2f M lookups/s  %10.2f MB  (found: %d)\n", name, 
+            n / t_insert / 1e6, 2 * n / t_lookup / 1e6, graph_memory_size(g) / 1e6, found);
+    graph_free(&g);
+}
+
+
+/**
+ *      [sparse] Adds |V| vertices with sparse identifiers: directly as indices 
+ * (the array of adjacency lists must reach the highest identifier) vs. as keys
+ * mapped to dense slots. Then looks up all of them and as many missing ones.
+ */
+static void bench_sparse(int n)
+{
+    long long *ids = malloc(sizeof(long long) * n), 
+              *missing = malloc(sizeof(long long) * n);
+    printf("[sparse] |V| = %d\n", n);
+
+    // identifiers up to BENCH_SPARSE_MAX_ID (the missing ones are above it)
+    for(int i = 0; i < n; i++) {
+        ids[i] = rng_next() % BENCH_SPARSE_MAX_ID;
+        missing[i] = BENCH_SPARSE_MAX_ID + rng_next() % BENCH_SPARSE_MAX_ID;
+    }
+
+    Graph *g = graph_create();
+    double start = now();
+    for(int i = 0; i < n; i++)
+        graph_add_vertex(g, ids[i]);
+    double t_insert = now() - start;
+
+    int found = 0;
+    start = now();
+    for(int i = 0; i < n; i++)
+        found += graph_has_vertex(g, ids[i]) + graph_has_vertex(g, missing[i]);
+    double t_lookup = now() - start;
+
+    printf("    %-24s %8.2f M inserts/s  %8.2f M lookups/s  %10.2f MB  (found: %d)\n", 
+            "ids < 10^7 as indices", n / t_insert / 1e6, 2 * n / t_lookup / 1e6, 
+            graph_memory_size(g) / 1e6, found);
+    graph_free(&g);
+
+    sparse_keys("ids < 10^7 as keys", ids, missing, n);
+
+    // random 64-bit keys (the missing ones are odd, the others even)
+    for(int i = 0; i < n; i++) {
+        ids[i] = (long long) (((unsigned long long) rng_next() << 32 | rng_next()) & ~1ULL);
+        missing[i] = ids[i] + 1;
+    }
+    sparse_keys("64-bit keys", ids, missing, n);
+
+    printf("\n");
+    free(ids);  free(missing);
+}
+
+
+/**
+ *      [load] Adds BENCH_LOAD_EDGES edges to an empty graph, the edges of each 
+ * vertex v at once and pointing to vertices in [0, v], so that the array of 
+ * adjacency lists grows one vertex at a time (as when a file sorted by source
+ * is read). Compares three capacity policies: the old fixed growth (10 slots
+ * per realloc), geometric growth (the default) and graph_reserve() followed by
+ * graph_shrink_to_fit().
+ */
+static void bench_load(void)
+{
+    const char *names[3] = {"fixed growth (+10)", "geometric growth", "reserve + shrink"};
+    int n = BENCH_LOAD_VERTICES, degree = BENCH_LOAD_EDGES / BENCH_LOAD_VERTICES;
+    printf("[load] |V| = %d  |E| = %d\n", n, n * degree);
+
+    for(int policy = 0; policy < 3; policy++) {
+        rng_state = 2463534242u;    // same edges
+        long long before = num_allocs;
+        double start = now();
+
+        Graph *g = (policy == 0) ? graph_create_full(ADJL_ARRAY_INITIAL_SIZE, 10) : graph_create();
+        if(policy == 2)
+            graph_reserve(g, n, n * degree);
+        for(int v = 0; v < n; v++) {
+            for(int i = 0; i < degree; i++)
+                graph_add_edge(g, v, rng_next() % (v + 1), 1 + rng_next() % 100, true);
+        }
+        if(policy == 2)
+            graph_shrink_to_fit(g);
+
+        printf("    %-20s %10.3f ms   allocations: %9lld   array size: %8d   %8.2f MB\n", 
+                names[policy], 1000 * (now() - start), num_allocs - before, 
+                graph_array_size(g), graph_memory_size(g) / 1e6);
+        graph_free(&g);
+    }
+    printf("\n");
+}
+
+
+/**
+ * Returns true if both graphs have the same edges, in the same order.
+ */
+static bool same_graph(Graph *a, Graph *b)
+{
+    if(graph_num_vertices(a) != graph_num_vertices(b) || graph_num_edges(a) != graph_num_edges(b))
+        return false;
+
+    int size = graph_array_size(a) > graph_array_size(b) ? graph_array_size(a) : graph_array_size(b);
+    for(int v = 0; v < size; v++) {
+        if(graph_has_vertex(a, v) != graph_has_vertex(b, v))
+            return false;
+
+        Edge *ea, *eb;
+        EdgeIter ia = graph_edges_begin(a, v), ib = graph_edges_begin(b, v);
+        while(edge_next(&ia, &ea)) {
+            if(!edge_next(&ib, &eb) || edge_dest(ea) != edge_dest(eb) || edge_weight(ea) != edge_weight(eb))
+                return false;
+        }
+        if(edge_next(&ib, &eb))
+            return false;
+    }
+    return true;
+}
+
+
+/**
+ *      [bulk] Adds BENCH_LOAD_EDGES random edges (sources and destinations in 
+ * [0, BENCH_LOAD_VERTICES)) to an empty graph: one by one, with 
+ * graph_add_edge(), and at once, with graph_add_edges_bulk_full() (without and
+ * with the radix sort by source).
+ */
+static void bench_bulk(void)
+{
+    int n = BENCH_LOAD_VERTICES, m = BENCH_LOAD_EDGES;
+    int *src = malloc(sizeof(int) * m), *dst = malloc(sizeof(int) * m);
+    double *w = malloc(sizeof(double) * m);
+    for(int i = 0; i < m; i++) {
+        src[i] = rng_next() % n;
+        dst[i] = rng_next() % n;
+        w[i] = 1 + rng_next() % 100;
+    }
+    printf("[bulk] |V| = %d  |E| = %d\n", n, m);
+
+    const char *names[3] = {"graph_add_edge", "bulk", "bulk + radix sort"};
+    Graph *graphs[3];
+    for(int i = 0; i < 3; i++) {
+        long long before = num_allocs;
+        double start = now();
+        graphs[i] = graph_create();
+        if(i == 0) {
+            for(int e = 0; e < m; e++)
+                graph_add_edge(graphs[i], src[e], dst[e], w[e], true);
+        }
+        else
+            graph_add_edges_bulk_full(graphs[i], src, dst, w, m, i == 2);
+
+        printf("    %-20s %10.3f ms   allocations: %9lld\n", names[i], 
+                1000 * (now() - start), num_allocs - before);
+    }
+
+    printf("    same graphs: %s\n\n", 
+            same_graph(graphs[0], graphs[1]) && same_graph(graphs[0], graphs[2]) ? "yes" : "NO");
+    for(int i = 0; i < 3; i++)
+        graph_free(&graphs[i]);
+    free(src);  free(dst);  free(w);
+}
+
+
+/**
+ *      [csr] Time to freeze the graph into a CSR snapshot, then Dijkstra's 
+ * algorithm on the graph vs. on the snapshot, and a BFS on the snapshot. The 
+ * other searches offered for snapshots (Dial, Bellman-Ford and delta-stepping)
+ * are run once on each, from the vertex 0, and their distances compared.
+ */
+static void bench_csr(int n, int m)
+{
+    Graph *g = random_graph(n, m, 1000);
+
+    double start = now();
+    CSRGraph *csr = graph_freeze(g);
+    double t_freeze = now() - start;
+
+    SPT *a = NULL, *b = NULL;
+    double t_graph = time_sssp(&dijkstra_sp, g, &a);
+
+    double t_csr = 0;
+    for(int q = 0; q < BENCH_QUERIES; q++) {
+        int s = (q * (n / BENCH_QUERIES)) % n;
+        start = now();
+        SPT *spt = dijkstra_sp_csr(csr, s);
+        t_csr += now() - start;
+
+        if(q == BENCH_QUERIES - 1)
+            b = spt;
+        else
+            spt_free(&spt);
+    }
+    t_csr = 1000 * t_csr / BENCH_QUERIES;
+
+    start = now();
+    int *hops = csr_bfs(csr, 0);
+    double t_bfs = now() - start;
+
+    printf("[csr] |V| = %d  |E| = %d\n", n, m);
+    printf("    graph_freeze:     %10.3f ms\n", 1000 * t_freeze);
+    printf("    dijkstra_sp:      %10.3f ms/query\n", t_graph);
+    printf("    dijkstra_sp_csr:  %10.3f ms/query  (speedup: %.1fx)\n", t_csr, t_graph / t_csr);
+    printf("    csr_bfs:          %10.3f ms\n", 1000 * t_bfs);
+    printf("    same distances: %s\n", same_distances(a, b) ? "yes" : "NO");
+
+    const char *names[3] = {"dijkstra_sp_int_csr", "bellman_ford_sp_csr", "delta_stepping_sp_csr"};
+    SPT *on_graph[3] = {dijkstra_sp_int(g, 0, 0), bellman_ford_sp(g, 0), delta_stepping_sp(g, 0, 0, 4)},
+        *on_csr[3] = {dijkstra_sp_int_csr(csr, 0, 0), bellman_ford_sp_csr(csr, 0), delta_stepping_sp_csr(csr, 0, 0, 4)};
+    for(int i = 0; i < 3; i++) {
+        printf("    %-22s same distances as on the graph: %s\n", names[i], 
+                same_distances(on_graph[i], on_csr[i]) ? "yes" : "NO");
+        spt_free(&on_graph[i]);  spt_free(&on_csr[i]);
+    }
+    printf("\n");
+
+    free(hops);
+    spt_free(&a);  spt_free(&b);
+    csr_free(&csr);
+    graph_free(&g);
+}
+
+
+/**
+ *      [binary] Time to get the graph back from the disk: parsing a file of 
+ * text commands (like main.c does) vs. opening the binary file with 
+ * graph_mmap_open(). The first search on the mapped snapshot (which reads its
+ * pages from the file) is timed too and checked against the frozen graph, and
+ * so is the optional csr_validate() pass (after the search, so the search 
+ * still starts from cold pages).
+ */
+static void bench_binary(int n, int m)
+{
+    const char *text_path = "benchmark.txt", *bin_path = "benchmark.bin";
+    Graph *g = random_graph(n, m, 1000);
+    CSRGraph *csr = graph_freeze(g);
+    printf("[binary] |V| = %d  |E| = %d\n", n, m);
+
+    FILE *f = fopen(text_path, "w");
+    const int *offsets = csr_offsets(csr), *targets = csr_targets(csr);
+    const double *weights = csr_weights(csr);
+    for(int v = 0; f != NULL && v < csr_size(csr); v++) {
+        for(int e = offsets[v]; e < offsets[v + 1]; e++)
+            fprintf(f, "1 %d %d %g\n", v, targets[e], weights[e]);
+    }
+    if(f == NULL || fclose(f) != 0) {
+        printf("    couldn't write the text file!\n\n");
+        csr_free(&csr);  graph_free(&g);
+        return;
+    }
+
+    double start = now();
+    f = fopen(text_path, "r");
+    Graph *parsed = graph_create();
+    int cmd, v, w;
+    double weight;
+    while(fscanf(f, "%d %d %d %lf", &cmd, &v, &w, &weight) == 4)
+        graph_add_edge(parsed, v, w, weight, true);
+    fclose(f);
+    double t_text = now() - start;
+
+    start = now();
+    bool saved = graph_save_binary(g, bin_path);
+    double t_save = now() - start;
+
+    start = now();
+    CSRGraph *mapped = saved ? graph_mmap_open(bin_path) : NULL;
+    double t_open = now() - start;
+    if(mapped == NULL) {
+        printf("    couldn't save/open the binary file!\n\n");
+        graph_free(&parsed);  csr_free(&csr);  graph_free(&g);
+        return;
+    }
+
+    start = now();
+    SPT *a = dijkstra_sp_csr(mapped, 0);
+    double t_first = now() - start;
+
+    start = now();
+    bool valid = csr_validate(mapped);
+    double t_validate = now() - start;
+    SPT *b = dijkstra_sp_csr(csr, 0);
+
+    printf("    text commands:     %10.3f ms   (%d edges)\n", 1000 * t_text, graph_num_edges(parsed));
+    printf("    graph_save_binary: %10.3f ms\n", 1000 * t_save);
+    printf("    graph_mmap_open:   %10.3f ms\n", 1000 * t_open);
+    printf("    first search:      %10.3f ms\n", 1000 * t_first);
+    printf("    csr_validate:      %10.3f ms   (%s)\n", 1000 * t_validate, valid ? "valid" : "INVALID");
+    printf("    same distances: %s\n\n", same_distances(a, b) ? "yes" : "NO");
+
+    spt_free(&a);  spt_free(&b);
+    csr_free(&mapped);  csr_free(&csr);
+    graph_free(&parsed);  graph_free(&g);
+    remove(text_path);
+    remove(bin_path);
+}
+
+
+/**
+ *      [text] Time to load a file of text commands ("1 s d w") with scanf(), 
+ * the way main.c does, vs. graph_load_text() with 1 and 4 threads.
+ */
+static void bench_text(int n, int m)
+{
+    const char *path = "benchmark.txt";
+    FILE *f = fopen(path, "w");
+    for(int i = 0; f != NULL && i < m; i++)
+        fprintf(f, "1 %u %u %g\n", rng_next() % n, rng_next() % n, (1 + rng_next() % 100000) / 100.0);
+    if(f == NULL || fclose(f) != 0) {
+        printf("[text] couldn't write the file!\n\n");
+        return;
+    }
+    printf("[text] |V| = %d  |E| = %d\n", n, m);
+
+    double start = now();
+    f = fopen(path, "r");
+    Graph *expected = graph_create();
+    int opt, v, w;
+    double weight;
+    while(fscanf(f, " %d", &opt) == 1 && opt == 1 && fscanf(f, " %d %d %lf", &v, &w, &weight) == 3)
+        graph_add_edge(expected, v, w, weight, true);
+    fclose(f);
+    printf("    %-24s %10.3f ms\n", "scanf", 1000 * (now() - start));
+
+    int nthreads[] = {1, 4};
+    for(int i = 0; i < 2; i++) {
+        start = now();
+        Graph *g = graph_load_text(path, nthreads[i]);
+        double t = now() - start;
+
+        printf("    graph_load_text (%d thr.) %10.3f ms   same graph: %s\n", nthreads[i], 1000 * t, 
+                g != NULL && same_graph(expected, g) ? "yes" : "NO");
+        if(g != NULL)
+            graph_free(&g);
+    }
+    printf("\n");
+
+    graph_free(&expected);
+    remove(path);
+}
+
+
+/**
+ *      [bounded] Queries that only need a few distances: dijkstra_sp() (whole
+ * tree) vs. dijkstra_sp_bounded() with 5 targets (the next vertices of the 
+ * random graph's path) and with a radius of BENCH_BOUNDED_RADIUS. The distances
+ * are checked against the whole tree in the first queries.
+ */
+static void bench_bounded(int n, int m)
+{
+    Graph *g = random_graph(n, m, 1000);
+    printf("[bounded] |V| = %d  |E| = %d\n", n, m);
+
+    const char *names[3] = {"dijkstra_sp", "bounded (5 targets)", "bounded (radius)"};
+    int queries = 200, same = 0, checked = 0;
+    double times[3] = {0};
+    long long settled[3] = {0};
+    for(int q = 0; q < queries; q++) {
+        int s = rng_next() % n, targets[5];
+        for(int i = 0; i < 5; i++)
+            targets[i] = (s + i + 1) % n;
+
+        SPT *spts[3];
+        double start = now();
+        spts[0] = (q < BENCH_QUERIES) ? dijkstra_sp(g, s) : NULL;
+        times[0] += now() - start;
+
+        start = now();
+        spts[1] = dijkstra_sp_bounded(g, s, targets, 5, INFINITY);
+        times[1] += now() - start;
+
+        start = now();
+        spts[2] = dijkstra_sp_bounded(g, s, NULL, 0, BENCH_BOUNDED_RADIUS);
+        times[2] += now() - start;
+
+        for(int i = 0; i < 3; i++)
+            settled[i] += (spts[i] != NULL) ? spt_num_settled(spts[i]) : 0;
+
+        if(spts[0] != NULL) {
+            bool ok = true;
+            for(int i = 0; i < 5; i++)
+                ok = ok && spt_path_dist(spts[1], targets[i]) == spt_path_dist(spts[0], targets[i]);
+            for(int v = 0; v < n; v++) {
+                double d = spt_path_dist(spts[0], v);
+                ok = ok && spt_path_dist(spts[2], v) == ((d <= BENCH_BOUNDED_RADIUS) ? d : INFINITY);
+            }
+            same += ok;
+            checked++;
+        }
+        for(int i = 0; i < 3; i++) {
+            if(spts[i] != NULL)
+                spt_free(&spts[i]);
+        }
+    }
+
+    int runs[3] = {BENCH_QUERIES, queries, queries};
+    for(int i = 0; i < 3; i++)
+        printf("    %-20s %10.4f ms/query   settled: %10lld\n", names[i], 
+                1000 * times[i] / runs[i], settled[i] / runs[i]);
+    printf("    same distances as dijkstra_sp: %d/%d\n\n", same, checked);
+    graph_free(&g);
+}
+
+
+/**
+ *      [workspace] Time and allocations per query with a new SPT for each 
+ * query vs. a workspace reused by all of them, for whole trees and for 
+ * queries within a radius of BENCH_BOUNDED_RADIUS.
+ */
+static void bench_workspace(int n, int m)
+{
+    Graph *g = random_graph(n, m, 1000);
+    SPWorkspace *ws = spw_create(n);
+    printf("[workspace] |V| = %d  |E| = %d\n", n, m);
+
+    const char *names[4] = {"dijkstra_sp", "spw_dijkstra", "dijkstra_sp_bounded", "spw_dijkstra_full"};
+    int runs[4] = {BENCH_QUERIES, BENCH_QUERIES, 10000, 10000}, same = 0;
+    for(int i = 0; i < 4; i++) {
+        unsigned int seed = rng_state;
+        long long before = num_allocs;
+        double start = now();
+        for(int q = 0; q < runs[i]; q++) {
+            int s = rng_next() % n;
+            SPT *spt = NULL;
+            if(i == 0)
+                spt = dijkstra_sp(g, s);
+            else if(i == 1)
+                spw_dijkstra(ws, g, s);
+            else if(i == 2)
+                spt = dijkstra_sp_bounded(g, s, NULL, 0, BENCH_BOUNDED_RADIUS);
+            else
+                spw_dijkstra_full(ws, g, s, NULL, 0, BENCH_BOUNDED_RADIUS);
+            if(spt != NULL)
+                spt_free(&spt);
+        }
+        double t = now() - start;
+        printf("    %-20s %10.4f ms/query   allocations/query: %6.1f\n", names[i], 
+                1000 * t / runs[i], (double) (num_allocs - before) / runs[i]);
+        if(i % 2 == 0)
+            rng_state = seed;   // same sources for the workspace
+    }
+
+    for(int q = 0; q < BENCH_QUERIES; q++) {
+        int s = rng_next() % n;
+        SPT *spt = dijkstra_sp(g, s);
+        spw_dijkstra(ws, g, s);
+        bool ok = true;
+        for(int v = 0; v < n; v++)
+            ok = ok && spt_path_dist(spt, v) == spw_path_dist(ws, v);
+        same += ok;
+        spt_free(&spt);
+    }
+    printf("    same distances as dijkstra_sp: %d/%d\n\n", same, BENCH_QUERIES);
+
+    spw_free(&ws);
+    graph_free(&g);
+}
+
+
+/**
+ *      [table] Distance table between BENCH_TABLE_SIZE sources and as many 
+ * targets, taken at random from the central region (a quarter of the width) 
+ * of a grid, like the vehicles and the stops of a city on a road network: a 
+ * whole tree per source (dijkstra_sp() + spt_path_dist()) vs. 
+ * sp_distance_table() with 1 and 4 threads.
+ */
+static void bench_table(int n)
+{
+    int width = (int) sqrt(n), region = (width / 4 > 0) ? width / 4 : 1;
+    Graph *g = grid_graph(width);
+    int k = BENCH_TABLE_SIZE, sources[BENCH_TABLE_SIZE], targets[BENCH_TABLE_SIZE];
+    for(int i = 0; i < k; i++) {
+        int corner = (width - region) / 2;
+        sources[i] = (corner + rng_next() % region) * width + corner + rng_next() % region;
+        targets[i] = (corner + rng_next() % region) * width + corner + rng_next() % region;
+    }
+    printf("[table] %dx%d grid  %dx%d table\n", width, width, k, k);
+
+    double *expected = malloc(sizeof(double) * k * k);
+    double start = now();
+    for(int i = 0; i < k; i++) {
+        SPT *spt = dijkstra_sp(g, sources[i]);
+        for(int j = 0; j < k; j++)
+            expected[i * k + j] = spt_path_dist(spt, targets[j]);
+        spt_free(&spt);
+    }
+    printf("    %-28s %10.3f ms\n", "dijkstra_sp per source", 1000 * (now() - start));
+
+    int nthreads[] = {1, 4};
+    for(int i = 0; i < 2; i++) {
+        start = now();
+        double *table = sp_distance_table(g, sources, k, targets, k, nthreads[i]);
+        double t = now() - start;
+
+        bool same = table != NULL;
+        for(int c = 0; same && c < k * k; c++)
+            same = table[c] == expected[c];
+        printf("    sp_distance_table (%d thr.) %10.3f ms   same distances: %s\n", 
+                nthreads[i], 1000 * t, same ? "yes" : "NO");
+        free(table);
+    }
+    printf("\n");
+
+    free(expected);
+    graph_free(&g);
+}
+
+
+/**
+ *      [dynamic] BENCH_DYNAMIC_UPDATES changes to the weights of random edges
+ * (graph_set_edge_weight()), each followed by the repair of a shortest paths 
+ * tree with spt_apply_edge_update(), without and with the in-edge index, vs. 
+ * building the tree again with dijkstra_sp() (timed on BENCH_QUERIES changes).
+ * The repaired tree is then checked against a new one.
+ */
+static void bench_dynamic(int n, int m)
+{
+    printf("[dynamic] |V| = %d  |E| = %d  %d weight changes\n", n, m, BENCH_DYNAMIC_UPDATES);
+    for(int indexed = 0; indexed < 2; indexed++) {
+        Graph *g = random_graph(n, m, 1000);
+        if(indexed)
+            graph_enable_in_edges(g);
+        int s = rng_next() % n;
+        SPT *spt = dijkstra_sp(g, s);
+
+        double rebuild = 0, repair = 0;
+        long long settled = 0, failed = 0;
+        for(int q = 0; q < BENCH_DYNAMIC_UPDATES; q++) {
+            int v = rng_next() % n, w = -1, k = 0;
+            Edge *e;
+            EdgeIter it = graph_edges_begin(g, v);
+            while(edge_next(&it, &e)) {
+                if(rng_next() % ++k == 0)
+                    w = edge_dest(e);   // a random edge leaving v
+            }
+            if(w < 0)
+                continue;
+
+            double weight = 1 + rng_next() % 1000;
+            graph_set_edge_weight(g, v, w, weight);
+            if(!indexed && q < BENCH_QUERIES) {
+                double start = now();
+                SPT *fresh = dijkstra_sp(g, s);
+                rebuild += now() - start;
+                spt_free(&fresh);
+            }
+
+            double start = now();
+            failed += !spt_apply_edge_update(spt, g, v, w, weight);
+            repair += now() - start;
+            settled += spt_num_settled(spt);
+        }
+
+        if(!indexed)
+            printf("    %-34s %10.4f ms/change\n", "dijkstra_sp", 1000 * rebuild / BENCH_QUERIES);
+        printf("    %-34s %10.4f ms/change   settled/change: %8.1f\n", 
+                indexed ? "spt_apply_edge_update (in-edges)" : "spt_apply_edge_update", 
+                1000 * repair / BENCH_DYNAMIC_UPDATES, (double) settled / BENCH_DYNAMIC_UPDATES);
+
+        SPT *fresh = dijkstra_sp(g, s);
+        printf("    same distances as dijkstra_sp: %s  (failed repairs: %lld)\n", 
+                same_distances(spt, fresh) ? "yes" : "NO", failed);
+        spt_free(&fresh);
+        spt_free(&spt);
+        graph_free(&g);
+    }
+    printf("\n");
+}
+
+
+/**
+ *      [mst] Time of mst_prim(), mst_kruskal() and mst_boruvka() (1 and 4 
+ * threads) on a sparse random graph with n vertices and m edges and on a dense
+ * one with n/10 vertices and m edges. The weights of the forests (and their 
+ * numbers of edges) must be the same.
+ */
+static void bench_mst(int n, int m)
+{
+    const char *names[4] = {"mst_prim", "mst_kruskal", "mst_boruvka (1 thread)", "mst_boruvka (4 threads)"};
+    for(int dense = 0; dense < 2; dense++) {
+        int size = dense ? (n / 10 > 1 ? n / 10 : 2) : n;
+        Graph *g = random_graph(size, m, 1000);
+        printf("[mst] %s  |V| = %d  |E| = %d\n", dense ? "dense" : "sparse", size, m);
+
+        double weights[4];
+        int edges[4];
+        for(int i = 0; i < 4; i++) {
+            double start = now();
+            MSF *msf = (i == 0) ? mst_prim(g) : 
+                       (i == 1) ? mst_kruskal(g) : mst_boruvka(g, (i == 2) ? 1 : 4);
+            double t = now() - start;
+            weights[i] = msf_weight(msf);
+            edges[i] = msf_num_edges(msf);
+            printf("    %-24s %10.3f ms   weight: %.0f  edges: %d\n", names[i], 1000 * t, weights[i], edges[i]);
+            msf_free(&msf);
+        }
+
+        bool same = true;
+        for(int i = 1; i < 4; i++)
+            same = same && weights[i] == weights[0] && edges[i] == edges[0];
+        printf("    same forests: %s\n\n", same ? "yes" : "NO");
+        graph_free(&g);
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *section = (argc > 1) ? argv[1] : "all";
+    int n = (argc > 2) ? atoi(argv[2]) : BENCH_DEFAULT_VERTICES,
+        m = (argc > 3) ? atoi(argv[3]) : BENCH_DEFAULT_EDGES;
+
+    bool all = strcmp(section, "all") == 0;
+    if(all || strcmp(section, "dijkstra") == 0)
+        bench_dijkstra(n, m);
+    if(all || strcmp(section, "dial") == 0)
+        bench_dial(n, m);
+    if(all || strcmp(section, "bellman") == 0)
+        bench_bellman_ford(n, m);
+    if(all || strcmp(section, "delta") == 0)
+        bench_delta_stepping(n, m);
+    if(all || strcmp(section, "p2p") == 0)
+        bench_p2p(n, m);
+    if(all || strcmp(section, "astar") == 0)
+        bench_astar(n);
+    if(all || strcmp(section, "ch") == 0)
+        bench_ch(n);
+    if(all || strcmp(section, "alt") == 0)
+        bench_alt(n);
+    if(all || strcmp(section, "johnson") == 0)
+        bench_johnson(n);
+    if(all || strcmp(section, "floyd") == 0)
+        bench_floyd_warshall(n);
+    if(all || strcmp(section, "alloc") == 0)
+        bench_allocs(n, m);
+    if(all || strcmp(section, "scan") == 0)
+        bench_scan(n, m);
+    if(all || strcmp(section, "csr") == 0)
+        bench_csr(n, m);
+    if(all || strcmp(section, "churn") == 0)
+        bench_churn(n, m);
+    if(all || strcmp(section, "sparse") == 0)
+        bench_sparse(n);
+    if(all || strcmp(section, "load") == 0)
+        bench_load();
+    if(all || strcmp(section, "bulk") == 0)
+        bench_bulk();
+    if(all || strcmp(section, "binary") == 0)
+        bench_binary(n, m);
+    if(all || strcmp(section, "text") == 0)
+        bench_text(n, m);
+    if(all || strcmp(section, "bounded") == 0)
+        bench_bounded(n, m);
+    if(all || strcmp(section, "workspace") == 0)
+        bench_workspace(n, m);
+    if(all || strcmp(section, "table") == 0)
+        bench_table(n);
+    if(all || strcmp(section, "dynamic") == 0)
+        bench_dynamic(n, m);
+    if(all || strcmp(section, "mst") == 0)
+        bench_mst(n, m);
+
+    return 0;
+}
@@ -0,0 +1,813 @@
+/**
+ * Contraction hierarchies: a preprocessing index for fast point-to-point
+ * shortest path queries on a weighted digraph that rarely changes.
+ *
+ * During preprocessing, the vertices are contracted one by one, in order of
+ * importance (the least important first). Contracting a vertex v means removing
+ * it from the graph and adding, for each pair of edges u->v and v->w whose
+ * path u->v->w is the only shortest path from u to w, a shortcut edge u->w.
+ * The shortcuts are kept in a separate overlay; the graph itself isn't changed.
+ * A query is a bidirectional Dijkstra's search in which both searches only
+ * follow edges leading to more important vertices, so very few vertices are
+ * settled. The shortcuts in the path found are then unpacked back into the
+ * graph's edges.
+ *
+ * Reference: Geisberger, Sanders, Schultes & Delling (2008), "Contraction
+ * Hierarchies: Faster and Simpler Hierarchical Routing in Road Networks".
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+
+#include "contraction_hierarchies.h"
+#include "indexed_heap.h"
+#include <stdlib.h>
+#include <math.h>
+
+
+/**
+ *      Structure of an arc of the hierarchy: either one of the graph's edges or
+ * a shortcut that replaces the path from->middle->to, formed by two other arcs.
+ *
+ * Attributes:
+ *      . from, to: the arc's tail and head.
+ *      . weight: the arc's weight (for shortcuts, the sum of its arcs' weights).
+ *      . first, second: for shortcuts, the indices of the arcs from->middle and
+ *      middle->to; for the graph's edges, first is -1 and second is the index
+ *      of the edge in ch->edges.
+ */
+typedef struct {
+    int from, to, first, second;
+    double weight;
+} CHArc;
+
+
+/**
+ * Growable array of arc indices.
+ */
+typedef struct {
+    int *items;
+    int size, capacity;
+} ArcList;
+
+
+/**
+ *      Structure of a contraction hierarchy.
+ *
+ * Attributes:
+ *      . size: size of the graph's array of adjacency lists.
+ *      . arcs, num_arcs: the edges of the graph followed by the shortcuts.
+ *      . edges, num_edges: copies of the graph's edges (the arcs that aren't
+ *      shortcuts point to them).
+ *      . rank: rank[v] is the position of v in the contraction order (the
+ *      greater the rank, the more important the vertex).
+ *      . up_offset, up_arcs: arcs u->w with rank[u] < rank[w], grouped by u; the
+ *      ones leaving u are at [up_offset[u], up_offset[u+1]) (used by the forward
+ *      search).
+ *      . down_offset, down_arcs: arcs u->w with rank[u] > rank[w], grouped by w
+ *      (used by the backward search).
+ *      . dist_f, dist_b, arc_f, arc_b: query workspace; distances found by the
+ *      forward and backward searches and the arcs that led to each vertex.
+ *      . touched, num_touched: vertices whose workspace entries were changed by
+ *      the current query (so that resetting it doesn't cost O(|V|)).
+ *      . pq_f, pq_b: the priority queues of the forward and backward searches.
+ *      . last_settled: number of vertices settled by the last query.
+ */
+struct ContractionHierarchy {
+    int size;
+
+    CHArc *arcs;
+    int num_arcs, num_edges;
+    Edge **edges;
+
+    int *rank;
+    int *up_offset, *up_arcs,
+        *down_offset, *down_arcs;
+
+    double *dist_f, *dist_b;
+    int *arc_f, *arc_b;
+    int *touched, num_touched;
+    IndexedHeap *pq_f, *pq_b;
+    int last_settled;
+};
+
+
+/**
+ *      State used only while the hierarchy is being built.
+ *
+ * Attributes:
+ *      . arcs_capacity: capacity of ch->arcs.
+ *      . out, in: out[v] and in[v] hold the arcs leaving and arriving at v.
+ *      . contracted: whether each vertex was already contracted.
+ *      . deleted_neighbours: number of contracted neighbours of each vertex;
+ *      it's part of the priority, so that the contracted vertices are spread
+ *      evenly over the graph.
+ *      . level: 1 + the greatest level among the contracted neighbours of each 
+ *      vertex (also part of the priority).
+ *      . wdist, wtouched, num_wtouched, wpq: workspace of the witness searches.
+ */
+typedef struct {
+    CH *ch;
+    int arcs_capacity;
+    ArcList *out, *in;
+    bool *contracted;
+    int *deleted_neighbours, *level;
+
+    double *wdist;
+    int *wtouched, num_wtouched;
+    IndexedHeap *wpq;
+} Contractor;
+
+
+/**
+ * Appends an arc index to the list, doubling its capacity if needed.
+ */
+static bool arc_list_push(ArcList *list, int a)
+{
+    if(list->size == list->capacity) {
+        int capacity = (list->capacity > 0) ? 2*list->capacity : 4;
+        int *items = realloc(list->items, sizeof(int) * capacity);
+        if(items == NULL)
+            return false;
+
+        list->items = items;
+        list->capacity = capacity;
+    }
+
+    list->items[list->size++] = a;
+    return true;
+}
+
+
+/**
+ *      Adds a new arc to the hierarchy (and to the adjacency lists of the
+ * contractor). Returns its index or -1 if the memory couldn't be allocated.
+ */
+static int add_arc(Contractor *c, int from, int to, double weight, int first, int second)
+{
+    CH *ch = c->ch;
+    if(ch->num_arcs == c->arcs_capacity) {
+        int capacity = (c->arcs_capacity > 0) ? 2*c->arcs_capacity : 16;
+        CHArc *arcs = realloc(ch->arcs, sizeof(CHArc) * capacity);
+        if(arcs == NULL)
+            return -1;
+
+        ch->arcs = arcs;
+        c->arcs_capacity = capacity;
+    }
+
+    int a = ch->num_arcs++;
+    ch->arcs[a].from = from;
+    ch->arcs[a].to = to;
+    ch->arcs[a].weight = weight;
+    ch->arcs[a].first = first;
+    ch->arcs[a].second = second;
+
+    if(!arc_list_push(&c->out[from], a) || !arc_list_push(&c->in[to], a))
+        return -1;
+    return a;
+}
+
+
+/**
+ *      Adds the arc from->to to the hierarchy unless there already is an arc 
+ * connecting the same vertices, in which case that arc is replaced if the new 
+ * one is lighter (so there are never parallel arcs between vertices that 
+ * weren't contracted). Replacing the arc in place is safe: only arcs leading 
+ * to or leaving contracted vertices are part of shortcuts. Returns the index of
+ * the arc or -1 if the memory couldn't be allocated.
+ */
+static int add_or_improve_arc(Contractor *c, int from, int to, double weight, int first, int second)
+{
+    ArcList *out = &c->out[from];
+    for(int i = 0; i < out->size; i++) {
+        CHArc *a = &c->ch->arcs[out->items[i]];
+        if(a->to == to) {
+            if(weight < a->weight) {
+                a->weight = weight;
+                a->first = first;
+                a->second = second;
+            }
+            return out->items[i];
+        }
+    }
+
+    return add_arc(c, from, to, weight, first, second);
+}
+
+
+/**
+ * Removes the arc index a from the list (the order isn't kept).
+ */
+static void arc_list_remove(ArcList *list, int a)
+{
+    for(int i = 0; i < list->size; i++) {
+        if(list->items[i] == a) {
+            list->items[i] = list->items[--list->size];
+            return;
+        }
+    }
+}
+
+
+/**
+ *      Dijkstra's search from u over the vertices that weren't contracted yet,
+ * ignoring the vertex v (the one being contracted). Stops once the next vertex
+ * is farther than max_dist or limit vertices were settled.
+ * The distances found are left in c->wdist (INFINITY for the vertices that
+ * weren't reached); witness_reset() must be called afterwards.
+ */
+static void witness_search(Contractor *c, int u, int v, double max_dist, int limit)
+{
+    CHArc *arcs = c->ch->arcs;
+    int settled = 0;
+
+    c->wdist[u] = 0;
+    c->wtouched[c->num_wtouched++] = u;
+    iheap_insert(c->wpq, u, 0);
+
+    while(!iheap_empty(c->wpq) && iheap_min_priority(c->wpq) <= max_dist
+            && settled++ < limit) {
+        int x = iheap_pop_min(c->wpq);
+
+        for(int i = 0; i < c->out[x].size; i++) {
+            CHArc *a = &arcs[c->out[x].items[i]];
+            if(a->to == v || c->contracted[a->to])
+                continue;
+
+            double d = c->wdist[x] + a->weight;
+            if(d < c->wdist[a->to]) {
+                if(isinf(c->wdist[a->to]))
+                    c->wtouched[c->num_wtouched++] = a->to;
+
+                c->wdist[a->to] = d;
+                if(iheap_contains(c->wpq, a->to))
+                    iheap_decrease_key(c->wpq, a->to, d);
+                else
+                    iheap_insert(c->wpq, a->to, d);
+            }
+        }
+    }
+}
+
+
+/**
+ * Resets the workspace of the witness searches. Runs in O(touched vertices).
+ */
+static void witness_reset(Contractor *c)
+{
+    for(int i = 0; i < c->num_wtouched; i++)
+        c->wdist[c->wtouched[i]] = INFINITY;
+    c->num_wtouched = 0;
+    iheap_clear(c->wpq);
+}
+
+
+/**
+ *      Contracts the vertex v: for each pair of arcs u->v and v->w (with u and w
+ * not contracted yet) such that no path from u to w avoiding v is as short as
+ * u->v->w, adds the shortcut u->w.
+ *
+ * @param c the contractor.
+ * @param v the vertex.
+ * @param simulate if true, no shortcuts are added; they're just counted (used
+ * to compute the vertex's priority).
+ * @return the number of shortcuts (that would be) added or -1 if the memory
+ * couldn't be allocated.
+ */
+static int contract(Contractor *c, int v, bool simulate)
+{
+    int count = 0;
+    ArcList *in = &c->in[v], *out = &c->out[v];
+
+    for(int i = 0; i < in->size; i++) {
+        CHArc a1 = c->ch->arcs[in->items[i]];
+        int u = a1.from;
+        if(c->contracted[u] || u == v)
+            continue;
+
+        // longest path u->v->w, bounding the witness search
+        double max_dist = -1;
+        for(int j = 0; j < out->size; j++) {
+            CHArc *a2 = &c->ch->arcs[out->items[j]];
+            if(!c->contracted[a2->to] && a2->to != u && a2->to != v && a1.weight + a2->weight > max_dist)
+                max_dist = a1.weight + a2->weight;
+        }
+        if(max_dist < 0)
+            continue;
+
+        witness_search(c, u, v, max_dist, simulate ? CH_SIMULATION_SETTLE_LIMIT : CH_WITNESS_SETTLE_LIMIT);
+        for(int j = 0; j < out->size; j++) {
+            int a2_index = out->items[j];
+            CHArc a2 = c->ch->arcs[a2_index];
+            int w = a2.to;
+            if(c->contracted[w] || w == u || w == v)
+                continue;
+
+            if(c->wdist[w] > a1.weight + a2.weight) {
+                count++;   // no witness: the shortcut is needed
+                if(!simulate && add_or_improve_arc(c, u, w, a1.weight + a2.weight, in->items[i], a2_index) == -1) {
+                    witness_reset(c);
+                    return -1;
+                }
+            }
+        }
+        witness_reset(c);
+    }
+
+    return count;
+}
+
+
+/**
+ *      Computes the priority of v (lower priorities are contracted first): 
+ * twice its edge difference (the number of shortcuts that contracting it would 
+ * add minus the number of arcs that would be removed) plus its number of 
+ * contracted neighbours plus its level (an upper bound on the number of 
+ * hierarchy levels below it), which keeps the hierarchy shallow.
+ */
+static double priority(Contractor *c, int v)
+{
+    int removed = 0;
+    for(int i = 0; i < c->in[v].size; i++)
+        removed += !c->contracted[c->ch->arcs[c->in[v].items[i]].from];
+    for(int i = 0; i < c->out[v].size; i++)
+        removed += !c->contracted[c->ch->arcs[c->out[v].items[i]].to];
+
+    return 2*(contract(c, v, true) - removed) + c->deleted_neighbours[v] + c->level[v];
+}
+
+
+/**
+ *      Groups the arcs of the hierarchy into the upward (forward search) and
+ * downward (backward search) arrays. Returns false if the memory couldn't be
+ * allocated.
+ */
+static bool build_search_graphs(CH *ch)
+{
+    ch->up_offset = calloc(ch->size + 1, sizeof(int));
+    ch->down_offset = calloc(ch->size + 1, sizeof(int));
+    ch->up_arcs = malloc(sizeof(int) * (ch->num_arcs > 0 ? ch->num_arcs : 1));
+    ch->down_arcs = malloc(sizeof(int) * (ch->num_arcs > 0 ? ch->num_arcs : 1));
+    int *fill = malloc(sizeof(int) * (ch->size + 1));
+
+    if(ch->up_offset == NULL || ch->down_offset == NULL || ch->up_arcs == NULL
+            || ch->down_arcs == NULL || fill == NULL) {
+        free(fill);
+        return false;
+    }
+
+    for(int a = 0; a < ch->num_arcs; a++) {
+        CHArc *arc = &ch->arcs[a];
+        if(ch->rank[arc->from] < ch->rank[arc->to])
+            ch->up_offset[arc->from + 1]++;
+        else
+            ch->down_offset[arc->to + 1]++;
+    }
+    for(int v = 0; v < ch->size; v++) {
+        ch->up_offset[v + 1] += ch->up_offset[v];
+        ch->down_offset[v + 1] += ch->down_offset[v];
+    }
+
+    for(int v = 0; v <= ch->size; v++)
+        fill[v] = ch->up_offset[v];
+    for(int a = 0; a < ch->num_arcs; a++) {
+        if(ch->rank[ch->arcs[a].from] < ch->rank[ch->arcs[a].to])
+            ch->up_arcs[fill[ch->arcs[a].from]++] = a;
+    }
+
+    for(int v = 0; v <= ch->size; v++)
+        fill[v] = ch->down_offset[v];
+    for(int a = 0; a < ch->num_arcs; a++) {
+        if(ch->rank[ch->arcs[a].from] > ch->rank[ch->arcs[a].to])
+            ch->down_arcs[fill[ch->arcs[a].to]++] = a;
+    }
+
+    free(fill);
+    return true;
+}
+
+
+/**
+ * Frees the memory allocated by the contractor (but not the hierarchy).
+ */
+static void contractor_free(Contractor *c)
+{
+    for(int v = 0; v < c->ch->size; v++) {
+        if(c->out != NULL)
+            free(c->out[v].items);
+        if(c->in != NULL)
+            free(c->in[v].items);
+    }
+
+    free(c->out);  free(c->in);
+    free(c->contracted);  free(c->deleted_neighbours);  free(c->level);
+    free(c->wdist);  free(c->wtouched);
+    if(c->wpq != NULL)
+        iheap_free(&c->wpq);
+}
+
+
+/**
+ *      Contracts all the vertices of the graph, from the least to the most
+ * important, assigning their ranks. After a vertex is contracted, the 
+ * priorities of its neighbours are recomputed. The other priorities are updated
+ * lazily: when a vertex is popped from the queue, its priority is recomputed 
+ * and, if it's no longer the lowest one, the vertex goes back to the queue. Returns false if
+ * the memory couldn't be allocated.
+ */
+static bool contract_all(Contractor *c)
+{
+    CH *ch = c->ch;
+    IndexedHeap *order = iheap_create(ch->size);
+    if(order == NULL)
+        return false;
+
+    for(int v = 0; v < ch->size; v++)
+        iheap_insert(order, v, priority(c, v));
+
+    int next_rank = 0;
+    while(!iheap_empty(order)) {
+        int v = iheap_pop_min(order);
+        if(!iheap_empty(order)) {
+            double p = priority(c, v);
+            if(p > iheap_min_priority(order)) {
+                iheap_insert(order, v, p);  // not the least important anymore
+                continue;
+            }
+        }
+
+        if(contract(c, v, false) < 0) {
+            iheap_free(&order);
+            return false;
+        }
+
+        c->contracted[v] = true;
+        ch->rank[v] = next_rank++;
+
+        // detaches v from its neighbours, so they only keep arcs to vertices
+        // that weren't contracted
+        for(int i = 0; i < c->in[v].size; i++) {
+            int a = c->in[v].items[i];
+            c->deleted_neighbours[ch->arcs[a].from]++;
+            if(c->level[ch->arcs[a].from] < c->level[v] + 1)
+                c->level[ch->arcs[a].from] = c->level[v] + 1;
+            arc_list_remove(&c->out[ch->arcs[a].from], a);
+        }
+        for(int i = 0; i < c->out[v].size; i++) {
+            int a = c->out[v].items[i];
+            c->deleted_neighbours[ch->arcs[a].to]++;
+            if(c->level[ch->arcs[a].to] < c->level[v] + 1)
+                c->level[ch->arcs[a].to] = c->level[v] + 1;
+            arc_list_remove(&c->in[ch->arcs[a].to], a);
+        }
+
+        // the priorities of the neighbours changed
+        for(int i = 0; i < c->in[v].size; i++) {
+            int u = ch->arcs[c->in[v].items[i]].from;
+            iheap_change_key(order, u, priority(c, u));
+        }
+        for(int i = 0; i < c->out[v].size; i++) {
+            int w = ch->arcs[c->out[v].items[i]].to;
+            iheap_change_key(order, w, priority(c, w));
+        }
+    }
+
+    iheap_free(&order);
+    return true;
+}
+
+
+/**
+ *      Builds the contraction hierarchy of the given graph and returns a pointer
+ * to it. The graph isn't changed; the hierarchy keeps copies of its edges, so
+ * it remains valid even if the graph is freed, but it won't reflect later
+ * changes to the graph. Edges with negative weights are not supported.
+ *
+ * @param g a pointer to the graph (expects a weighted digraph).
+ * @return a pointer to the hierarchy or NULL if the memory couldn't be
+ * allocated.
+ */
+CH* ch_create(Graph *g)
+{
+    CH *ch = calloc(1, sizeof(CH));
+    if(ch == NULL)
+        return NULL;
+
+    ch->size = graph_array_size(g);
+    int m = graph_num_edges(g);
+
+    Contractor c = {0};
+    c.ch = ch;
+    c.out = calloc(ch->size, sizeof(ArcList));
+    c.in = calloc(ch->size, sizeof(ArcList));
+    c.contracted = calloc(ch->size, sizeof(bool));
+    c.deleted_neighbours = calloc(ch->size, sizeof(int));
+    c.level = calloc(ch->size, sizeof(int));
+    c.wdist = malloc(sizeof(double) * ch->size);
+    c.wtouched = malloc(sizeof(int) * ch->size);
+    c.wpq = iheap_create(ch->size);
+
+    ch->edges = malloc(sizeof(Edge*) * (m > 0 ? m : 1));
+    ch->rank = malloc(sizeof(int) * ch->size);
+    ch->dist_f = malloc(sizeof(double) * ch->size);
+    ch->dist_b = malloc(sizeof(double) * ch->size);
+    ch->arc_f = malloc(sizeof(int) * ch->size);
+    ch->arc_b = malloc(sizeof(int) * ch->size);
+    ch->touched = malloc(sizeof(int) * ch->size);
+    ch->pq_f = iheap_create(ch->size);
+    ch->pq_b = iheap_create(ch->size);
+
+    bool ok = c.out != NULL && c.in != NULL && c.contracted != NULL
+              && c.deleted_neighbours != NULL && c.level != NULL && c.wdist != NULL
+              && c.wtouched != NULL && c.wpq != NULL && ch->edges != NULL
+              && ch->rank != NULL && ch->dist_f != NULL && ch->dist_b != NULL
+              && ch->arc_f != NULL && ch->arc_b != NULL && ch->touched != NULL
+              && ch->pq_f != NULL && ch->pq_b != NULL;
+
+    // the graph's edges are the initial arcs (self-loops are never needed)
+    for(int u = 0; ok && u < ch->size; u++) {
+        c.wdist[u] = ch->dist_f[u] = ch->dist_b[u] = INFINITY;
+        ch->arc_f[u] = ch->arc_b[u] = -1;
+
+        Edge *e;
+        EdgeIter it = graph_edges_begin(g, u);
+        while(edge_next(&it, &e)) {
+            if(edge_dest(e) == u)
+                continue;
+
+            ch->edges[ch->num_edges] = copy_edge(e);
+            if(ch->edges[ch->num_edges] == NULL 
+                    || add_or_improve_arc(&c, u, edge_dest(e), edge_weight(e), -1, ch->num_edges++) == -1)
+                ok = false;
+        }
+    }
+
+    ok = ok && contract_all(&c) && build_search_graphs(ch);
+    contractor_free(&c);
+
+    if(!ok)
+        ch_free(&ch);
+    return ch;
+}
+
+
+/**
+ * Frees the memory allocated by the hierarchy.
+ *
+ * @param ch a pointer to the variable that is holding a pointer to the
+ * hierarchy; by the end of the call, the variable will be set to NULL.
+ */
+void ch_free(CH **ch)
+{
+    CH *h = *ch;
+    if(h->edges != NULL) {
+        for(int i = 0; i < h->num_edges; i++)
+            free(h->edges[i]);
+        free(h->edges);
+    }
+
+    free(h->arcs);  free(h->rank);
+    free(h->up_offset);  free(h->up_arcs);
+    free(h->down_offset);  free(h->down_arcs);
+    free(h->dist_f);  free(h->dist_b);
+    free(h->arc_f);  free(h->arc_b);
+    free(h->touched);
+    if(h->pq_f != NULL)
+        iheap_free(&h->pq_f);
+    if(h->pq_b != NULL)
+        iheap_free(&h->pq_b);
+
+    free(h);
+    *ch = NULL;
+}
+
+
+/**
+ *      Updates the distance of x in one of the searches of a query (dist and
+ * arc are the search's arrays and pq, its priority queue).
+ */
+static void query_relax(CH *ch, IndexedHeap *pq, double *dist, int *arc, int x, double d, int a)
+{
+    if(isinf(ch->dist_f[x]) && isinf(ch->dist_b[x]))
+        ch->touched[ch->num_touched++] = x;
+
+    dist[x] = d;
+    arc[x] = a;
+    if(iheap_contains(pq, x))
+        iheap_decrease_key(pq, x, d);
+    else
+        iheap_insert(pq, x, d);
+}
+
+
+/**
+ *      Runs a query: a forward search from s over the upward arcs and a backward
+ * search from t over the downward arcs (reversed). Each search goes on until
+ * the lowest key in its queue isn't lower than the best distance found so far.
+ * The workspace must be reset with query_reset() afterwards.
+ *
+ * @return the distance from s to t (INFINITY if there is no path); the vertex
+ * where the searches met is stored in meet (-1 if they didn't).
+ */
+static double query(CH *ch, int s, int t, int *meet)
+{
+    double mu = INFINITY;
+    *meet = -1;
+    ch->last_settled = 0;
+
+    query_relax(ch, ch->pq_f, ch->dist_f, ch->arc_f, s, 0, -1);
+    query_relax(ch, ch->pq_b, ch->dist_b, ch->arc_b, t, 0, -1);
+
+    while(1) {
+        bool forward = !iheap_empty(ch->pq_f) && iheap_min_priority(ch->pq_f) < mu,
+             backward = !iheap_empty(ch->pq_b) && iheap_min_priority(ch->pq_b) < mu;
+        if(!forward && !backward)
+            break;
+
+        if(forward && backward)
+            forward = iheap_min_priority(ch->pq_f) <= iheap_min_priority(ch->pq_b);
+
+        int v = iheap_pop_min(forward ? ch->pq_f : ch->pq_b);
+        ch->last_settled++;
+
+        if(ch->dist_f[v] + ch->dist_b[v] < mu) {
+            mu = ch->dist_f[v] + ch->dist_b[v];
+            *meet = v;
+        }
+
+        if(forward) {
+            for(int i = ch->up_offset[v]; i < ch->up_offset[v + 1]; i++) {
+                CHArc *a = &ch->arcs[ch->up_arcs[i]];
+                double d = ch->dist_f[v] + a->weight;
+                if(d < ch->dist_f[a->to])
+                    query_relax(ch, ch->pq_f, ch->dist_f, ch->arc_f, a->to, d, ch->up_arcs[i]);
+            }
+        }
+        else {
+            for(int i = ch->down_offset[v]; i < ch->down_offset[v + 1]; i++) {
+                CHArc *a = &ch->arcs[ch->down_arcs[i]];
+                double d = ch->dist_b[v] + a->weight;
+                if(d < ch->dist_b[a->from])
+                    query_relax(ch, ch->pq_b, ch->dist_b, ch->arc_b, a->from, d, ch->down_arcs[i]);
+            }
+        }
+    }
+
+    return mu;
+}
+
+
+/**
+ * Resets the query workspace. Runs in O(touched vertices).
+ */
+static void query_reset(CH *ch)
+{
+    for(int i = 0; i < ch->num_touched; i++) {
+        int v = ch->touched[i];
+        ch->dist_f[v] = ch->dist_b[v] = INFINITY;
+        ch->arc_f[v] = ch->arc_b[v] = -1;
+    }
+
+    ch->num_touched = 0;
+    iheap_clear(ch->pq_f);
+    iheap_clear(ch->pq_b);
+}
+
+
+/**
+ *      Appends to the path the graph's edges represented by the arc a (shortcuts
+ * are recursively replaced by their two arcs). An explicit stack is used instead
+ * of recursion. Returns false if the memory couldn't be allocated.
+ */
+static bool unpack_arc(CH *ch, int a, List *path)
+{
+    ArcList stack = {0};
+    bool ok = arc_list_push(&stack, a);
+
+    while(ok && stack.size > 0) {
+        CHArc *arc = &ch->arcs[stack.items[--stack.size]];
+        if(arc->first == -1)
+            ok = list_append(path, copy_edge(ch->edges[arc->second]));
+        else
+            ok = arc_list_push(&stack, arc->second) && arc_list_push(&stack, arc->first);
+    }
+
+    free(stack.items);
+    return ok;
+}
+
+
+/**
+ *      Builds the path found by the last query, from s to t through the meeting
+ * vertex, unpacking the shortcuts into the graph's edges. Returns NULL if the 
+ * memory couldn't be allocated.
+ */
+static List* build_path(CH *ch, int s, int meet)
+{
+    List *path = list_create();
+    if(path == NULL)
+        return NULL;
+
+    // the forward half is collected backwards (from meet to s)
+    ArcList half = {0};
+    bool ok = true;
+    for(int v = meet; ok && v != s; v = ch->arcs[ch->arc_f[v]].from)
+        ok = arc_list_push(&half, ch->arc_f[v]);
+
+    for(int i = half.size - 1; ok && i >= 0; i--)
+        ok = unpack_arc(ch, half.items[i], path);
+    free(half.items);
+
+    for(int v = meet; ok && ch->arc_b[v] != -1; v = ch->arcs[ch->arc_b[v]].to)
+        ok = unpack_arc(ch, ch->arc_b[v], path);
+
+    if(!ok)
+        list_free(&path, &free);
+    return path;
+}
+
+
+/**
+ * Checks whether v is a valid vertex index for the hierarchy. Auxiliary function.
+ */
+static bool valid_vertex(CH *ch, int v) {
+    return v >= 0 && v < ch->size;
+}
+
+
+/**
+ *      Returns the weight of a shortest path from s to t (the same distance
+ * found by dijkstra_sp()).
+ *
+ * @param ch a pointer to the hierarchy.
+ * @param s the identifier (index) of the source vertex.
+ * @param t the identifier (index) of the destination vertex.
+ * @return the weight of the path or INFINITY if there is no path.
+ */
+double ch_dist(CH *ch, int s, int t)
+{
+    if(!valid_vertex(ch, s) || !valid_vertex(ch, t))
+        return INFINITY;
+
+    int meet;
+    double dist = query(ch, s, t, &meet);
+    query_reset(ch);
+    return dist;
+}
+
+
+/**
+ *      Returns a shortest path from s to t, with the shortcuts unpacked into the
+ * graph's edges.
+ *
+ * @param ch a pointer to the hierarchy.
+ * @param s the identifier (index) of the source vertex.
+ * @param t the identifier (index) of the destination vertex.
+ * @param dist if it isn't NULL, the variable pointed by it will receive the
+ * weight of the path (INFINITY if there is no path).
+ * @return a list with copies of the edges in the path from s to t (an empty
+ * list if s equals t) or NULL if there is no such path or if the memory 
+ * couldn't be allocated.
+ */
+List* ch_path(CH *ch, int s, int t, double *dist)
+{
+    if(dist != NULL)
+        *dist = INFINITY;
+    if(!valid_vertex(ch, s) || !valid_vertex(ch, t))
+        return NULL;
+
+    int meet;
+    double d = query(ch, s, t, &meet);
+    List *path = (meet != -1) ? build_path(ch, s, meet) : NULL;
+    query_reset(ch);
+
+    if(dist != NULL)
+        *dist = d;
+    return path;
+}
+
+
+/**
+ * Returns the number of shortcuts added to the hierarchy during preprocessing.
+ */
+int ch_num_shortcuts(CH *ch) {
+    return ch->num_arcs - ch->num_edges;
+}
+
+
+/**
+ * Returns the rank of the vertex v (its position in the contraction order).
+ */
+int ch_rank(CH *ch, int v) {
+    return ch->rank[v];
+}
+
+
+/**
+ * Returns the number of vertices settled by the last query.
+ */
+int ch_last_settled(CH *ch) {
+    return ch->last_settled;
+}
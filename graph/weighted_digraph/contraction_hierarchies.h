@@ -0,0 +1,50 @@
+/**
+ * Contraction hierarchies: a preprocessing index for fast point-to-point
+ * shortest path queries on a weighted digraph that rarely changes.
+ *
+ * During preprocessing, the vertices are contracted one by one, in order of
+ * importance (the least important first). Contracting a vertex v means removing
+ * it from the graph and adding, for each pair of edges u->v and v->w whose
+ * path u->v->w is the only shortest path from u to w, a shortcut edge u->w.
+ * The shortcuts are kept in a separate overlay; the graph itself isn't changed.
+ * A query is a bidirectional Dijkstra's search in which both searches only
+ * follow edges leading to more important vertices, so very few vertices are
+ * settled. The shortcuts in the path found are then unpacked back into the
+ * graph's edges.
+ *
+ * Example of use:
+ *      CH *ch = ch_create(g);                  // preprocessing (slow)
+ *      List *path = ch_path(ch, s, t, &dist);  // shortest path from s to t (fast)
+ *
+ * The index is a snapshot: it must be rebuilt if the graph changes. Queries on
+ * the same index must not run concurrently (they share a workspace).
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+#ifndef CONTRACTION_HIERARCHIES_H
+    #define CONTRACTION_HIERARCHIES_H
+    #include "weighted_digraph.h"
+    #include "singly_linked_list.h"
+    #include <stdbool.h>
+
+    /* Constants */
+    #define CH_WITNESS_SETTLE_LIMIT 500      // max. number of vertices settled by each witness search
+    #define CH_SIMULATION_SETTLE_LIMIT 50    // same, but when only estimating a vertex's priority
+
+    /* Structs */
+    typedef struct ContractionHierarchy CH;
+
+    /* Create/Free */
+    CH* ch_create(Graph *g);
+    void ch_free(CH **ch);
+
+    /* Queries */
+    double ch_dist(CH *ch, int s, int t);
+    List* ch_path(CH *ch, int s, int t, double *dist);
+
+    int ch_num_shortcuts(CH *ch);
+    int ch_rank(CH *ch, int v);
+    int ch_last_settled(CH *ch);
+#endif
@@ -0,0 +1,420 @@
+/**
+ * Immutable snapshot of a weighted digraph in the compressed sparse row (CSR)
+ * format, for read-heavy workloads.
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+
+#define _POSIX_C_SOURCE 200112L
+#include "csr_graph.h"
+#include "binary_file.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/* Binary file */
+#define GRAPH_FILE_MAGIC "DIGRAPH\0"   // 8 bytes
+#define GRAPH_FILE_VERSION 1
+#define GRAPH_FILE_WEIGHTED 1          // flag set when the file has the weights section
+
+
+/**
+ *      Structure of a CSR snapshot.
+ *
+ * Attributes:
+ *      . size: size of the frozen graph's array of adjacency lists (the
+ *      vertices' identifiers are in the range [0, size)).
+ *      . num_vertices, num_edges: number of vertices and edges of the graph.
+ *      . exists: exists[v] tells whether the vertex v is in the graph.
+ *      . offsets: size + 1 positions; the edges leaving v are at the positions
+ *      [offsets[v], offsets[v+1]) of the arrays below.
+ *      . targets, weights: the head and the weight of each edge.
+ *      . map, map_size: if the snapshot was opened with graph_mmap_open(), the 
+ *      mapping of the file (the arrays above point into it); NULL otherwise.
+ */
+struct CompressedSparseRowGraph {
+    int size, num_vertices, num_edges;
+    bool *exists;
+    int *offsets, *targets;
+    double *weights;
+
+    void *map;
+    size_t map_size;
+};
+
+
+/**
+ *      Header of the binary file. It's followed by the sections exists (one 
+ * byte, 0 or 1, per vertex), offsets (size + 1 int32), targets (num_edges 
+ * int32) and, if the flag GRAPH_FILE_WEIGHTED is set, weights (num_edges 
+ * doubles), each one starting at an offset aligned to BINARY_FILE_ALIGNMENT 
+ * bytes. Everything is stored little-endian.
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version, flags, size, num_vertices;
+    uint64_t num_edges;
+} GraphFileHeader;
+
+
+/**
+ *      Builds a CSR snapshot of the graph, in O(|V| + |E|). The edges of each
+ * vertex keep the order of its adjacency list.
+ *
+ * @param g a pointer to the graph.
+ * @return a pointer to the snapshot or NULL if the memory couldn't be
+ * allocated.
+ */
+CSRGraph* graph_freeze(Graph *g)
+{
+    CSRGraph *csr = malloc(sizeof(CSRGraph));
+    if(csr == NULL)
+        return NULL;
+
+    int size = graph_array_size(g), m = graph_num_edges(g);
+    csr->map = NULL;
+    csr->size = size;
+    csr->num_vertices = graph_num_vertices(g);
+    csr->num_edges = m;
+    csr->exists = malloc(sizeof(bool) * (size > 0 ? size : 1));
+    csr->offsets = malloc(sizeof(int) * (size + 1));
+    csr->targets = malloc(sizeof(int) * (m > 0 ? m : 1));
+    csr->weights = malloc(sizeof(double) * (m > 0 ? m : 1));
+
+    if(csr->exists == NULL || csr->offsets == NULL || csr->targets == NULL || csr->weights == NULL) {
+        csr_free(&csr);
+        return NULL;
+    }
+
+    int pos = 0;
+    for(int v = 0; v < size; v++) {
+        csr->exists[v] = graph_has_vertex(g, v);
+        csr->offsets[v] = pos;
+
+        Edge *e;
+        EdgeIter it = graph_edges_begin(g, v);
+        while(edge_next(&it, &e)) {
+            csr->targets[pos] = edge_dest(e);
+            csr->weights[pos++] = edge_weight(e);
+        }
+    }
+    csr->offsets[size] = pos;
+
+    return csr;
+}
+
+
+/**
+ * Frees the memory allocated by the snapshot (the graph isn't affected).
+ *
+ * @param csr a pointer to the variable that is holding a pointer to the
+ * snapshot; by the end of the call, the variable will be set to NULL.
+ */
+void csr_free(CSRGraph **csr)
+{
+    if((*csr)->map != NULL) {
+        munmap((*csr)->map, (*csr)->map_size);
+        free(*csr);
+        *csr = NULL;
+        return;
+    }
+
+    free((*csr)->exists);
+    free((*csr)->offsets);
+    free((*csr)->targets);
+    free((*csr)->weights);
+
+    free(*csr);
+    *csr = NULL;
+}
+
+
+/**
+ *      Saves the snapshot to a binary file that can be opened with 
+ * graph_mmap_open() (see GraphFileHeader for the layout).
+ *
+ * @param csr a pointer to the snapshot.
+ * @param path the path of the file (overwritten if it exists).
+ * @return true if the file was written; false otherwise (including when the
+ * machine isn't little-endian).
+ */
+bool csr_save_binary(CSRGraph *csr, const char *path)
+{
+    if(!little_endian())
+        return false;
+
+    FILE *f = fopen(path, "wb");
+    if(f == NULL)
+        return false;
+
+    GraphFileHeader header = {{0}, GRAPH_FILE_VERSION, GRAPH_FILE_WEIGHTED, 
+                              csr->size, csr->num_vertices, csr->num_edges};
+    memcpy(header.magic, GRAPH_FILE_MAGIC, sizeof(header.magic));
+
+    size_t size = csr->size, m = csr->num_edges;
+    uint8_t *exists = malloc(size > 0 ? size : 1);
+    bool ok = exists != NULL;
+    for(size_t v = 0; ok && v < size; v++)
+        exists[v] = csr->exists[v];
+
+    // int is 32 bits on the supported platforms, so the arrays are written as they are
+    ok = ok && fwrite(&header, sizeof(header), 1, f) == 1
+            && write_padding(f, sizeof(header))
+            && fwrite(exists, 1, size, f) == size
+            && write_padding(f, size)
+            && fwrite(csr->offsets, sizeof(int32_t), size + 1, f) == size + 1
+            && write_padding(f, sizeof(int32_t) * (size + 1))
+            && fwrite(csr->targets, sizeof(int32_t), m, f) == m
+            && write_padding(f, sizeof(int32_t) * m)
+            && fwrite(csr->weights, sizeof(double), m, f) == m;
+
+    free(exists);
+    return fclose(f) == 0 && ok;
+}
+
+
+/**
+ *      Saves the graph to a binary file that can be opened with 
+ * graph_mmap_open(). The graph is frozen (see graph_freeze()) for the 
+ * duration of the call.
+ *
+ * @param g a pointer to the graph.
+ * @param path the path of the file (overwritten if it exists).
+ * @return true if the file was written; false otherwise.
+ */
+bool graph_save_binary(Graph *g, const char *path)
+{
+    CSRGraph *csr = graph_freeze(g);
+    if(csr == NULL)
+        return false;
+
+    bool ok = csr_save_binary(csr, path);
+    csr_free(&csr);
+    return ok;
+}
+
+
+/**
+ *      Opens a graph saved with graph_save_binary() (or csr_save_binary()) as 
+ * a read-only CSR snapshot. The file is mapped into memory and the snapshot's 
+ * arrays point straight into the mapping, so no parsing or copying is done: 
+ * opening takes the same time for any size of graph, and the pages are read 
+ * from the disk as the searches touch them. 
+ * 
+ *      Only the header is checked (against the size of the file), in O(1). A
+ * file that may be corrupt or come from an untrusted source should also go
+ * through csr_validate(), which reads every section in O(|V| + |E|), before 
+ * the snapshot is searched: a bad offset or target would make the searches 
+ * read out of bounds.
+ *
+ * @param path the path of the file.
+ * @return a pointer to the snapshot (to be freed with csr_free(), which unmaps
+ * the file) or NULL if the file couldn't be mapped or isn't a valid weighted 
+ * graph file.
+ */
+CSRGraph* graph_mmap_open(const char *path)
+{
+    if(!little_endian() || sizeof(bool) != 1)
+        return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+        return NULL;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(GraphFileHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // the mapping stays valid
+    if(map == MAP_FAILED)
+        return NULL;
+
+    GraphFileHeader *header = map;
+    size_t size = header->size, m = header->num_edges,
+           offsets_at = align_up(sizeof(GraphFileHeader)) + align_up(size),
+           targets_at = offsets_at + align_up(sizeof(int32_t) * (size + 1)),
+           weights_at = targets_at + align_up(sizeof(int32_t) * m);
+
+    CSRGraph *csr = NULL;
+    if(memcmp(header->magic, GRAPH_FILE_MAGIC, sizeof(header->magic)) == 0
+            && header->version == GRAPH_FILE_VERSION
+            && (header->flags & GRAPH_FILE_WEIGHTED)
+            && size < INT32_MAX && m <= INT32_MAX
+            && header->num_vertices <= size
+            && weights_at + sizeof(double) * m <= (size_t) st.st_size)
+        csr = malloc(sizeof(CSRGraph));
+
+    if(csr == NULL) {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    csr->size = size;
+    csr->num_vertices = header->num_vertices;
+    csr->num_edges = m;
+    csr->exists = (bool*) ((char*) map + align_up(sizeof(GraphFileHeader)));
+    csr->offsets = (int*) ((char*) map + offsets_at);
+    csr->targets = (int*) ((char*) map + targets_at);
+    csr->weights = (double*) ((char*) map + weights_at);
+    csr->map = map;
+    csr->map_size = st.st_size;
+    return csr;
+}
+
+
+/**
+ *      Checks, in O(|V| + |E|), that the snapshot is consistent: every exists 
+ * byte is 0 or 1 and their sum is the number of vertices, the offsets start at 
+ * 0, never decrease and end at the number of edges, and every target is in 
+ * [0, size). The weights aren't checked. Snapshots built by graph_freeze() 
+ * always pass; the check is meant for the ones opened with graph_mmap_open(), 
+ * which only checks the header.
+ *
+ * @param csr a pointer to the snapshot.
+ * @return true if the snapshot is consistent; false otherwise (it must not be
+ * searched then, only freed).
+ */
+bool csr_validate(CSRGraph *csr)
+{
+    const uint8_t *exists = (const uint8_t*) csr->exists;
+    const int *offsets = csr->offsets;
+    int size = csr->size, m = csr->num_edges, count = 0;
+
+    if(offsets[0] != 0 || offsets[size] != m)
+        return false;
+
+    for(int v = 0; v < size; v++) {
+        if(exists[v] > 1 || offsets[v] > offsets[v + 1])
+            return false;
+        count += exists[v];
+    }
+
+    for(int e = 0; e < m; e++) {
+        if(csr->targets[e] < 0 || csr->targets[e] >= size)
+            return false;
+    }
+
+    return count == csr->num_vertices;
+}
+
+
+/**
+ *      Breadth-first search from the vertex s: finds the minimum number of
+ * edges (hops) needed to reach each vertex, ignoring the weights. Only the
+ * offsets and targets arrays are read.
+ *
+ * @param csr a pointer to the snapshot.
+ * @param s the identifier (index) of the source vertex.
+ * @return an array (to be freed by the caller) with csr_size(csr) positions:
+ * the number of hops from s to each vertex or -1 if the vertex is unreachable;
+ * NULL if s isn't in the graph or the memory couldn't be allocated.
+ */
+int* csr_bfs(CSRGraph *csr, int s)
+{
+    if(!csr_has_vertex(csr, s))
+        return NULL;
+
+    int *hops = malloc(sizeof(int) * csr->size),
+        *queue = malloc(sizeof(int) * csr->size);
+    if(hops == NULL || queue == NULL) {
+        free(hops);  free(queue);
+        return NULL;
+    }
+
+    for(int v = 0; v < csr->size; v++)
+        hops[v] = -1;
+
+    int head = 0, tail = 0;
+    hops[s] = 0;
+    queue[tail++] = s;
+    while(head < tail) {
+        int v = queue[head++];
+        for(int e = csr->offsets[v]; e < csr->offsets[v + 1]; e++) {
+            int w = csr->targets[e];
+            if(hops[w] == -1) {
+                hops[w] = hops[v] + 1;
+                queue[tail++] = w;
+            }
+        }
+    }
+
+    free(queue);
+    return hops;
+}
+
+
+/**
+ * Returns the size of the frozen graph's array of adjacency lists.
+ */
+int csr_size(CSRGraph *csr) {
+    return csr->size;
+}
+
+
+/**
+ * Returns the number of vertices in the snapshot.
+ */
+int csr_num_vertices(CSRGraph *csr) {
+    return csr->num_vertices;
+}
+
+
+/**
+ * Returns the number of edges in the snapshot.
+ */
+int csr_num_edges(CSRGraph *csr) {
+    return csr->num_edges;
+}
+
+
+/**
+ * Checks whether the vertex v is in the snapshot.
+ */
+bool csr_has_vertex(CSRGraph *csr, int v) {
+    return v >= 0 && v < csr->size && csr->exists[v];
+}
+
+
+/**
+ * Returns the number of edges leaving the vertex v (0 if it doesn't exist).
+ */
+int csr_out_degree(CSRGraph *csr, int v) {
+    if(v < 0 || v >= csr->size)
+        return 0;
+    return csr->offsets[v + 1] - csr->offsets[v];
+}
+
+
+/**
+ * Returns the offsets array (csr_size(csr) + 1 positions). Must not be freed.
+ */
+const int* csr_offsets(CSRGraph *csr) {
+    return csr->offsets;
+}
+
+
+/**
+ * Returns the heads of the edges (csr_num_edges(csr) positions). Must not be freed.
+ */
+const int* csr_targets(CSRGraph *csr) {
+    return csr->targets;
+}
+
+
+/**
+ * Returns the weights of the edges (csr_num_edges(csr) positions). Must not be freed.
+ */
+const double* csr_weights(CSRGraph *csr) {
+    return csr->weights;
+}
@@ -0,0 +1,63 @@
+/**
+ * Immutable snapshot of a weighted digraph in the compressed sparse row (CSR)
+ * format, for read-heavy workloads: the graph is built (and changed) as a
+ * WeightedDigraph and then frozen once; the queries run on the snapshot.
+ *
+ * The edges leaving the vertex v are at the positions [offsets[v], offsets[v+1])
+ * of the arrays targets (heads) and weights. The arrays are kept apart
+ * (structure of arrays), so a scan that only needs the heads doesn't load the
+ * weights, and consecutive edges are contiguous in memory.
+ *
+ * Example of use:
+ *      CSRGraph *csr = graph_freeze(g);
+ *      SPT *spt = dijkstra_sp_csr(csr, s);     // see shortest_paths.h
+ *      int *hops = csr_bfs(csr, s);
+ *
+ * Changes made to the graph after the call to graph_freeze() are not seen by
+ * the snapshot.
+ *
+ * A snapshot can also be saved to a binary file (versioned, little-endian, 
+ * with the arrays above in sections aligned to 64 bytes) and opened later with
+ * graph_mmap_open(), which maps the file instead of reading it (only the 
+ * header is checked; csr_validate() checks the rest of a file that may be 
+ * corrupt):
+ *      graph_save_binary(g, "graph.bin");
+ *      CSRGraph *csr = graph_mmap_open("graph.bin");  // no parsing
+ *      bool ok = csr_validate(csr);                   // O(|V| + |E|)
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+#ifndef CSR_GRAPH_H
+    #define CSR_GRAPH_H
+    #include "weighted_digraph.h"
+    #include <stdbool.h>
+
+    /* Structs */
+    typedef struct CompressedSparseRowGraph CSRGraph;
+
+    /* Create/Free */
+    CSRGraph* graph_freeze(Graph *g);
+    void csr_free(CSRGraph **csr);
+
+    /* Binary file */
+    bool graph_save_binary(Graph *g, const char *path);
+    bool csr_save_binary(CSRGraph *csr, const char *path);
+    CSRGraph* graph_mmap_open(const char *path);
+    bool csr_validate(CSRGraph *csr);
+
+    /* Traversals */
+    int* csr_bfs(CSRGraph *csr, int s);
+
+    /* Queries */
+    int csr_size(CSRGraph *csr);
+    int csr_num_vertices(CSRGraph *csr);
+    int csr_num_edges(CSRGraph *csr);
+    bool csr_has_vertex(CSRGraph *csr, int v);
+    int csr_out_degree(CSRGraph *csr, int v);
+
+    const int* csr_offsets(CSRGraph *csr);
+    const int* csr_targets(CSRGraph *csr);
+    const double* csr_weights(CSRGraph *csr);
+#endif
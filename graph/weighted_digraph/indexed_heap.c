@@ -0,0 +1,341 @@
+/**
+ * Implementation of an indexed d-ary min-heap (priority queue).
+ *
+ * Each item in the heap is identified by an integer key in the range
+ * [0, capacity) (in the graph algorithms, the key is a vertex's index) and is
+ * associated with a priority (a double). Since the heap keeps track of the
+ * position of each key, the priority of an item can be decreased in O(log_d n),
+ * which is what Dijkstra's algorithm needs to relax edges.
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+
+#include "indexed_heap.h"
+#include <stdlib.h>
+#include <math.h>
+
+
+/**
+ *      Structure of an indexed d-ary min-heap. The heap itself is an array of
+ * keys; the children of the node at position i are at the positions
+ * [d*i + 1, d*i + d].
+ *
+ * Attributes:
+ *      . arity: number of children of each node (d); wider heaps are shallower,
+ *      so they make insertions and decrease-key cheaper at the expense of a
+ *      slightly more expensive pop.
+ *      . size: number of keys currently in the heap.
+ *      . capacity: keys must be in the range [0, capacity).
+ *      . heap: array with the keys, in heap order.
+ *      . pos: pos[k] holds the position of the key k in the heap array or -1 if
+ *      k is not in the heap.
+ *      . prio: prio[k] holds the priority of the key k (only meaningful while k
+ *      is in the heap).
+ */
+struct IndexedMinHeap {
+    int arity, size, capacity;
+    int *heap, *pos;
+    double *prio;
+};
+
+
+/**
+ *      Creates a new empty indexed min-heap and returns a pointer to it. With
+ * this function, the caller can specify the heap's arity.
+ *
+ * @param capacity the keys stored in the heap must be in the range
+ * [0, capacity).
+ * @param arity number of children of each node (must be at least 2).
+ * @return a pointer to the newly created heap if all the required memory could
+ * be allocated; NULL otherwise.
+ */
+IndexedHeap* iheap_create_full(int capacity, int arity)
+{
+    if(arity < 2)
+        arity = 2;
+
+    IndexedHeap *h = malloc(sizeof(IndexedHeap));
+    if(h != NULL) {
+        h->heap = malloc(sizeof(int) * (capacity > 0 ? capacity : 1));
+        h->pos = malloc(sizeof(int) * (capacity > 0 ? capacity : 1));
+        h->prio = malloc(sizeof(double) * (capacity > 0 ? capacity : 1));
+
+        if(h->heap == NULL || h->pos == NULL || h->prio == NULL) {
+            free(h->heap);  free(h->pos);  free(h->prio);
+            free(h);
+            return NULL;
+        }
+
+        for(int k = 0; k < capacity; k++)
+            h->pos[k] = -1;
+
+        h->arity = arity;
+        h->capacity = capacity;
+        h->size = 0;
+    }
+
+    return h;
+}
+
+
+/**
+ *      Creates a new empty indexed min-heap with the default arity
+ * (IHEAP_DEFAULT_ARITY). Wrapper for iheap_create_full().
+ *
+ * @param capacity the keys stored in the heap must be in the range
+ * [0, capacity).
+ * @return a pointer to the newly created heap or NULL if the memory couldn't
+ * be allocated.
+ */
+IndexedHeap* iheap_create(int capacity) {
+    return iheap_create_full(capacity, IHEAP_DEFAULT_ARITY);
+}
+
+
+/**
+ * Frees the memory allocated by the heap.
+ *
+ * @param h a pointer to the variable that is holding a pointer to the heap; by
+ * the end of the call, the variable will be set to NULL.
+ */
+void iheap_free(IndexedHeap **h)
+{
+    free((*h)->heap);
+    free((*h)->pos);
+    free((*h)->prio);
+
+    free(*h);
+    *h = NULL;
+}
+
+
+/**
+ * Places the key k at the position i of the heap array. Auxiliary function.
+ */
+static inline void place(IndexedHeap *h, int i, int k) {
+    h->heap[i] = k;
+    h->pos[k] = i;
+}
+
+
+/**
+ *      Moves the key at the position i up the heap until its parent has a
+ * priority lower than or equal to its own. Auxiliary function.
+ */
+static void sift_up(IndexedHeap *h, int i)
+{
+    int k = h->heap[i];
+    double p = h->prio[k];
+
+    while(i > 0) {
+        int parent = (i - 1) / h->arity;
+        if(h->prio[h->heap[parent]] <= p)
+            break;
+
+        place(h, i, h->heap[parent]);
+        i = parent;
+    }
+
+    place(h, i, k);
+}
+
+
+/**
+ *      Moves the key at the position i down the heap until all of its children
+ * have priorities greater than or equal to its own. Auxiliary function.
+ */
+static void sift_down(IndexedHeap *h, int i)
+{
+    int k = h->heap[i];
+    double p = h->prio[k];
+
+    while(1) {
+        int first = h->arity * i + 1;
+        if(first >= h->size)
+            break;
+
+        int last = first + h->arity;
+        if(last > h->size)
+            last = h->size;
+
+        // finds the child with the lowest priority
+        int best = first;
+        double best_p = h->prio[h->heap[first]];
+        for(int c = first + 1; c < last; c++) {
+            double cp = h->prio[h->heap[c]];
+            if(cp < best_p) {
+                best = c;
+                best_p = cp;
+            }
+        }
+
+        if(p <= best_p)
+            break;
+
+        place(h, i, h->heap[best]);
+        i = best;
+    }
+
+    place(h, i, k);
+}
+
+
+/**
+ * Inserts the key k, with the given priority, into the heap.
+ *
+ * @param h a pointer to the heap.
+ * @param key the key being inserted (in the range [0, capacity)).
+ * @param priority the key's priority (lower values are popped first).
+ * @return true if the key was inserted; false if it's out of range or already
+ * in the heap.
+ */
+bool iheap_insert(IndexedHeap *h, int key, double priority)
+{
+    if(key < 0 || key >= h->capacity || h->pos[key] != -1)
+        return false;
+
+    h->prio[key] = priority;
+    place(h, h->size++, key);
+    sift_up(h, h->size - 1);
+    return true;
+}
+
+
+/**
+ * Decreases the priority of a key that is already in the heap.
+ *
+ * @param h a pointer to the heap.
+ * @param key the key whose priority will be decreased.
+ * @param priority the key's new priority.
+ * @return true if the priority was updated; false if the key isn't in the heap
+ * or if the given priority is greater than the key's current priority.
+ */
+bool iheap_decrease_key(IndexedHeap *h, int key, double priority)
+{
+    if(!iheap_contains(h, key) || priority > h->prio[key])
+        return false;
+
+    h->prio[key] = priority;
+    sift_up(h, h->pos[key]);
+    return true;
+}
+
+
+/**
+ *      Changes the priority of a key that is already in the heap (the new 
+ * priority can be either lower or greater than the current one).
+ *
+ * @param h a pointer to the heap.
+ * @param key the key whose priority will be changed.
+ * @param priority the key's new priority.
+ * @return true if the priority was updated; false if the key isn't in the heap.
+ */
+bool iheap_change_key(IndexedHeap *h, int key, double priority)
+{
+    if(!iheap_contains(h, key))
+        return false;
+
+    double old = h->prio[key];
+    h->prio[key] = priority;
+    if(priority < old)
+        sift_up(h, h->pos[key]);
+    else
+        sift_down(h, h->pos[key]);
+    return true;
+}
+
+
+/**
+ * Removes and returns the key with the lowest priority in the heap.
+ *
+ * @param h a pointer to the heap.
+ * @return the key with the lowest priority or -1 if the heap is empty.
+ */
+int iheap_pop_min(IndexedHeap *h)
+{
+    if(h->size == 0)
+        return -1;
+
+    int min = h->heap[0];
+    h->pos[min] = -1;
+
+    if(--h->size > 0) {
+        place(h, 0, h->heap[h->size]);
+        sift_down(h, 0);
+    }
+
+    return min;
+}
+
+
+/**
+ *      Removes all the keys from the heap. Runs in O(size), so a heap can be
+ * cheaply reused by several searches over the same graph.
+ */
+void iheap_clear(IndexedHeap *h)
+{
+    for(int i = 0; i < h->size; i++)
+        h->pos[h->heap[i]] = -1;
+    h->size = 0;
+}
+
+
+/**
+ * Returns the number of keys in the heap.
+ */
+int iheap_size(IndexedHeap *h) {
+    return h->size;
+}
+
+
+/**
+ * Returns the heap's capacity (the keys must be in the range [0, capacity)).
+ */
+int iheap_capacity(IndexedHeap *h) {
+    return h->capacity;
+}
+
+
+/**
+ * Returns true if the heap is empty or false otherwise.
+ */
+bool iheap_empty(IndexedHeap *h) {
+    return !h->size;
+}
+
+
+/**
+ * Checks whether the given key is in the heap.
+ */
+bool iheap_contains(IndexedHeap *h, int key) {
+    if(key < 0 || key >= h->capacity)
+        return false;
+    return h->pos[key] != -1;
+}
+
+
+/**
+ * Returns, without removing it, the key with the lowest priority in the heap
+ * (-1 if the heap is empty).
+ */
+int iheap_min(IndexedHeap *h) {
+    return (h->size > 0) ? h->heap[0] : -1;
+}
+
+
+/**
+ * Returns the lowest priority in the heap (INFINITY if the heap is empty).
+ */
+double iheap_min_priority(IndexedHeap *h) {
+    return (h->size > 0) ? h->prio[h->heap[0]] : INFINITY;
+}
+
+
+/**
+ * Returns the priority of the given key (INFINITY if it's not in the heap).
+ */
+double iheap_priority(IndexedHeap *h, int key) {
+    return iheap_contains(h, key) ? h->prio[key] : INFINITY;
+}
@@ -0,0 +1,54 @@
+/**
+ * Implementation of an indexed d-ary min-heap (priority queue).
+ *
+ * Each item in the heap is identified by an integer key in the range
+ * [0, capacity) (in the graph algorithms, the key is a vertex's index) and is
+ * associated with a priority (a double). Since the heap keeps track of the
+ * position of each key, the priority of an item can be decreased in O(log_d n),
+ * which is what Dijkstra's algorithm needs to relax edges.
+ *
+ * Example of use:
+ *      IndexedHeap *h = iheap_create(graph_array_size(g));
+ *      iheap_insert(h, s, 0);
+ *      while(!iheap_empty(h)) {
+ *          int v = iheap_pop_min(h);
+ *          ...
+ *      }
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+#ifndef INDEXED_HEAP_H
+    #define INDEXED_HEAP_H
+    #include <stdbool.h>
+
+    /* Constants */
+    #define IHEAP_DEFAULT_ARITY 4     // default number of children of each of the heap's nodes
+
+    /* Structs */
+    typedef struct IndexedMinHeap IndexedHeap;
+
+    /* Create/Free */
+    IndexedHeap* iheap_create_full(int capacity, int arity);
+    IndexedHeap* iheap_create(int capacity);
+    void iheap_free(IndexedHeap **h);
+
+    /* Insertions/Updates */
+    bool iheap_insert(IndexedHeap *h, int key, double priority);
+    bool iheap_decrease_key(IndexedHeap *h, int key, double priority);
+    bool iheap_change_key(IndexedHeap *h, int key, double priority);
+
+    /* Removals */
+    int iheap_pop_min(IndexedHeap *h);
+    void iheap_clear(IndexedHeap *h);
+
+    /* Queries */
+    int iheap_size(IndexedHeap *h);
+    int iheap_capacity(IndexedHeap *h);
+    bool iheap_empty(IndexedHeap *h);
+    bool iheap_contains(IndexedHeap *h, int key);
+    int iheap_min(IndexedHeap *h);
+    double iheap_min_priority(IndexedHeap *h);
+    double iheap_priority(IndexedHeap *h, int key);
+#endif
@@ -0,0 +1,526 @@
+/**
+ * ALT (A*, Landmarks and Triangle inequality) index for goal-directed
+ * shortest path queries on a weighted digraph.
+ *
+ * A few vertices are chosen as landmarks and the distances from each landmark
+ * to every vertex, and from every vertex to each landmark, are computed with
+ * dijkstra_sp(). By the triangle inequality, the greatest difference between
+ * those distances is a lower bound of the distance between any two vertices,
+ * which is used as the heuristic of an A* search.
+ *
+ * Reference: Goldberg & Harrelson (2005), "Computing the Shortest Path: A*
+ * Search Meets Graph Theory".
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+
+#define _POSIX_C_SOURCE 200112L
+#include "landmarks.h"
+#include "binary_file.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/* Binary file format */
+#define ALT_FILE_MAGIC "ALTIDX\0\0"    // 8 bytes
+#define ALT_FILE_VERSION 1
+
+
+/**
+ *      Structure of an ALT index.
+ *
+ * Attributes:
+ *      . k: number of landmarks.
+ *      . size: size of the graph's array of adjacency lists.
+ *      . landmarks: the landmarks' indices.
+ *      . from: from[i*size + v] is the distance from the i-th landmark to v.
+ *      . to: to[i*size + v] is the distance from v to the i-th landmark.
+ *      . map, map_size: if the index was loaded with alt_load(), the mapping of
+ *      the file (the arrays above point into it); NULL otherwise.
+ */
+struct LandmarksIndex {
+    int k, size;
+    int *landmarks;
+    double *from, *to;
+
+    void *map;
+    size_t map_size;
+};
+
+
+/**
+ *      Header of the binary file. It's followed by the landmarks (int32 each)
+ * and by the from and to tables (doubles), each section starting at an offset
+ * aligned to BINARY_FILE_ALIGNMENT bytes. Everything is stored little-endian.
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version, k, size, reserved;
+} AltFileHeader;
+
+
+/**
+ * Work shared by the threads that compute the distance tables.
+ *
+ * Attributes:
+ *      . alt: the index being built.
+ *      . g, rev: the graph and its reverse (same vertices, reversed edges).
+ *      . next_job, num_jobs, lock: the jobs are numbered [0, num_jobs); the
+ *      job j < k computes the row from[j] and the job j >= k the row to[j-k];
+ *      each thread takes the next job available.
+ *      . skip_from: whether the from rows were already computed.
+ *      . failed: set if some Dijkstra's search couldn't allocate memory.
+ */
+typedef struct {
+    ALT *alt;
+    Graph *g, *rev;
+    int next_job, num_jobs;
+    pthread_mutex_t lock;
+    bool skip_from, failed;
+} AltBuild;
+
+
+/**
+ *      Copies the distances of a Dijkstra's search from the vertex s of the
+ * graph g to the given row of a table. Returns false if the memory couldn't be
+ * allocated. Auxiliary function.
+ */
+static bool fill_row(Graph *g, int s, double *row, int size)
+{
+    SPT *spt = dijkstra_sp(g, s);
+    if(spt == NULL)
+        return false;
+
+    for(int v = 0; v < size; v++)
+        row[v] = spt_path_dist(spt, v);
+
+    spt_free(&spt);
+    return true;
+}
+
+
+/**
+ * Main function of the threads that compute the distance tables.
+ */
+static void* alt_build_worker(void *arg)
+{
+    AltBuild *b = arg;
+    ALT *alt = b->alt;
+
+    while(1) {
+        pthread_mutex_lock(&b->lock);
+        int j = b->next_job++;
+        pthread_mutex_unlock(&b->lock);
+
+        if(j >= b->num_jobs)
+            break;
+
+        bool ok = true;
+        if(j < alt->k && !b->skip_from)
+            ok = fill_row(b->g, alt->landmarks[j], &alt->from[(size_t) j * alt->size], alt->size);
+        else if(j >= alt->k)
+            ok = fill_row(b->rev, alt->landmarks[j - alt->k], &alt->to[(size_t) (j - alt->k) * alt->size], alt->size);
+
+        if(!ok) {
+            pthread_mutex_lock(&b->lock);
+            b->failed = true;
+            pthread_mutex_unlock(&b->lock);
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Returns a copy of the graph with all of its edges reversed or NULL if the 
+ * memory couldn't be allocated (a partial copy would make the backward rows 
+ * too large). Auxiliary function.
+ */
+static Graph* reverse_graph(Graph *g)
+{
+    int size = graph_array_size(g);
+    Graph *rev = graph_create_full(size, size);
+    if(rev == NULL)
+        return NULL;
+
+    bool ok = true;
+    for(int v = 0; ok && v < size; v++) {
+        if(graph_has_vertex(g, v))
+            ok = graph_add_vertex(rev, v);
+    }
+
+    for(int v = 0; ok && v < size; v++) {
+        Edge *e;
+        EdgeIter it = graph_edges_begin(g, v);
+        while(ok && edge_next(&it, &e))
+            ok = graph_add_edge(rev, edge_dest(e), v, edge_weight(e), false);
+    }
+
+    if(!ok)
+        graph_free(&rev);
+    return rev;
+}
+
+
+/**
+ *      Chooses the landmarks with the farthest-point heuristic: the first one is
+ * the vertex farthest from an arbitrary vertex and each of the others is the
+ * vertex whose distance to the nearest landmark already chosen is the greatest
+ * (only reachable vertices are considered). The from rows of the table are
+ * filled along the way. Returns false if the memory couldn't be allocated.
+ */
+static bool select_farthest(ALT *alt, Graph *g, int *vertices, int n)
+{
+    double *min_dist = malloc(sizeof(double) * alt->size);
+    if(min_dist == NULL || !fill_row(g, vertices[0], min_dist, alt->size)) {
+        free(min_dist);
+        return false;
+    }
+
+    bool *chosen = calloc(alt->size, sizeof(bool));
+    if(chosen == NULL) {
+        free(min_dist);
+        return false;
+    }
+
+    for(int i = 0; i < alt->k; i++) {
+        int best = -1;
+        for(int j = 0; j < n; j++) {
+            int v = vertices[j];
+            if(!chosen[v] && (best == -1 || (isinf(min_dist[best]) && !isinf(min_dist[v]))
+                              || (!isinf(min_dist[v]) && min_dist[v] > min_dist[best])))
+                best = v;
+        }
+
+        alt->landmarks[i] = best;
+        chosen[best] = true;
+
+        double *row = &alt->from[(size_t) i * alt->size];
+        if(!fill_row(g, best, row, alt->size)) {
+            free(min_dist);  free(chosen);
+            return false;
+        }
+
+        for(int v = 0; v < alt->size; v++) {
+            if(i == 0 || row[v] < min_dist[v] || isinf(min_dist[v]))
+                min_dist[v] = row[v];
+        }
+    }
+
+    free(min_dist);  free(chosen);
+    return true;
+}
+
+
+/**
+ *      Chooses, as landmarks, the k vertices with the most edges leaving them.
+ */
+static void select_degree(ALT *alt, Graph *g, int *vertices, int n)
+{
+    for(int i = 0; i < alt->k; i++) {
+        int best = i;
+        for(int j = i + 1; j < n; j++) {
+            if(vertex_adj_size(g, vertices[j]) > vertex_adj_size(g, vertices[best]))
+                best = j;
+        }
+
+        int tmp = vertices[i];
+        vertices[i] = vertices[best];
+        vertices[best] = tmp;
+        alt->landmarks[i] = vertices[i];
+    }
+}
+
+
+/**
+ *      Builds an ALT index for the graph: chooses the landmarks and computes the
+ * distances from and to each of them. The Dijkstra's searches (two per
+ * landmark; the backward ones run on a reversed copy of the graph) are split
+ * among nthreads threads. With ALT_SELECT_FARTHEST, the forward searches are
+ * part of the (sequential) selection of the landmarks.
+ *
+ * @param g a pointer to the graph (expects a weighted digraph).
+ * @param k number of landmarks (at most the number of vertices).
+ * @param selection how the landmarks are chosen (ALT_SELECT_FARTHEST or
+ * ALT_SELECT_DEGREE).
+ * @param nthreads number of threads computing the distance tables.
+ * @return a pointer to the index or NULL if the graph is empty or the memory
+ * couldn't be allocated.
+ */
+ALT* alt_create(Graph *g, int k, int selection, int nthreads)
+{
+    int n = graph_num_vertices(g);
+    if(n == 0 || k < 1)
+        return NULL;
+    if(k > n)
+        k = n;
+    if(nthreads < 1)
+        nthreads = 1;
+
+    ALT *alt = calloc(1, sizeof(ALT));
+    if(alt == NULL)
+        return NULL;
+
+    alt->k = k;
+    alt->size = graph_array_size(g);
+    alt->landmarks = malloc(sizeof(int) * k);
+    alt->from = malloc(sizeof(double) * k * alt->size);
+    alt->to = malloc(sizeof(double) * k * alt->size);
+
+    int *vertices = graph_vertices(g);
+    Graph *rev = reverse_graph(g);
+    pthread_t *threads = malloc(sizeof(pthread_t) * nthreads);
+    AltBuild b = {.alt = alt, .g = g, .rev = rev, .next_job = 0, .num_jobs = 2*k};
+
+    bool ok = alt->landmarks != NULL && alt->from != NULL && alt->to != NULL
+              && vertices != NULL && rev != NULL && threads != NULL;
+
+    if(ok) {
+        if(selection == ALT_SELECT_DEGREE)
+            select_degree(alt, g, vertices, n);
+        else
+            ok = b.skip_from = select_farthest(alt, g, vertices, n);
+    }
+
+    if(ok) {
+        pthread_mutex_init(&b.lock, NULL);
+
+        int started = 0;
+        for(; started < nthreads; started++) {
+            if(pthread_create(&threads[started], NULL, &alt_build_worker, &b) != 0)
+                break;
+        }
+        if(started == 0)
+            alt_build_worker(&b);     // no threads: does all the work here
+        for(int t = 0; t < started; t++)
+            pthread_join(threads[t], NULL);
+
+        pthread_mutex_destroy(&b.lock);
+        ok = !b.failed;
+    }
+
+    free(vertices);  free(threads);
+    if(rev != NULL)
+        graph_free(&rev);
+
+    if(!ok)
+        alt_free(&alt);
+    return alt;
+}
+
+
+/**
+ * Frees the memory allocated by the index (or unmaps its file).
+ *
+ * @param alt a pointer to the variable that is holding a pointer to the index;
+ * by the end of the call, the variable will be set to NULL.
+ */
+void alt_free(ALT **alt)
+{
+    if((*alt)->map != NULL)
+        munmap((*alt)->map, (*alt)->map_size);
+    else {
+        free((*alt)->landmarks);
+        free((*alt)->from);
+        free((*alt)->to);
+    }
+
+    free(*alt);
+    *alt = NULL;
+}
+
+
+/**
+ *      Saves the index to a binary file that can be loaded with alt_load()
+ * (see AltFileHeader for the layout).
+ *
+ * @param alt a pointer to the index.
+ * @param path the path of the file (overwritten if it exists).
+ * @return true if the file was written; false otherwise (including when the
+ * machine isn't little-endian).
+ */
+bool alt_save(ALT *alt, const char *path)
+{
+    if(!little_endian())
+        return false;
+
+    FILE *f = fopen(path, "wb");
+    if(f == NULL)
+        return false;
+
+    AltFileHeader header = {{0}, ALT_FILE_VERSION, alt->k, alt->size, 0};
+    memcpy(header.magic, ALT_FILE_MAGIC, sizeof(header.magic));
+
+    size_t table = (size_t) alt->k * alt->size;
+    int32_t *landmarks = malloc(sizeof(int32_t) * alt->k);
+    bool ok = landmarks != NULL;
+    for(int i = 0; ok && i < alt->k; i++)
+        landmarks[i] = alt->landmarks[i];
+
+    ok = ok && fwrite(&header, sizeof(header), 1, f) == 1
+            && write_padding(f, sizeof(header))
+            && fwrite(landmarks, sizeof(int32_t), alt->k, f) == (size_t) alt->k
+            && write_padding(f, sizeof(int32_t) * alt->k)
+            && fwrite(alt->from, sizeof(double), table, f) == table
+            && write_padding(f, sizeof(double) * table)
+            && fwrite(alt->to, sizeof(double), table, f) == table;
+
+    free(landmarks);
+    return fclose(f) == 0 && ok;
+}
+
+
+/**
+ *      Loads an index saved with alt_save(). The file is mapped into memory
+ * (read-only) and the index's tables point straight into the mapping, so no
+ * parsing or copying is done; the pages are read from the disk as the queries
+ * touch them.
+ *
+ * @param path the path of the file.
+ * @return a pointer to the index or NULL if the file couldn't be mapped or
+ * isn't a valid index.
+ */
+ALT* alt_load(const char *path)
+{
+    if(!little_endian())
+        return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+        return NULL;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(AltFileHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // the mapping stays valid
+    if(map == MAP_FAILED)
+        return NULL;
+
+    AltFileHeader *header = map;
+    size_t landmarks_at = align_up(sizeof(AltFileHeader)),
+           from_at = landmarks_at + align_up(sizeof(int32_t) * header->k),
+           table = (size_t) header->k * header->size,
+           to_at = from_at + align_up(sizeof(double) * table);
+
+    bool valid = memcmp(header->magic, ALT_FILE_MAGIC, sizeof(header->magic)) == 0
+                 && header->version == ALT_FILE_VERSION
+                 && header->k <= INT_MAX && header->size <= INT_MAX
+                 && table <= (size_t) st.st_size / sizeof(double)
+                 && to_at + sizeof(double) * table <= (size_t) st.st_size;
+
+    // the landmarks must be vertices of the tables
+    const int32_t *landmarks = (const int32_t*) ((char*) map + landmarks_at);
+    for(uint32_t i = 0; valid && i < header->k; i++)
+        valid = landmarks[i] >= 0 && (uint32_t) landmarks[i] < header->size;
+
+    ALT *alt = valid ? malloc(sizeof(ALT)) : NULL;
+    if(alt == NULL) {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    alt->k = header->k;
+    alt->size = header->size;
+    alt->landmarks = (int*) ((char*) map + landmarks_at);
+    alt->from = (double*) ((char*) map + from_at);
+    alt->to = (double*) ((char*) map + to_at);
+    alt->map = map;
+    alt->map_size = st.st_size;
+    return alt;
+}
+
+
+/**
+ *      Returns a lower bound of the distance from v to t, derived from the
+ * distances to and from the landmarks (0 if either vertex isn't covered by the
+ * index).
+ */
+double alt_lower_bound(ALT *alt, int v, int t)
+{
+    if(v < 0 || v >= alt->size || t < 0 || t >= alt->size)
+        return 0;
+
+    double bound = 0;
+    for(int i = 0; i < alt->k; i++) {
+        const double *from = &alt->from[(size_t) i * alt->size],
+                     *to = &alt->to[(size_t) i * alt->size];
+
+        // d(v, t) >= d(L, t) - d(L, v)
+        if(!isinf(from[v]) && !isinf(from[t]) && from[t] - from[v] > bound)
+            bound = from[t] - from[v];
+
+        // d(v, t) >= d(v, L) - d(t, L)
+        if(!isinf(to[v]) && !isinf(to[t]) && to[v] - to[t] > bound)
+            bound = to[v] - to[t];
+    }
+
+    return bound;
+}
+
+
+/**
+ * Context of the heuristic used by alt_sp().
+ */
+typedef struct {
+    ALT *alt;
+    int t;
+} AltQuery;
+
+
+/**
+ * Heuristic used by alt_sp() (see astar_sp()).
+ */
+static double alt_heuristic(int v, void *ctx) {
+    AltQuery *q = ctx;
+    return alt_lower_bound(q->alt, v, q->t);
+}
+
+
+/**
+ *      Finds a shortest path from s to t with the A* search guided by the
+ * landmarks' lower bounds.
+ *
+ * @param alt a pointer to the index (built for the graph g).
+ * @param g a pointer to the graph.
+ * @param s the identifier (index) of the source vertex.
+ * @param t the identifier (index) of the target vertex.
+ * @return the SPT built by astar_sp() (use spt_path_to(spt, t) to get the
+ * path) or NULL if the memory couldn't be allocated.
+ */
+SPT* alt_sp(ALT *alt, Graph *g, int s, int t)
+{
+    AltQuery q = {alt, t};
+    return astar_sp(g, s, t, &alt_heuristic, &q);
+}
+
+
+/**
+ * Returns the number of landmarks in the index.
+ */
+int alt_num_landmarks(ALT *alt) {
+    return alt->k;
+}
+
+
+/**
+ * Returns the i-th landmark of the index.
+ */
+int alt_landmark(ALT *alt, int i) {
+    return alt->landmarks[i];
+}
@@ -0,0 +1,56 @@
+/**
+ * ALT (A*, Landmarks and Triangle inequality) index for goal-directed
+ * shortest path queries on a weighted digraph.
+ *
+ * A few vertices are chosen as landmarks and the distances from each landmark
+ * to every vertex, and from every vertex to each landmark, are computed with
+ * dijkstra_sp(). By the triangle inequality, for any landmark L and vertices v
+ * and t:
+ *      d(v, t) >= d(L, t) - d(L, v)      and      d(v, t) >= d(v, L) - d(t, L)
+ * so the greatest of those differences is a lower bound of d(v, t), used as
+ * the heuristic of an A* search (astar_sp()).
+ *
+ * Example of use:
+ *      ALT *alt = alt_create(g, 16, ALT_SELECT_FARTHEST, 8);   // 16 landmarks, 8 threads
+ *      alt_save(alt, "graph.alt");                            // binary file
+ *      ...
+ *      ALT *alt = alt_load("graph.alt");                      // mmap, no preprocessing
+ *      SPT *spt = alt_sp(alt, g, s, t);
+ *      List *path = spt_path_to(spt, t);
+ *
+ * The index is a snapshot: it must be rebuilt if the graph changes (if the
+ * weights only increase, the bounds remain valid, though). Edges with negative
+ * weights are not supported.
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+#ifndef LANDMARKS_H
+    #define LANDMARKS_H
+    #include "weighted_digraph.h"
+    #include "shortest_paths.h"
+    #include <stdbool.h>
+
+    /* Constants */
+    #define ALT_SELECT_FARTHEST 0    // each landmark is the vertex farthest from the ones already chosen
+    #define ALT_SELECT_DEGREE 1      // the landmarks are the vertices with the most edges
+
+    /* Structs */
+    typedef struct LandmarksIndex ALT;
+
+    /* Create/Free */
+    ALT* alt_create(Graph *g, int k, int selection, int nthreads);
+    void alt_free(ALT **alt);
+
+    /* Binary files */
+    bool alt_save(ALT *alt, const char *path);
+    ALT* alt_load(const char *path);
+
+    /* Queries */
+    SPT* alt_sp(ALT *alt, Graph *g, int s, int t);
+    double alt_lower_bound(ALT *alt, int v, int t);
+
+    int alt_num_landmarks(ALT *alt);
+    int alt_landmark(ALT *alt, int i);
+#endif
@@ -23,6 +23,14 @@ void print_edge_head(void *edge) {
 }
 
 
+/**
+ * Auxiliary function to print an edge (tail, head and weight).
+ */
+void print_edge(void *edge) {
+    printf(" (%d -> %d, %.2lf)", edge_source(edge), edge_dest(edge), edge_weight(edge));
+}
+
+
 /**
  * List of commands:
  * 
@@ -33,7 +41,9 @@ void print_edge_head(void *edge) {
  *      4 v      - removes the vertex v from the graph
  *      5        - prints informations about the graph (number of vertices and edges, etc)
  *      6        - prints the adjacency list of all the graph's vertices
- *      7 s v     - prints the single source shortest path from s to v
+ *      7 s v    - prints the single source shortest path from s to v
+ *      8 s v    - same as 7, but using the Bellman-Ford algorithm (handles negative weights and cycles)
+ *      9 s v    - prints the shortest path from s to v found by the bidirectional Dijkstra's algorithm
  *      
  */
 int main(void) 
@@ -76,13 +86,24 @@ int main(void)
                 graph_print(g);
                 printf("--------------------------------------------\n\n");
             }
-            // [7] SSSP
-            else if(opt == 7) {
+            // [7] SSSP / [8] SSSP (BELLMAN-FORD)
+            else if(opt == 7 || opt == 8) {
                 int s, v;  scanf(" %d %d", &s, &v);
-                SPT *spt = dijkstra_sp(g, s);
+                SPT *spt = (opt == 7) ? dijkstra_sp(g, s) : bellman_ford_sp(g, s);
 
                 printf("\nspt->source = %d  |  spt->size = %d\n", 
                         spt_source(spt), spt_size(spt));
+
+                List *cycle = spt_negative_cycle(spt);
+                if(cycle != NULL) {
+                    printf("NEGATIVE CYCLE: {");
+                    list_print(cycle, &print_edge);
+                    list_free(&cycle, &free);
+                    printf(" }\n\n");
+                    spt_free(&spt);
+                    continue;
+                }
+
                 printf("HAS PATH: %d  |  PATH WEIGHT: %.2lf\n", 
                         spt_has_path(spt, v), spt_path_dist(spt, v));
                 
@@ -96,6 +117,21 @@ int main(void)
                 printf("\n");
                 spt_free(&spt);
             }
+            // [9] POINT-TO-POINT SHORTEST PATH
+            else if(opt == 9) {
+                int s, v;  scanf(" %d %d", &s, &v);
+                double dist;
+                List *path = dijkstra_p2p(g, s, v, &dist);
+
+                printf("\nP2P %d -> %d  |  PATH WEIGHT: %.2lf\n", s, v, dist);
+                if(path != NULL) {
+                    printf("PATH: { %d", s);
+                    list_print(path, &print_edge_head);
+                    list_free(&path, &free);
+                    printf(" }\n");
+                }
+                printf("\n");
+            }
         } while(opt != 0);
         
         graph_free(&g);
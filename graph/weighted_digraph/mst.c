@@ -0,0 +1,719 @@
+/**
+ * Simple API for finding minimum spanning forests of weighted digraphs, whose
+ * edges are treated as undirected.
+ *
+ * Prim's algorithm (mst_prim()) grows one tree at a time from a root, always
+ * adding the lightest edge leaving the tree, taken from an indexed heap. Since
+ * the edges must be followed in both directions, they are first copied into an
+ * undirected adjacency structure (in the CSR format).
+ *
+ * Kruskal's algorithm (mst_kruskal()) adds the edges in increasing order of
+ * weight, skipping the ones that would close a cycle. The edges are sorted by
+ * a least significant digit radix sort on the bits of their weights (passes in
+ * which all the edges have the same digit are skipped, which is common when the
+ * weights are integers) and the trees are kept in a union-find with path
+ * halving and union by rank.
+ *
+ * Boruvka's algorithm (mst_boruvka()) runs in rounds: in each round, the
+ * lightest edge leaving each component is found and all of those edges are
+ * added at once, merging the components. Every step of a round is split among
+ * the threads: the lightest edges are selected with atomic compare-and-swap
+ * operations on a shared array, the components are merged by pointer jumping
+ * and the edges that end up inside a component are dropped.
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+
+#define _POSIX_C_SOURCE 200112L
+#include "mst.h"
+#include "indexed_heap.h"
+#include "thread_team.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+
+/**
+ *      Minimum spanning forest of a graph.
+ *
+ * Attributes:
+ *      . num_vertices: number of vertices of the graph.
+ *      . num_edges: number of edges of the forest (at most num_vertices - 1).
+ *      . from, to, weight: the edges of the forest; the i-th edge connects the
+ *      vertices from[i] and to[i] and has the weight weight[i].
+ *      . total_weight: sum of the weights of the forest's edges.
+ */
+struct MinimumSpanningForest {
+    int num_vertices, num_edges;
+    int *from, *to;
+    double *weight, total_weight;
+};
+
+
+/**
+ *      Creates an empty forest with room for the edges of a spanning forest of
+ * the graph. Auxiliary function.
+ */
+static MSF* msf_create(Graph *g)
+{
+    MSF *msf = malloc(sizeof(MSF));
+    if(msf == NULL)
+        return NULL;
+
+    int capacity = (graph_num_vertices(g) > 1) ? graph_num_vertices(g) - 1 : 1;
+    msf->num_vertices = graph_num_vertices(g);
+    msf->num_edges = 0;
+    msf->total_weight = 0;
+    msf->from = malloc(sizeof(int) * capacity);
+    msf->to = malloc(sizeof(int) * capacity);
+    msf->weight = malloc(sizeof(double) * capacity);
+
+    if(msf->from == NULL || msf->to == NULL || msf->weight == NULL)
+        msf_free(&msf);
+    return msf;
+}
+
+
+/**
+ * Adds the edge {v, w} to the forest. Auxiliary function.
+ */
+static inline void msf_add(MSF *msf, int v, int w, double weight)
+{
+    msf->from[msf->num_edges] = v;
+    msf->to[msf->num_edges] = w;
+    msf->weight[msf->num_edges++] = weight;
+    msf->total_weight += weight;
+}
+
+
+/**
+ * Frees the memory used by the forest and sets the pointer to NULL.
+ *
+ * @param msf a pointer to the pointer to the forest.
+ */
+void msf_free(MSF **msf)
+{
+    if(msf == NULL || *msf == NULL)
+        return;
+
+    free((*msf)->from);
+    free((*msf)->to);
+    free((*msf)->weight);
+    free(*msf);
+    *msf = NULL;
+}
+
+
+/**
+ * Returns the sum of the weights of the forest's edges.
+ */
+double msf_weight(MSF *msf) {
+    return msf->total_weight;
+}
+
+
+/**
+ * Returns the number of edges of the forest.
+ */
+int msf_num_edges(MSF *msf) {
+    return msf->num_edges;
+}
+
+
+/**
+ *      Returns the number of trees of the forest, which is the number of
+ * connected components of the graph (isolated vertices included).
+ */
+int msf_num_trees(MSF *msf) {
+    return msf->num_vertices - msf->num_edges;
+}
+
+
+/**
+ *      Returns a list with copies of the forest's edges (see edge_create()),
+ * in the order they were added by the algorithm. Since the edges are treated
+ * as undirected, the order of the endpoints of each edge isn't meaningful.
+ *
+ * @param msf a pointer to the forest.
+ * @return a list with the edges (to be freed with list_free(&list, free)) or
+ * NULL if the memory couldn't be allocated.
+ */
+List* msf_edges(MSF *msf)
+{
+    List *edges = list_create();
+    if(edges == NULL)
+        return NULL;
+
+    for(int i = 0; i < msf->num_edges; i++) {
+        Edge *e = edge_create(msf->from[i], msf->to[i], msf->weight[i]);
+        if(e == NULL || !list_append(edges, e)) {
+            free(e);
+            list_free(&edges, free);
+            return NULL;
+        }
+    }
+
+    return edges;
+}
+
+
+/**
+ *      Undirected copy of a graph's edges: each edge v->w (v != w) appears in
+ * the lists of both v and w. The neighbours of v are at the positions
+ * [offset[v], offset[v+1]) of the arrays to and weight. Auxiliary structure of
+ * mst_prim().
+ */
+typedef struct {
+    size_t *offset;
+    int *to;
+    double *weight;
+} UndirectedEdges;
+
+
+/**
+ *      Copies the edges of the graph into u, in both directions. Returns false
+ * if the memory couldn't be allocated. Auxiliary function.
+ */
+static bool undirected_freeze(UndirectedEdges *u, Graph *g)
+{
+    int size = graph_array_size(g);
+    size_t m = 2 * (size_t) graph_num_edges(g);
+    u->offset = calloc(size + 1, sizeof(size_t));
+    u->to = malloc(sizeof(int) * (m > 0 ? m : 1));
+    u->weight = malloc(sizeof(double) * (m > 0 ? m : 1));
+    size_t *pos = malloc(sizeof(size_t) * (size > 0 ? size : 1));
+
+    if(u->offset == NULL || u->to == NULL || u->weight == NULL || pos == NULL) {
+        free(pos);
+        return false;
+    }
+
+    // degrees
+    Edge *e;
+    for(int v = 0; v < size; v++) {
+        EdgeIter it = graph_edges_begin(g, v);
+        while(edge_next(&it, &e)) {
+            if(edge_dest(e) != v) {
+                u->offset[v + 1]++;
+                u->offset[edge_dest(e) + 1]++;
+            }
+        }
+    }
+    for(int v = 0; v < size; v++) {
+        u->offset[v + 1] += u->offset[v];
+        pos[v] = u->offset[v];
+    }
+
+    // edges
+    for(int v = 0; v < size; v++) {
+        EdgeIter it = graph_edges_begin(g, v);
+        while(edge_next(&it, &e)) {
+            int w = edge_dest(e);
+            if(w == v)
+                continue;   // self-loop
+
+            u->to[pos[v]] = w;
+            u->weight[pos[v]++] = edge_weight(e);
+            u->to[pos[w]] = v;
+            u->weight[pos[w]++] = edge_weight(e);
+        }
+    }
+
+    free(pos);
+    return true;
+}
+
+
+/**
+ *      Finds a minimum spanning forest of the graph with Prim's algorithm:
+ * starting from each vertex not yet in a tree, a tree is grown by repeatedly
+ * adding the lightest edge between the tree and a vertex outside of it. The
+ * candidate edge of each vertex outside of the tree is kept in an indexed heap
+ * (see indexed_heap.h), whose priorities are decreased as lighter edges are
+ * found. Runs in O(|E| log |V|) time.
+ *
+ *      The edges are treated as undirected (v->w connects v and w; self-loops
+ * are ignored), so they are first copied into an undirected adjacency
+ * structure, which takes 24 bytes per edge.
+ *
+ * @param g a pointer to the graph.
+ * @return a pointer to the forest or NULL if the memory couldn't be allocated.
+ */
+MSF* mst_prim(Graph *g)
+{
+    int size = graph_array_size(g);
+    UndirectedEdges u = {0};
+    MSF *msf = msf_create(g);
+    IndexedHeap *pq = iheap_create(size > 0 ? size : 1);
+    double *key = malloc(sizeof(double) * (size > 0 ? size : 1));
+    int *parent = malloc(sizeof(int) * (size > 0 ? size : 1));
+    bool *done = calloc(size > 0 ? size : 1, sizeof(bool));
+
+    if(msf == NULL || pq == NULL || key == NULL || parent == NULL || done == NULL
+            || !undirected_freeze(&u, g)) {
+        msf_free(&msf);
+        goto cleanup;
+    }
+
+    for(int v = 0; v < size; v++) {
+        key[v] = INFINITY;
+        parent[v] = -1;
+    }
+
+    for(int r = 0; r < size; r++) {
+        if(done[r] || !graph_has_vertex(g, r))
+            continue;
+
+        // grows a new tree, rooted at r
+        iheap_insert(pq, r, 0);
+        while(!iheap_empty(pq)) {
+            int v = iheap_pop_min(pq);
+            done[v] = true;
+            if(parent[v] != -1)
+                msf_add(msf, parent[v], v, key[v]);
+
+            for(size_t i = u.offset[v]; i < u.offset[v + 1]; i++) {
+                int w = u.to[i];
+                if(done[w] || !(u.weight[i] < key[w]))
+                    continue;
+
+                key[w] = u.weight[i];
+                parent[w] = v;
+                if(iheap_contains(pq, w))
+                    iheap_decrease_key(pq, w, key[w]);
+                else
+                    iheap_insert(pq, w, key[w]);
+            }
+        }
+    }
+
+cleanup:
+    if(pq != NULL)
+        iheap_free(&pq);
+    free(key);  free(parent);  free(done);
+    free(u.offset);  free(u.to);  free(u.weight);
+    return msf;
+}
+
+
+/**
+ *      An edge being sorted by mst_kruskal(). The key is the edge's weight
+ * mapped to an unsigned integer with the same order (see weight_key()).
+ */
+typedef struct {
+    uint64_t key;
+    int v, w;
+} SortedEdge;
+
+
+/**
+ *      Maps a weight to an unsigned integer such that the order of the
+ * integers is the order of the weights: the sign bit of the non-negative
+ * numbers is set and all the bits of the negative ones are flipped.
+ * Auxiliary function.
+ */
+static inline uint64_t weight_key(double weight)
+{
+    uint64_t bits;
+    memcpy(&bits, &weight, sizeof(bits));
+    return (bits >> 63) ? ~bits : bits | (1ULL << 63);
+}
+
+
+/**
+ * Inverse of weight_key(). Auxiliary function.
+ */
+static inline double key_weight(uint64_t key)
+{
+    uint64_t bits = (key >> 63) ? key & ~(1ULL << 63) : ~key;
+    double weight;
+    memcpy(&weight, &bits, sizeof(weight));
+    return weight;
+}
+
+
+/**
+ *      Sorts the edges by their keys with a least significant digit radix sort,
+ * 8 bits per pass. The passes in which all the keys have the same digit (e.g.
+ * the low bits of the mantissas of integer weights) are skipped.
+ *
+ * @param edges the edges to be sorted.
+ * @param tmp an auxiliary array with the same size.
+ * @param n number of edges.
+ * @return the array (edges or tmp) that holds the sorted edges.
+ */
+static SortedEdge* radix_sort_by_weight(SortedEdge *edges, SortedEdge *tmp, size_t n)
+{
+    for(int shift = 0; shift < 64 && n > 0; shift += 8) {
+        size_t count[257] = {0};
+        for(size_t i = 0; i < n; i++)
+            count[((edges[i].key >> shift) & 0xFF) + 1]++;
+        if(count[((edges[0].key >> shift) & 0xFF) + 1] == n)
+            continue;   // same digit everywhere
+        for(int d = 0; d < 256; d++)
+            count[d + 1] += count[d];
+
+        for(size_t i = 0; i < n; i++)
+            tmp[count[(edges[i].key >> shift) & 0xFF]++] = edges[i];
+
+        SortedEdge *t = edges;
+        edges = tmp;
+        tmp = t;
+    }
+    return edges;
+}
+
+
+/**
+ *      Returns the root of the tree of v in the union-find, halving the path
+ * on the way (each vertex visited is linked to its grandparent). Auxiliary
+ * function.
+ */
+static inline int uf_find(int *parent, int v)
+{
+    while(parent[v] != v) {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+
+/**
+ *      Finds a minimum spanning forest of the graph with Kruskal's algorithm:
+ * the edges are taken in increasing order of weight and each one is added to
+ * the forest unless its endpoints are already in the same tree. The edges are
+ * sorted with a radix sort on their weights (O(|E|), 32 bytes per edge) and the
+ * trees are kept in a union-find with path halving and union by rank.
+ * Stops as soon as the forest has |V| - 1 edges.
+ *
+ *      The edges are treated as undirected (v->w connects v and w; self-loops
+ * are ignored).
+ *
+ * @param g a pointer to the graph.
+ * @return a pointer to the forest or NULL if the memory couldn't be allocated.
+ */
+MSF* mst_kruskal(Graph *g)
+{
+    int size = graph_array_size(g), m = graph_num_edges(g);
+    MSF *msf = msf_create(g);
+    SortedEdge *edges = malloc(sizeof(SortedEdge) * (m > 0 ? m : 1)),
+               *tmp = malloc(sizeof(SortedEdge) * (m > 0 ? m : 1));
+    int *parent = malloc(sizeof(int) * (size > 0 ? size : 1));
+    unsigned char *rank = calloc(size > 0 ? size : 1, 1);
+
+    if(msf == NULL || edges == NULL || tmp == NULL || parent == NULL || rank == NULL) {
+        msf_free(&msf);
+        goto cleanup;
+    }
+
+    size_t n = 0;
+    for(int v = 0; v < size; v++) {
+        parent[v] = v;
+        Edge *e;
+        EdgeIter it = graph_edges_begin(g, v);
+        while(edge_next(&it, &e)) {
+            if(edge_dest(e) != v) {
+                SortedEdge se = {weight_key(edge_weight(e)), v, edge_dest(e)};
+                edges[n++] = se;
+            }
+        }
+    }
+    SortedEdge *sorted = radix_sort_by_weight(edges, tmp, n);
+
+    int max_edges = graph_num_vertices(g) - 1;
+    for(size_t i = 0; i < n && msf->num_edges < max_edges; i++) {
+        int a = uf_find(parent, sorted[i].v), b = uf_find(parent, sorted[i].w);
+        if(a == b)
+            continue;   // would close a cycle
+
+        if(rank[a] < rank[b]) {
+            int t = a;  a = b;  b = t;
+        }
+        parent[b] = a;
+        if(rank[a] == rank[b])
+            rank[a]++;
+
+        msf_add(msf, sorted[i].v, sorted[i].w, key_weight(sorted[i].key));
+    }
+
+cleanup:
+    free(edges);  free(tmp);
+    free(parent);  free(rank);
+    return msf;
+}
+
+
+/**
+ *      State shared by the threads running mst_boruvka(). Each component is
+ * labeled by one of its vertices (its root). The edges are identified by their
+ * positions (ids) in the arrays src, dst and weight and are ordered by weight
+ * and then by id, so that no two edges are equally light.
+ *
+ * Attributes:
+ *      . size, max_threads: size of the graph's array of adjacency lists and
+ *      number of threads requested.
+ *      . num_edges, src, dst, weight: the edges of the graph (self-loops
+ *      excluded).
+ *      . live: the ids of the edges that may still leave a component; the
+ *      thread t owns the t-th chunk of the array and keeps its live edges at
+ *      the beginning of the chunk.
+ *      . comp: the component (root) of each vertex.
+ *      . best: the lightest edge leaving each component (-1 if none).
+ *      . next: the component each component is merged into in the current
+ *      round (itself if it's still a root); after the pointer jumping, the
+ *      root of the merged component.
+ *      . tree_edge: the edge added to the forest when the component labeled by
+ *      each vertex was merged into another (-1 if none).
+ *      . merges: number of merges made by each thread in the current round.
+ *      . team: the threads running the rounds; its barrier synchronizes the
+ *      steps of each round (see thread_team.h).
+ */
+typedef struct {
+    int size, max_threads;
+
+    int num_edges;
+    int *src, *dst;
+    double *weight;
+    int *live;
+
+    int *comp, *best, *next, *tree_edge;
+    int *merges;
+
+    ThreadTeam team;
+} Boruvka;
+
+
+/**
+ * Arguments of a worker thread of mst_boruvka().
+ */
+typedef struct {
+    Boruvka *b;
+    int id;
+} BoruvkaWorker;
+
+
+/**
+ * Checks whether the edge e is lighter than the edge f. Auxiliary function.
+ */
+static inline bool boruvka_lighter(Boruvka *b, int e, int f) {
+    return b->weight[e] < b->weight[f] || (b->weight[e] == b->weight[f] && e < f);
+}
+
+
+/**
+ *      Makes e the lightest edge leaving the component c, unless a lighter one
+ * is already known. Lock-free: the value is replaced with a compare-and-swap,
+ * retried while e is still lighter than the edge seen. Auxiliary function.
+ */
+static inline void boruvka_offer(Boruvka *b, int c, int e)
+{
+    int current = __atomic_load_n(&b->best[c], __ATOMIC_RELAXED);
+    while(current == -1 || boruvka_lighter(b, e, current)) {
+        if(__atomic_compare_exchange_n(&b->best[c], &current, e, true,
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            return;
+    }
+}
+
+
+/**
+ *      Runs Boruvka's rounds as the thread t, until no component has an edge
+ * leaving it. Each step works on the t-th chunk of the vertices (or of the
+ * edges) and is followed by a barrier:
+ *      1. the lightest edges of the components are reset;
+ *      2. the live edges are scanned: the ones inside a component are dropped
+ *      and the others are offered to the components at both ends;
+ *      3. each component c with an edge e is merged into the component d at
+ *      the other end of e (next[c] = d), and e is added to the forest; if d
+ *      also chose e, only the one with the greater label is merged;
+ *      4. pointer jumping: next[c] = next[next[c]] until next[c] is a root;
+ *      5. the vertices are relabeled with the roots of their new components.
+ * Auxiliary function.
+ */
+static void boruvka_run(Boruvka *b, int t)
+{
+    int T = b->team.nthreads,
+        v_lo = (int) ((long long) b->size * t / T),
+        v_hi = (int) ((long long) b->size * (t + 1) / T),
+        e_lo = (int) ((long long) b->num_edges * t / T),
+        num_live = (int) ((long long) b->num_edges * (t + 1) / T) - e_lo;
+    int *live = b->live + e_lo;
+
+    while(1) {
+        // 1. resets the lightest edges
+        for(int c = v_lo; c < v_hi; c++)
+            b->best[c] = -1;
+        pthread_barrier_wait(&b->team.barrier);
+
+        // 2. finds the lightest edge leaving each component
+        int kept = 0;
+        for(int i = 0; i < num_live; i++) {
+            int e = live[i], cu = b->comp[b->src[e]], cv = b->comp[b->dst[e]];
+            if(cu == cv)
+                continue;   // inside a component (for good)
+
+            live[kept++] = e;
+            boruvka_offer(b, cu, e);
+            boruvka_offer(b, cv, e);
+        }
+        num_live = kept;
+        pthread_barrier_wait(&b->team.barrier);
+
+        // 3. merges each component into the one at the other end of its edge
+        int merges = 0;
+        for(int c = v_lo; c < v_hi; c++) {
+            int e = b->best[c];
+            if(e == -1)
+                continue;   // not a root or no edge leaving it
+
+            int d = (b->comp[b->src[e]] == c) ? b->comp[b->dst[e]] : b->comp[b->src[e]];
+            if(b->best[d] == e && c < d)
+                continue;   // d chose the same edge and is merged into c
+
+            __atomic_store_n(&b->next[c], d, __ATOMIC_RELAXED);
+            b->tree_edge[c] = e;
+            merges++;
+        }
+        b->merges[t] = merges;
+        pthread_barrier_wait(&b->team.barrier);
+
+        // 4. pointer jumping (the chains only get shorter, so no locks are needed)
+        for(int c = v_lo; c < v_hi; c++) {
+            if(b->comp[c] != c)
+                continue;   // not a component
+
+            while(1) {
+                int p = __atomic_load_n(&b->next[c], __ATOMIC_RELAXED),
+                    pp = __atomic_load_n(&b->next[p], __ATOMIC_RELAXED);
+                if(p == pp)
+                    break;
+                __atomic_store_n(&b->next[c], pp, __ATOMIC_RELAXED);
+            }
+        }
+        pthread_barrier_wait(&b->team.barrier);
+
+        // 5. relabels the vertices
+        for(int v = v_lo; v < v_hi; v++)
+            b->comp[v] = b->next[b->comp[v]];
+        pthread_barrier_wait(&b->team.barrier);
+
+        int total = 0;
+        for(int p = 0; p < T; p++)
+            total += b->merges[p];
+        if(total == 0)
+            break;
+    }
+}
+
+
+/**
+ * Main function of the worker threads of mst_boruvka().
+ */
+static void* boruvka_worker(void *arg)
+{
+    BoruvkaWorker *worker = arg;
+    Boruvka *b = worker->b;
+
+    team_wait(&b->team);
+    boruvka_run(b, worker->id);
+    return NULL;
+}
+
+
+/**
+ *      Finds a minimum spanning forest of the graph with Boruvka's algorithm,
+ * split among several threads. In each round, the lightest edge leaving each
+ * component (initially, each vertex) is found and all of those edges are added
+ * to the forest at once, merging the components; the number of components at
+ * least halves in each round, so there are at most log2(|V|) rounds.
+ *
+ *      All the steps of a round run in parallel: the lightest edges are chosen
+ * with atomic compare-and-swap operations (ties are broken by the edges'
+ * positions, so the edges chosen never form a cycle), the components are
+ * merged by pointer jumping and the edges that end up inside a component are
+ * dropped from the following rounds. The edges are copied into flat arrays
+ * (20 bytes per edge) before the threads start, so the graph must not be
+ * changed during the call.
+ *
+ *      The edges are treated as undirected (v->w connects v and w; self-loops
+ * are ignored).
+ *
+ * @param g a pointer to the graph.
+ * @param nthreads number of threads (including the calling thread).
+ * @return a pointer to the forest or NULL if the memory couldn't be allocated.
+ * If some of the threads can't be created, the forest is found by the ones 
+ * that could.
+ */
+MSF* mst_boruvka(Graph *g, int nthreads)
+{
+    Boruvka b = {0};
+    b.size = graph_array_size(g);
+    b.max_threads = (nthreads > 0) ? nthreads : 1;
+
+    int m = graph_num_edges(g), n = (b.size > 0) ? b.size : 1;
+    b.src = malloc(sizeof(int) * (m > 0 ? m : 1));
+    b.dst = malloc(sizeof(int) * (m > 0 ? m : 1));
+    b.weight = malloc(sizeof(double) * (m > 0 ? m : 1));
+    b.live = malloc(sizeof(int) * (m > 0 ? m : 1));
+    b.comp = malloc(sizeof(int) * n);
+    b.best = malloc(sizeof(int) * n);
+    b.next = malloc(sizeof(int) * n);
+    b.tree_edge = malloc(sizeof(int) * n);
+    b.merges = calloc(b.max_threads, sizeof(int));
+    pthread_t *threads = malloc(sizeof(pthread_t) * b.max_threads);
+    BoruvkaWorker *workers = malloc(sizeof(BoruvkaWorker) * b.max_threads);
+    MSF *msf = msf_create(g);
+
+    if(b.src == NULL || b.dst == NULL || b.weight == NULL || b.live == NULL
+            || b.comp == NULL || b.best == NULL || b.next == NULL
+            || b.tree_edge == NULL || b.merges == NULL || threads == NULL
+            || workers == NULL || msf == NULL) {
+        msf_free(&msf);
+        goto cleanup;
+    }
+
+    for(int v = 0; v < b.size; v++) {
+        b.comp[v] = b.next[v] = v;
+        b.tree_edge[v] = -1;
+
+        Edge *e;
+        EdgeIter it = graph_edges_begin(g, v);
+        while(edge_next(&it, &e)) {
+            if(edge_dest(e) != v) {
+                b.src[b.num_edges] = v;
+                b.dst[b.num_edges] = edge_dest(e);
+                b.weight[b.num_edges] = edge_weight(e);
+                b.live[b.num_edges] = b.num_edges;
+                b.num_edges++;
+            }
+        }
+    }
+
+    // starts the worker threads and runs with the ones that could be created
+    // (the calling thread works as the thread 0)
+    for(int t = 0; t < b.max_threads; t++) {
+        workers[t].b = &b;
+        workers[t].id = t;
+    }
+    team_start(&b.team, threads, b.max_threads, &boruvka_worker, workers, sizeof(BoruvkaWorker));
+    boruvka_run(&b, 0);
+    team_finish(&b.team, threads);
+
+    for(int c = 0; c < b.size; c++) {
+        int e = b.tree_edge[c];
+        if(e != -1)
+            msf_add(msf, b.src[e], b.dst[e], b.weight[e]);
+    }
+
+cleanup:
+    free(b.src);  free(b.dst);  free(b.weight);  free(b.live);
+    free(b.comp);  free(b.best);  free(b.next);  free(b.tree_edge);
+    free(b.merges);
+    free(threads);  free(workers);
+    return msf;
+}
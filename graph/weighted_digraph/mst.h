@@ -0,0 +1,49 @@
+/**
+ * Minimum spanning forests of weighted digraphs, whose edges are treated as
+ * undirected: v->w and w->v both connect v and w (self-loops are ignored).
+ * When the graph (seen this way) isn't connected, the result has one minimum
+ * spanning tree per connected component.
+ *
+ * Three algorithms are available, with the same result (the total weight is
+ * the same; if some weights are equal, the edges chosen may differ):
+ *      . mst_prim(): Prim's algorithm, with an indexed heap, on an undirected
+ *      copy of the graph's edges;
+ *      . mst_kruskal(): Kruskal's algorithm; the edges are radix-sorted by
+ *      their weights and joined with a union-find (with path halving);
+ *      . mst_boruvka(): Boruvka's algorithm, multithreaded; in each round, the
+ *      lightest edge leaving each component is found by all the threads at
+ *      once (with atomic compare-and-swap) and the components are merged.
+ *
+ * Example of use:
+ *      MSF *msf = mst_boruvka(g, 8);       // 8 threads
+ *      printf("%f\n", msf_weight(msf));
+ *      List *edges = msf_edges(msf);
+ *      ...
+ *      list_free(&edges, free);
+ *      msf_free(&msf);
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+#ifndef MST_H
+    #define MST_H
+    #include "weighted_digraph.h"
+    #include "singly_linked_list.h"
+    #include <stdbool.h>
+
+    /* Structs */
+    typedef struct MinimumSpanningForest MSF;
+
+    /* Algorithms */
+    MSF* mst_prim(Graph *g);
+    MSF* mst_kruskal(Graph *g);
+    MSF* mst_boruvka(Graph *g, int nthreads);
+    void msf_free(MSF **msf);
+
+    /* Queries */
+    double msf_weight(MSF *msf);
+    int msf_num_edges(MSF *msf);
+    int msf_num_trees(MSF *msf);
+    List* msf_edges(MSF *msf);
+#endif
@@ -5,19 +5,42 @@
  *      SPT *spt = dijkstra_sp(g, s);      // shortest paths tree of the graph g with the vertex s as the root
  *      List *path = spt_path_to(spt, v);  // shortest path from s to v
  * 
- * @todo: change the Dijkstra's algorithm implementation to use a heap-based
- * priority queue.
- * @todo: implement the Bellman-Ford algorithm (deals with negative edges weights).
+ * For graphs whose edges have small non-negative integer weights, 
+ * dijkstra_sp_int() (Dial's algorithm) avoids the heap altogether.
+ * 
+ * Graphs with negative edge weights are handled by bellman_ford_sp(), which
+ * also detects negative cycles (see spt_negative_cycle()). On multi-core 
+ * machines, delta_stepping_sp() splits the search among several threads. When 
+ * only the path between two vertices is needed, dijkstra_p2p() is usually much 
+ * faster than building the whole tree; so is astar_sp(), if a good estimate of 
+ * the distances to the target is available. When only the distances to a few 
+ * targets, or within a radius, are needed, dijkstra_sp_bounded() stops early 
+ * and doesn't pay for the size of the graph. Graphs that are built once and 
+ * queried many times can be frozen into a CSR snapshot (see csr_graph.h) and 
+ * searched with dijkstra_sp_csr(), astar_sp_csr(), dijkstra_sp_int_csr(), 
+ * bellman_ford_sp_csr() and delta_stepping_sp_csr(). dijkstra_p2p() has no 
+ * snapshot variant: the snapshot only stores the edges leaving each vertex, so
+ * its backward search would have to rebuild the reversed edges, in O(|E|), on
+ * every query. Neither has dijkstra_sp_linear(), kept only for reference. 
+ * After a change to the weight of an edge, or the insertion of an edge, 
+ * spt_apply_edge_update() and spt_apply_edge_insert() repair a tree by 
+ * visiting only the affected vertices.
  * 
  * @version 1.0
  * @author Gabriel Nogueira (Talendar)
  */
 
 
+#define _POSIX_C_SOURCE 200112L
 #include "shortest_paths.h"
+#include "indexed_heap.h"
+#include "vertex_map.h"
+#include "thread_team.h"
 #include <stdlib.h>
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
+#include <pthread.h>
 
 
 /**
@@ -31,16 +54,29 @@
  *      source vertex to any other vertex in the tree; the distance to vertices 
  *      not reachable from the source is INFINITY and the distance from the 
  *      source to itself, 0.
- *      . edge_to: array of edges; edge_to[v] holds a pointer to the edge that
- *      connects v to its parent in the tree (the last edge on a shortest path
- *      from the source to v). If v is not reachable from the source, edge_to[v] 
- *      is NULL.
+ *      . parent, parent_weight: parent[v] is the parent of v in the tree (the
+ *      tail of the last edge on a shortest path from the source to v) and 
+ *      parent_weight[v] the weight of that edge. If v is the source or isn't 
+ *      reachable from it, parent[v] is -1. The edges themselves are only 
+ *      rebuilt when a path is requested, so relaxing an edge allocates nothing.
+ *      . cycle_vertex: a vertex on a negative cycle reachable from the source, 
+ *      found by the Bellman-Ford algorithm (the cycle can be retrieved by 
+ *      following parent from it); -1 if no such cycle was found.
+ *      . num_settled, num_relaxed: number of vertices settled (removed from 
+ *      the priority queue) and of edges relaxed (successfully or not) by the 
+ *      pathfinding algorithm; useful to measure how much work a search did.
+ *      . index: NULL if the arrays above are indexed by the vertices (dense 
+ *      tree); otherwise, the tree only holds the vertices reached by the search
+ *      (sparse tree, see dijkstra_sp_bounded()) and index maps each of them to
+ *      its position in the arrays (parent still holds vertices, though).
  * 
  */
 struct ShortestPathsTree {
-    int size, source;
-    double *dist_to;
-    Edge **edge_to;
+    int size, source, cycle_vertex;
+    double *dist_to, *parent_weight;
+    int *parent;
+    long long num_settled, num_relaxed;
+    VertexMap *index;
 };
 
 
@@ -60,22 +96,22 @@ static SPT* spt_create(int size, int source)
     if(spt != NULL) {
         spt->size = size;
         spt->source = source;
+        spt->cycle_vertex = -1;
+        spt->num_settled = spt->num_relaxed = 0;
+        spt->index = NULL;
 
         spt->dist_to = malloc(sizeof(double) * size);
-        if(spt->dist_to == NULL) {
+        spt->parent_weight = malloc(sizeof(double) * size);
+        spt->parent = malloc(sizeof(int) * size);
+        if(spt->dist_to == NULL || spt->parent_weight == NULL || spt->parent == NULL) {
+            free(spt->dist_to);  free(spt->parent_weight);  free(spt->parent);
             free(spt);
             return NULL;
         }
 
-        spt->edge_to = malloc(sizeof(Edge*) * size);
-        if(spt->edge_to == NULL) {
-            free(spt);  free(spt->dist_to);
-            return NULL;
-        }
-
         for(int i = 0; i < size; i++) {
             spt->dist_to[i] = INFINITY;
-            spt->edge_to[i] = NULL;
+            spt->parent[i] = -1;
         }
 
         spt->dist_to[source] = 0;
@@ -94,11 +130,10 @@ static SPT* spt_create(int size, int source)
 void spt_free(SPT **spt) 
 {
     free((*spt)->dist_to);
-    for(int i = 0; i < (*spt)->size; i++) {
-        if((*spt)->edge_to[i] != NULL)
-            free((*spt)->edge_to[i]);
-    }
-    free((*spt)->edge_to);
+    free((*spt)->parent_weight);
+    free((*spt)->parent);
+    if((*spt)->index != NULL)
+        vmap_free(&(*spt)->index);
 
     free(*spt);
     *spt = NULL;
@@ -121,6 +156,15 @@ int spt_size(SPT *spt) {
 }
 
 
+/**
+ * Returns the position of the vertex v in the arrays of the SPT or -1 if a 
+ * sparse SPT doesn't hold v. Auxiliary function.
+ */
+static inline int spt_pos(SPT *spt, int v) {
+    return (spt->index == NULL) ? v : vmap_get(spt->index, v);
+}
+
+
 /**
  * Checks whether there is a path from the SPT source to the vertex v.
  * 
@@ -129,12 +173,14 @@ int spt_size(SPT *spt) {
  * @return true if there is a path from the source to v and false otherwise. 
  */
 bool spt_has_path(SPT *spt, int v) {
-    return !isinf(spt->dist_to[v]);
+    int pos = spt_pos(spt, v);
+    return pos >= 0 && !isinf(spt->dist_to[pos]);
 }
 
 
 /**
- * Returns a list with the edges from the SPT's source to the vertex v. 
+ *      Returns a list with the edges from the SPT's source to the vertex v. The
+ * edges are rebuilt from the parents stored in the tree.
  * 
  * @param spt a pointer to a SPT.
  * @param v the identifier (index) of the destination vertex.
@@ -148,12 +194,10 @@ List* spt_path_to(SPT *spt, int v)
         return NULL;
 
     List *path = list_create();
-    Edge *e = spt->edge_to[v];
-
-    while(e != NULL) {      // iterates untill an edge from the source is found
-        Edge *e_cpy = copy_edge(e);
-        list_push(path, e_cpy);
-        e = spt->edge_to[edge_source(e)];
+    for(int pos = spt_pos(spt, v); spt->parent[pos] != -1; pos = spt_pos(spt, v)) {
+        // iterates untill the source is reached
+        list_push(path, edge_create(spt->parent[pos], v, spt->parent_weight[pos]));
+        v = spt->parent[pos];
     }
 
     return path;
@@ -170,7 +214,24 @@ List* spt_path_to(SPT *spt, int v)
  * there is no path.
  */
 double spt_path_dist(SPT *spt, int v) {
-    return spt->dist_to[v];
+    int pos = spt_pos(spt, v);
+    return (pos >= 0) ? spt->dist_to[pos] : INFINITY;
+}
+
+
+/**
+ * Returns the number of vertices settled by the algorithm that built the SPT.
+ */
+long long spt_num_settled(SPT *spt) {
+    return spt->num_settled;
+}
+
+
+/**
+ * Returns the number of edges relaxed by the algorithm that built the SPT.
+ */
+long long spt_num_relaxed(SPT *spt) {
+    return spt->num_relaxed;
 }
 
 
@@ -181,20 +242,22 @@ double spt_path_dist(SPT *spt, int v) {
  * update our data structures to indicate that to be the case (Sedgewick & Wayne, 
  * 2011). 
  *      Either the edge is ineligible, an no changes are made, or the edge v->w 
- * leads to a shorter path to w, in which case the SPT object is updated.
+ * leads to a shorter path to w, in which case the SPT object is updated (only
+ * v and the weight are recorded; no memory is allocated).
  * 
- * @param e a pointer to the edge.
  * @param spt the SPT object with the relevant data structures.
+ * @param v the edge's tail.
+ * @param w the edge's head.
+ * @param weight the edge's weight.
  */
-static bool relax_edge(Edge *e, SPT *spt) 
+static inline bool relax(SPT *spt, int v, int w, double weight) 
 {   
-    int v = edge_source(e), w = edge_dest(e);
-    double current_dist = spt->dist_to[w],
-           new_dist = edge_weight(e) + spt->dist_to[v];
+    double new_dist = weight + spt->dist_to[v];
+    spt->num_relaxed++;
 
-    if(new_dist < current_dist) {
-        free(spt->edge_to[w]);
-        spt->edge_to[w] = copy_edge(e);
+    if(new_dist < spt->dist_to[w]) {
+        spt->parent[w] = v;
+        spt->parent_weight[w] = weight;
         spt->dist_to[w] = new_dist;
         return true;
     }
@@ -203,6 +266,71 @@ static bool relax_edge(Edge *e, SPT *spt)
 }
 
 
+/**
+ * Relaxes an edge of the graph (see relax()). Auxiliary function.
+ */
+static inline bool relax_edge(Edge *e, SPT *spt) {
+    return relax(spt, edge_source(e), edge_dest(e), edge_weight(e));
+}
+
+
+/**
+ *      Cursor over the edges leaving a vertex of either a graph or a CSR 
+ * snapshot, so that the searches offered for both (see dijkstra_sp_int(), 
+ * bellman_ford_sp() and delta_stepping_sp()) share a single body.
+ */
+typedef struct {
+    EdgeIter it;            // used when scanning a graph
+    const int *targets;     // the snapshot's arrays; NULL when scanning a graph
+    const double *weights;
+    int pos, end;
+} EdgeScan;
+
+
+/**
+ * Starts a scan of the edges leaving v, in the snapshot csr if it isn't NULL or
+ * in the graph g otherwise. Auxiliary function.
+ */
+static inline EdgeScan scan_begin(Graph *g, CSRGraph *csr, int v)
+{
+    EdgeScan sc = {0};
+    if(csr != NULL) {
+        sc.targets = csr_targets(csr);
+        sc.weights = csr_weights(csr);
+        sc.pos = csr_offsets(csr)[v];
+        sc.end = csr_offsets(csr)[v + 1];
+    }
+    else
+        sc.it = graph_edges_begin(g, v);
+
+    return sc;
+}
+
+
+/**
+ * Stores the head and the weight of the next edge of the scan in w and weight.
+ * Returns false (and changes nothing) if there are no edges left. Auxiliary
+ * function.
+ */
+static inline bool scan_next(EdgeScan *sc, int *w, double *weight)
+{
+    if(sc->targets != NULL) {
+        if(sc->pos == sc->end)
+            return false;
+        *w = sc->targets[sc->pos];
+        *weight = sc->weights[sc->pos++];
+        return true;
+    }
+
+    Edge *e;
+    if(!edge_next(&sc->it, &e))
+        return false;
+    *w = edge_dest(e);
+    *weight = edge_weight(e);
+    return true;
+}
+
+
 /**
  * Pops the lowest key from the set. Auxiliary function.
  */
@@ -224,20 +352,18 @@ static int pop_lowest_key(bool *set, SPT *spt)
 
 
 /**
- *      Implements Dijkstra's shortest-paths algorithm using an unoreded list.
- * Although modern implementations of the algorithm use heap-based priority 
- * queues, the original algorithm used an unordered set (here represented by an
- * unordered list) and linear search.
- * 
- * @todo: implement the algorithm using a heap-based priority queue, reducing 
- * the running time complexity from O(|V|^2) to O(|E|log|V|).
+ *      Implements Dijkstra's shortest-paths algorithm as it was originally 
+ * described: an unordered set (here represented by an array of flags) and 
+ * linear search, which gives a running time of O(|V|^2). It's 
+ * kept for reference and for comparison with dijkstra_sp(); it might still be 
+ * competitive on very dense graphs.
  * 
  * @param g a pointer to the graph (expects a weighted digraph).
  * @param s the identifier (index) of the source vertex.
  * @return a pointer to a SPT object with relevant informations obtained from
  * the pathfinding algorithm.
  */
-SPT* dijkstra_sp(Graph *g, int s)
+SPT* dijkstra_sp_linear(Graph *g, int s)
 {
     SPT *spt = spt_create(graph_array_size(g), s);
     bool *set = calloc(sizeof(bool), graph_array_size(g));
@@ -248,24 +374,2052 @@ SPT* dijkstra_sp(Graph *g, int s)
     while(count > 0) {
         int v = pop_lowest_key(set, spt);
         count--;
+        spt->num_settled++;
 
         // relaxes the vertex
-        Edge **edges = edges_from_vertix(g, v);
-        if(edges != NULL) {
-            for(int e = 0; e < vertex_adj_size(g, v); e++) {
-                bool relaxed = relax_edge(edges[e], spt);
-                int w = edge_dest(edges[e]);
-
-                if(relaxed && !set[w]) {
-                    set[w] = true;
-                    count++;
-                }
-                free(edges[e]);
+        Edge *e;
+        EdgeIter it = graph_edges_begin(g, v);
+        while(edge_next(&it, &e)) {
+            int w = edge_dest(e);
+            if(relax_edge(e, spt) && !set[w]) {
+                set[w] = true;
+                count++;
             }
-            free(edges);
         }
     }
 
     free(set);
     return spt;
 }
+
+
+/**
+ *      Heap-based search shared by dijkstra_sp() and astar_sp(). The vertices 
+ * are popped from an indexed d-ary min-heap (see indexed_heap.h) keyed by the 
+ * vertices' indices; the priority of a vertex v is its current distance from 
+ * the source plus h(v), so the search is guided towards the target when a 
+ * heuristic is given. Whenever an edge v->w is relaxed, w is either inserted 
+ * into the heap (again, if it had already been settled, which might happen 
+ * with heuristics that aren't consistent) or has its key decreased. Auxiliary 
+ * function.
+ * 
+ * @param g a pointer to the graph.
+ * @param s the identifier (index) of the source vertex.
+ * @param t the search stops once this vertex is settled; pass -1 to build the 
+ * whole tree.
+ * @param h the heuristic or NULL, for plain Dijkstra.
+ * @param ctx the context passed to h.
+ * @return a pointer to the SPT or NULL if the memory couldn't be allocated.
+ */
+static SPT* heap_search(Graph *g, int s, int t, double (*h)(int v, void *ctx), void *ctx)
+{
+    SPT *spt = spt_create(graph_array_size(g), s);
+    if(spt == NULL)
+        return NULL;
+
+    IndexedHeap *pq = iheap_create(graph_array_size(g));
+    if(pq == NULL) {
+        spt_free(&spt);
+        return NULL;
+    }
+
+    iheap_insert(pq, spt->source, (h != NULL) ? h(s, ctx) : 0);
+    while(!iheap_empty(pq)) {
+        int v = iheap_pop_min(pq);
+        spt->num_settled++;
+        if(v == t)
+            break;
+
+        // relaxes the vertex
+        Edge *e;
+        EdgeIter it = graph_edges_begin(g, v);
+        while(edge_next(&it, &e)) {
+            if(relax_edge(e, spt)) {
+                int w = edge_dest(e);
+                double key = spt->dist_to[w] + ((h != NULL) ? h(w, ctx) : 0);
+                if(iheap_contains(pq, w))
+                    iheap_decrease_key(pq, w, key);
+                else
+                    iheap_insert(pq, w, key);
+            }
+        }
+    }
+
+    iheap_free(&pq);
+    return spt;
+}
+
+
+/**
+ *      Implements Dijkstra's shortest-paths algorithm using an indexed d-ary 
+ * min-heap (see indexed_heap.h) as the priority queue. The heap is keyed by the 
+ * vertices' indices and each vertex's priority is its current distance from 
+ * the source; whenever an edge v->w is relaxed, w is either inserted into the 
+ * heap or has its key decreased. The running time is O(|E|log|V|).
+ * 
+ * @param g a pointer to the graph (expects a weighted digraph).
+ * @param s the identifier (index) of the source vertex.
+ * @return a pointer to a SPT object with relevant informations obtained from
+ * the pathfinding algorithm or NULL if the memory couldn't be allocated.
+ */
+SPT* dijkstra_sp(Graph *g, int s) {
+    return heap_search(g, s, -1, NULL, NULL);
+}
+
+
+/**
+ *      Implements the A* search algorithm: Dijkstra's algorithm with the 
+ * priority of each vertex v being its distance from the source plus h(v), an 
+ * estimate of the distance from v to the target t. The search stops as soon as
+ * t is settled. If the heuristic is admissible (it never overestimates the 
+ * distance to t), the path found to t is a shortest path; if it's also 
+ * consistent (h(v) <= weight(v->w) + h(w) for every edge), no vertex is 
+ * settled more than once. The better the estimates, the fewer vertices are 
+ * settled (see spt_num_settled() and spt_num_relaxed()); with h = NULL the 
+ * search is just Dijkstra's algorithm stopping at t.
+ * 
+ *      Only the distances and paths to t and to the vertices settled before it 
+ * are guaranteed to be the shortest ones in the returned SPT.
+ * 
+ * @param g a pointer to the graph (expects a weighted digraph).
+ * @param s the identifier (index) of the source vertex.
+ * @param t the identifier (index) of the target vertex.
+ * @param h the heuristic: returns a lower bound of the distance from v to t; 
+ * it receives ctx (where, for example, the vertices' coordinates might be).
+ * @param ctx pointer passed to h in every call.
+ * @return a pointer to a SPT object with relevant informations obtained from
+ * the pathfinding algorithm or NULL if the memory couldn't be allocated.
+ */
+SPT* astar_sp(Graph *g, int s, int t, double (*h)(int v, void *ctx), void *ctx) {
+    return heap_search(g, s, t, h, ctx);
+}
+
+
+/**
+ *      Same as heap_search(), but on a CSR snapshot of the graph: the edges are 
+ * read straight from the snapshot's flat arrays. Auxiliary function.
+ */
+static SPT* heap_search_csr(CSRGraph *csr, int s, int t, double (*h)(int v, void *ctx), void *ctx)
+{
+    SPT *spt = spt_create(csr_size(csr), s);
+    if(spt == NULL)
+        return NULL;
+
+    IndexedHeap *pq = iheap_create(csr_size(csr));
+    if(pq == NULL) {
+        spt_free(&spt);
+        return NULL;
+    }
+
+    const int *offsets = csr_offsets(csr), *targets = csr_targets(csr);
+    const double *weights = csr_weights(csr);
+
+    iheap_insert(pq, spt->source, (h != NULL) ? h(s, ctx) : 0);
+    while(!iheap_empty(pq)) {
+        int v = iheap_pop_min(pq);
+        spt->num_settled++;
+        if(v == t)
+            break;
+
+        // relaxes the vertex
+        for(int e = offsets[v]; e < offsets[v + 1]; e++) {
+            int w = targets[e];
+            if(relax(spt, v, w, weights[e])) {
+                double key = spt->dist_to[w] + ((h != NULL) ? h(w, ctx) : 0);
+                if(iheap_contains(pq, w))
+                    iheap_decrease_key(pq, w, key);
+                else
+                    iheap_insert(pq, w, key);
+            }
+        }
+    }
+
+    iheap_free(&pq);
+    return spt;
+}
+
+
+/**
+ *      Same as dijkstra_sp(), but runs on a CSR snapshot of the graph (see 
+ * graph_freeze()), whose contiguous arrays make the edge scans much cheaper. 
+ * Meant for graphs that are built once and then queried many times.
+ * 
+ * @param csr a pointer to the snapshot.
+ * @param s the identifier (index) of the source vertex.
+ * @return a pointer to a SPT object with relevant informations obtained from
+ * the pathfinding algorithm or NULL if the memory couldn't be allocated.
+ */
+SPT* dijkstra_sp_csr(CSRGraph *csr, int s) {
+    return heap_search_csr(csr, s, -1, NULL, NULL);
+}
+
+
+/**
+ *      Same as astar_sp(), but runs on a CSR snapshot of the graph (see 
+ * graph_freeze()).
+ * 
+ * @param csr a pointer to the snapshot.
+ * @param s the identifier (index) of the source vertex.
+ * @param t the identifier (index) of the target vertex.
+ * @param h the heuristic (see astar_sp()) or NULL.
+ * @param ctx pointer passed to h in every call.
+ * @return a pointer to a SPT object with relevant informations obtained from
+ * the pathfinding algorithm or NULL if the memory couldn't be allocated.
+ */
+SPT* astar_sp_csr(CSRGraph *csr, int s, int t, double (*h)(int v, void *ctx), void *ctx) {
+    return heap_search_csr(csr, s, t, h, ctx);
+}
+
+
+/**
+ *      Binary min-heap of (distance, key) pairs with lazy deletion: instead of 
+ * having its priority decreased, a key is pushed again, and the stale pairs 
+ * are skipped by the caller when popped. Unlike the indexed heap, nothing in 
+ * it is proportional to the number of possible keys, so it's cheap to set up 
+ * for searches that only touch a small part of the graph.
+ */
+typedef struct {
+    struct LazyHeapItem {
+        double dist;
+        int key;
+    } *items;
+    int size, capacity;
+} LazyHeap;
+
+
+/**
+ * Initializes an empty lazy heap. Returns false if the memory couldn't be 
+ * allocated.
+ */
+static bool lheap_init(LazyHeap *h)
+{
+    h->size = 0;
+    h->capacity = 16;
+    h->items = malloc(sizeof(*h->items) * h->capacity);
+    return h->items != NULL;
+}
+
+
+/**
+ * Pushes a (distance, key) pair into the lazy heap.
+ */
+static bool lheap_push(LazyHeap *h, double dist, int key)
+{
+    if(h->size == h->capacity) {
+        int capacity = 2 * h->capacity;
+        struct LazyHeapItem *items = realloc(h->items, sizeof(*items) * capacity);
+        if(items == NULL)
+            return false;
+        h->items = items;
+        h->capacity = capacity;
+    }
+
+    int i = h->size++;
+    while(i > 0 && h->items[(i - 1) / 2].dist > dist) {
+        h->items[i] = h->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    h->items[i] = (struct LazyHeapItem) {dist, key};
+    return true;
+}
+
+
+/**
+ * Pops the pair with the lowest distance from the lazy heap (which must not be
+ * empty).
+ */
+static struct LazyHeapItem lheap_pop(LazyHeap *h)
+{
+    struct LazyHeapItem top = h->items[0], last = h->items[--h->size];
+    int i = 0, n = h->size;
+    while(2 * i + 1 < n) {
+        int child = 2 * i + 1;
+        if(child + 1 < n && h->items[child + 1].dist < h->items[child].dist)
+            child++;
+        if(h->items[child].dist >= last.dist)
+            break;
+        h->items[i] = h->items[child];
+        i = child;
+    }
+    if(n > 0)
+        h->items[i] = last;
+    return top;
+}
+
+
+/**
+ *      State of a search of dijkstra_sp_bounded(). Only the vertices reached by
+ * the search have an entry: the map of the sparse SPT gives the position of 
+ * each of them in the SPT's arrays, in vertex and in flags. The priority queue
+ * holds (distance, position) pairs.
+ */
+typedef struct {
+    SPT *spt;
+    int num_touched, capacity;
+    int *vertex;                // the vertex at each position
+    unsigned char *flags;       // BOUNDED_SETTLED and BOUNDED_TARGET
+    LazyHeap pq;
+} BoundedSearch;
+
+#define BOUNDED_SETTLED 1
+#define BOUNDED_TARGET 2
+
+
+/**
+ *      Returns the position of the vertex v in the arrays of the search, 
+ * creating an entry (with infinite distance) if v wasn't reached yet. 
+ * Auxiliary function of dijkstra_sp_bounded().
+ * 
+ * @return the position or -1 if the memory couldn't be allocated.
+ */
+static int bounded_touch(BoundedSearch *bs, int v)
+{
+    SPT *spt = bs->spt;
+    int pos = vmap_get(spt->index, v);
+    if(pos >= 0)
+        return pos;
+
+    if(bs->num_touched == bs->capacity) {
+        int capacity = 2 * bs->capacity;
+        double *dist_to = realloc(spt->dist_to, sizeof(double) * capacity);
+        if(dist_to != NULL)  spt->dist_to = dist_to;
+        double *parent_weight = realloc(spt->parent_weight, sizeof(double) * capacity);
+        if(parent_weight != NULL)  spt->parent_weight = parent_weight;
+        int *parent = realloc(spt->parent, sizeof(int) * capacity);
+        if(parent != NULL)  spt->parent = parent;
+        int *vertex = realloc(bs->vertex, sizeof(int) * capacity);
+        if(vertex != NULL)  bs->vertex = vertex;
+        unsigned char *flags = realloc(bs->flags, capacity);
+        if(flags != NULL)  bs->flags = flags;
+
+        if(dist_to == NULL || parent_weight == NULL || parent == NULL || vertex == NULL || flags == NULL)
+            return -1;
+        bs->capacity = capacity;
+    }
+
+    pos = bs->num_touched;
+    if(!vmap_put(spt->index, v, pos))
+        return -1;
+
+    bs->num_touched++;
+    spt->dist_to[pos] = INFINITY;
+    spt->parent[pos] = -1;
+    bs->vertex[pos] = v;
+    bs->flags[pos] = 0;
+    return pos;
+}
+
+
+/**
+ *      Dijkstra's algorithm that stops early: as soon as all the given targets 
+ * are settled or once no vertex within max_dist of the source is left in the 
+ * priority queue (edges leading farther than max_dist aren't even relaxed). 
+ * Meant for queries that only need a few distances or the vertices around the 
+ * source (e.g. the facilities close to a point).
+ * 
+ *      The cost of the call only depends on the part of the graph the search 
+ * reaches: nothing proportional to |V| is allocated or initialized. Instead of
+ * arrays indexed by the vertices, the returned SPT is sparse: it only holds 
+ * the vertices reached by the search, found through a hash map (see 
+ * vertex_map.h), and the other vertices are reported as unreachable. The 
+ * queries on it (spt_path_dist(), spt_path_to(), ...) work as usual, though 
+ * each one costs a hash lookup.
+ * 
+ *      The distances (and paths) to the targets and to every vertex settled by
+ * the search are the shortest ones; the others are upper bounds. If no targets
+ * are given, every vertex within max_dist of the source is settled. Negative 
+ * weights are not supported.
+ * 
+ * @param g a pointer to the graph (expects a weighted digraph).
+ * @param s the identifier (index) of the source vertex.
+ * @param targets the vertices whose distances are needed (identifiers that 
+ * aren't vertices of g are ignored); can be NULL if ntargets is 0.
+ * @param ntargets the number of targets; if it's 0, the search only stops at 
+ * max_dist.
+ * @param max_dist the greatest distance of interest; INFINITY for no bound.
+ * @return a pointer to the (sparse) SPT or NULL if s isn't a vertex of g or if
+ * the memory couldn't be allocated.
+ */
+SPT* dijkstra_sp_bounded(Graph *g, int s, const int *targets, int ntargets, double max_dist)
+{
+    if(!graph_has_vertex(g, s))
+        return NULL;
+
+    BoundedSearch bs = {0};
+    bs.capacity = 16;
+    bs.spt = malloc(sizeof(SPT));
+    SPT *spt = bs.spt;
+    if(spt == NULL)
+        return NULL;
+
+    spt->size = graph_array_size(g);
+    spt->source = s;
+    spt->cycle_vertex = -1;
+    spt->num_settled = spt->num_relaxed = 0;
+    spt->index = vmap_create(bs.capacity);
+    spt->dist_to = malloc(sizeof(double) * bs.capacity);
+    spt->parent_weight = malloc(sizeof(double) * bs.capacity);
+    spt->parent = malloc(sizeof(int) * bs.capacity);
+    bs.vertex = malloc(sizeof(int) * bs.capacity);
+    bs.flags = malloc(bs.capacity);
+
+    bool ok = spt->index != NULL && spt->dist_to != NULL && spt->parent_weight != NULL 
+              && spt->parent != NULL && bs.vertex != NULL && bs.flags != NULL && lheap_init(&bs.pq);
+    int source_pos = ok ? bounded_touch(&bs, s) : -1;
+    ok = source_pos >= 0 && lheap_push(&bs.pq, 0, source_pos);
+    if(ok)
+        spt->dist_to[source_pos] = 0;
+
+    // the targets are given entries up front, so that they can be recognized
+    int targets_left = 0;
+    for(int i = 0; ok && i < ntargets; i++) {
+        if(!graph_has_vertex(g, targets[i]))
+            continue;
+        int pos = bounded_touch(&bs, targets[i]);
+        if(pos < 0)
+            ok = false;
+        else if(!(bs.flags[pos] & BOUNDED_TARGET)) {
+            bs.flags[pos] |= BOUNDED_TARGET;
+            targets_left++;
+        }
+    }
+    bool stop_at_targets = ntargets > 0;
+
+    while(ok && bs.pq.size > 0 && (!stop_at_targets || targets_left > 0)) {
+        struct LazyHeapItem top = lheap_pop(&bs.pq);
+        int pos = top.key;
+        if((bs.flags[pos] & BOUNDED_SETTLED) || top.dist > spt->dist_to[pos])
+            continue;   // stale pair
+
+        bs.flags[pos] |= BOUNDED_SETTLED;
+        spt->num_settled++;
+        if(bs.flags[pos] & BOUNDED_TARGET)
+            targets_left--;
+
+        // relaxes the vertex
+        int v = bs.vertex[pos];
+        Edge *e;
+        EdgeIter it = graph_edges_begin(g, v);
+        while(ok && edge_next(&it, &e)) {
+            double new_dist = top.dist + edge_weight(e);
+            spt->num_relaxed++;
+            if(new_dist > max_dist)
+                continue;
+
+            int w_pos = bounded_touch(&bs, edge_dest(e));
+            if(w_pos < 0)
+                ok = false;
+            else if(new_dist < spt->dist_to[w_pos]) {
+                spt->dist_to[w_pos] = new_dist;
+                spt->parent[w_pos] = v;
+                spt->parent_weight[w_pos] = edge_weight(e);
+                ok = lheap_push(&bs.pq, new_dist, w_pos);
+            }
+        }
+    }
+
+    free(bs.vertex);
+    free(bs.flags);
+    free(bs.pq.items);
+    if(!ok)
+        spt_free(&spt);
+    return spt;
+}
+
+
+/**
+ *      Checks whether a SPT can be repaired after a change to the edge v->w. 
+ * Auxiliary function of spt_apply_edge_update() and spt_apply_edge_insert().
+ */
+static bool spt_can_update(SPT *spt, Graph *g, int v, int w, double weight) {
+    return spt->index == NULL && spt->cycle_vertex == -1 && weight >= 0 
+           && graph_array_size(g) <= spt->size && graph_has_vertex(g, v) && graph_has_vertex(g, w);
+}
+
+
+/**
+ *      Dijkstra's algorithm over an existing SPT, starting from the vertices in
+ * the heap (whose distances just decreased): the edges of each vertex popped 
+ * are relaxed and the vertices whose distances decrease are pushed. The stale
+ * pairs are skipped. Auxiliary function of the SPT update functions.
+ */
+static bool spt_propagate(SPT *spt, Graph *g, LazyHeap *pq)
+{
+    while(pq->size > 0) {
+        struct LazyHeapItem top = lheap_pop(pq);
+        int v = top.key;
+        if(top.dist > spt->dist_to[v])
+            continue;   // stale pair
+        spt->num_settled++;
+
+        Edge *e;
+        EdgeIter it = graph_edges_begin(g, v);
+        while(edge_next(&it, &e)) {
+            int w = edge_dest(e);
+            if(relax_edge(e, spt) && !lheap_push(pq, spt->dist_to[w], w))
+                return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ *      Repairs the SPT after the edge v->w got the weight weight, if that made
+ * the path through the edge shorter than the one known to w (the decrease 
+ * phase of Ramalingam and Reps' algorithm). Only the vertices whose distances 
+ * decrease are visited. Auxiliary function.
+ */
+static bool spt_decrease(SPT *spt, Graph *g, int v, int w, double weight)
+{
+    double new_dist = spt->dist_to[v] + weight;
+    spt->num_relaxed++;
+    if(!(new_dist < spt->dist_to[w]))
+        return true;    // the tree doesn't change
+
+    spt->dist_to[w] = new_dist;
+    spt->parent[w] = v;
+    spt->parent_weight[w] = weight;
+
+    LazyHeap pq;
+    bool ok = lheap_init(&pq) && lheap_push(&pq, new_dist, w) && spt_propagate(spt, g, &pq);
+    free(pq.items);
+    return ok;
+}
+
+
+/**
+ *      Repairs a shortest paths tree after the insertion of the edge v->w, 
+ * which must already be in the graph, instead of building the tree again. The
+ * edge can only make paths shorter, so just the vertices whose distances 
+ * decrease (the ones that now have a shortest path through the edge) are 
+ * visited, in the order of their new distances (Ramalingam and Reps, 1996).
+ * 
+ *      The tree must be a whole shortest paths tree of the graph before the 
+ * insertion (e.g. built by dijkstra_sp(), not by astar_sp() or 
+ * dijkstra_sp_bounded()). Negative weights are not supported. After the call,
+ * spt_num_settled() and spt_num_relaxed() count the work of the repair.
+ * 
+ * @param spt a pointer to the SPT.
+ * @param g a pointer to the graph, with the new edge.
+ * @param v the edge's tail.
+ * @param w the edge's head.
+ * @param weight the edge's weight.
+ * @return true if the tree was repaired; false if the tree can't be repaired 
+ * (it's sparse or has a negative cycle, the graph has grown beyond the tree's 
+ * size, the edge's weight is negative or v or w isn't a vertex of g) or if the
+ * memory couldn't be allocated (in which case the tree must be built again).
+ */
+bool spt_apply_edge_insert(SPT *spt, Graph *g, int v, int w, double weight)
+{
+    if(!spt_can_update(spt, g, v, w, weight))
+        return false;
+
+    spt->num_settled = spt->num_relaxed = 0;
+    return spt_decrease(spt, g, v, w, weight);
+}
+
+
+/**
+ *      Repairs a shortest paths tree after the weight of the edge v->w changed
+ * (see graph_set_edge_weight(); the graph must already have the new weight), 
+ * instead of building the tree again. Ramalingam and Reps' approach is used 
+ * (Ramalingam and Reps, 1996):
+ *      . if the weight decreased, or if the edge isn't in the tree, only the 
+ *      vertices whose distances decrease are visited (see 
+ *      spt_apply_edge_insert());
+ *      . if the weight of an edge of the tree increased, the subtree below w 
+ *      (the vertices whose shortest paths go through the edge) is detached. 
+ *      Each vertex of the subtree then gets the best path through its edges 
+ *      coming from outside of the subtree and Dijkstra's algorithm runs only 
+ *      among them. The rest of the tree isn't touched.
+ *      The edges arriving at the subtree are found with graph_in_edges() if the 
+ *      graph's in-edge index is enabled; otherwise, all the edges of the graph 
+ *      are scanned once (still without a priority queue for the whole graph).
+ * 
+ *      The tree must be a whole shortest paths tree of the graph before the 
+ * change (e.g. built by dijkstra_sp(), not by astar_sp() or 
+ * dijkstra_sp_bounded()). Negative weights are not supported. After the call,
+ * spt_num_settled() and spt_num_relaxed() count the work of the repair.
+ * 
+ * @param spt a pointer to the SPT.
+ * @param g a pointer to the graph, with the new weight.
+ * @param v the edge's tail.
+ * @param w the edge's head.
+ * @param new_weight the edge's new weight.
+ * @return true if the tree was repaired; false if it can't be repaired (see 
+ * spt_apply_edge_insert()) or if the memory couldn't be allocated (in which 
+ * case the tree must be built again).
+ */
+bool spt_apply_edge_update(SPT *spt, Graph *g, int v, int w, double new_weight)
+{
+    if(!spt_can_update(spt, g, v, w, new_weight))
+        return false;
+
+    spt->num_settled = spt->num_relaxed = 0;
+    if(spt->parent[w] != v || new_weight <= spt->parent_weight[w])
+        return spt_decrease(spt, g, v, w, new_weight);  // only a decrease can change the tree
+
+    /* Detaching the subtree below w (its vertices are the children of its vertices) */
+    int size = 1, capacity = 16;
+    int *subtree = malloc(sizeof(int) * capacity);
+    if(subtree == NULL)
+        return false;
+
+    subtree[0] = w;
+    spt->parent[w] = -1;
+    for(int i = 0; i < size; i++) {
+        int x = subtree[i];
+        Edge *e;
+        EdgeIter it = graph_edges_begin(g, x);
+        while(edge_next(&it, &e)) {
+            int u = edge_dest(e);
+            if(spt->parent[u] != x)
+                continue;
+
+            if(size == capacity) {
+                int *new_subtree = realloc(subtree, sizeof(int) * 2 * capacity);
+                if(new_subtree == NULL) {
+                    free(subtree);
+                    return false;
+                }
+                subtree = new_subtree;
+                capacity *= 2;
+            }
+            spt->parent[u] = -1;
+            subtree[size++] = u;
+        }
+    }
+    for(int i = 0; i < size; i++)
+        spt->dist_to[subtree[i]] = INFINITY;
+
+    /* Best paths from outside of the subtree */
+    Edge *e;
+    if(graph_has_in_edges(g)) {
+        for(int i = 0; i < size; i++) {
+            EdgeIter it = graph_in_edges(g, subtree[i]);
+            while(edge_next(&it, &e))
+                relax(spt, edge_source(e), subtree[i], edge_weight(e));
+        }
+    }
+    else {
+        for(int p = 0; p < spt->size; p++) {
+            if(!graph_has_vertex(g, p) || isinf(spt->dist_to[p]))
+                continue;
+            EdgeIter it = graph_edges_begin(g, p);
+            while(edge_next(&it, &e))
+                relax_edge(e, spt);     // only the subtree's vertices can improve
+        }
+    }
+
+    LazyHeap pq;
+    bool ok = lheap_init(&pq);
+    for(int i = 0; ok && i < size; i++) {
+        if(!isinf(spt->dist_to[subtree[i]]))
+            ok = lheap_push(&pq, spt->dist_to[subtree[i]], subtree[i]);
+    }
+    ok = ok && spt_propagate(spt, g, &pq);
+
+    free(pq.items);
+    free(subtree);
+    return ok;
+}
+
+
+/**
+ *      Reusable state of Dijkstra's algorithm, allocated once and used by many
+ * searches (see spw_create()).
+ * 
+ * Attributes:
+ *      . capacity: the size of the arrays (the graphs searched can't be larger;
+ *      if they are, the arrays grow).
+ *      . dist_to, parent, parent_weight: same as in the SPT, but the entry of 
+ *      a vertex v is only valid if stamp[v] equals version; the others stand 
+ *      for INFINITY and -1.
+ *      . target_stamp: target_stamp[v] equals version if v is one of the 
+ *      targets of the current search.
+ *      . version: the number of the current search. Incrementing it resets the
+ *      arrays in O(1); they are only cleared when it wraps around.
+ *      . pq: the priority queue, emptied at the end of every search.
+ *      . source, num_settled, num_relaxed: the source of the last search and
+ *      the work it did.
+ */
+struct ShortestPathsWorkspace {
+    int capacity, source;
+    double *dist_to, *parent_weight;
+    int *parent;
+    unsigned int *stamp, *target_stamp, version;
+    IndexedHeap *pq;
+    long long num_settled, num_relaxed;
+};
+
+
+/**
+ *      Creates a workspace for Dijkstra's algorithm. Searches run with it (see
+ * spw_dijkstra()) write their results into the workspace, which is reset in 
+ * O(1) at the start of each search, so nothing is allocated or initialized per
+ * query. A workspace must not be shared by threads running searches at the 
+ * same time (create one per thread).
+ * 
+ * @param size the expected size of the graphs' arrays of adjacency lists (see
+ * graph_array_size()); the workspace grows if a larger graph is searched.
+ * @return a pointer to the workspace or NULL if the memory couldn't be 
+ * allocated.
+ */
+SPWorkspace* spw_create(int size)
+{
+    SPWorkspace *ws = calloc(1, sizeof(SPWorkspace));
+    if(ws == NULL)
+        return NULL;
+
+    if(size < 1)
+        size = 1;
+    ws->capacity = size;
+    ws->source = -1;
+    ws->dist_to = malloc(sizeof(double) * size);
+    ws->parent_weight = malloc(sizeof(double) * size);
+    ws->parent = malloc(sizeof(int) * size);
+    ws->stamp = calloc(size, sizeof(unsigned int));
+    ws->target_stamp = calloc(size, sizeof(unsigned int));
+    ws->pq = iheap_create(size);
+
+    if(ws->dist_to == NULL || ws->parent_weight == NULL || ws->parent == NULL 
+            || ws->stamp == NULL || ws->target_stamp == NULL || ws->pq == NULL)
+        spw_free(&ws);
+    return ws;
+}
+
+
+/**
+ * Frees the memory allocated by a workspace.
+ * 
+ * @param ws a pointer to the variable that is holding a pointer to the 
+ * workspace; by the end of the call, the variable will be set to NULL.
+ */
+void spw_free(SPWorkspace **ws)
+{
+    free((*ws)->dist_to);
+    free((*ws)->parent_weight);
+    free((*ws)->parent);
+    free((*ws)->stamp);
+    free((*ws)->target_stamp);
+    if((*ws)->pq != NULL)
+        iheap_free(&(*ws)->pq);
+
+    free(*ws);
+    *ws = NULL;
+}
+
+
+/**
+ *      Makes the workspace's arrays hold, at least, size vertices. The 
+ * entries of the old arrays are kept. Auxiliary function.
+ * 
+ * @return false if the memory couldn't be allocated (the workspace stays 
+ * usable for graphs of its old size).
+ */
+static bool spw_reserve(SPWorkspace *ws, int size)
+{
+    if(size <= ws->capacity)
+        return true;
+
+    IndexedHeap *pq = iheap_create(size);
+    double *dist_to = realloc(ws->dist_to, sizeof(double) * size);
+    if(dist_to != NULL)  ws->dist_to = dist_to;
+    double *parent_weight = realloc(ws->parent_weight, sizeof(double) * size);
+    if(parent_weight != NULL)  ws->parent_weight = parent_weight;
+    int *parent = realloc(ws->parent, sizeof(int) * size);
+    if(parent != NULL)  ws->parent = parent;
+    unsigned int *stamp = realloc(ws->stamp, sizeof(unsigned int) * size);
+    if(stamp != NULL)  ws->stamp = stamp;
+    unsigned int *target_stamp = realloc(ws->target_stamp, sizeof(unsigned int) * size);
+    if(target_stamp != NULL)  ws->target_stamp = target_stamp;
+
+    if(pq == NULL || dist_to == NULL || parent_weight == NULL || parent == NULL 
+            || stamp == NULL || target_stamp == NULL) {
+        if(pq != NULL)
+            iheap_free(&pq);
+        return false;
+    }
+
+    memset(ws->stamp + ws->capacity, 0, sizeof(unsigned int) * (size - ws->capacity));
+    memset(ws->target_stamp + ws->capacity, 0, sizeof(unsigned int) * (size - ws->capacity));
+    iheap_free(&ws->pq);
+    ws->pq = pq;
+    ws->capacity = size;
+    return true;
+}
+
+
+/**
+ * Returns the distance of v recorded in the workspace (INFINITY if the entry
+ * of v isn't valid). Auxiliary function.
+ */
+static inline double spw_get_dist(SPWorkspace *ws, int v) {
+    return (ws->stamp[v] == ws->version) ? ws->dist_to[v] : INFINITY;
+}
+
+
+/**
+ *      Runs Dijkstra's algorithm on the workspace (see spw_create()), with the
+ * same early exits as dijkstra_sp_bounded(): the search stops as soon as all 
+ * the given targets are settled or once no vertex within max_dist of the 
+ * source is left in the priority queue. The results of the previous search 
+ * are discarded in O(1) and the new ones are read with spw_path_dist(), 
+ * spw_path_to(), etc. 
+ * 
+ *      The distances (and paths) to the targets and to every vertex settled by
+ * the search are the shortest ones; the others are upper bounds. Negative 
+ * weights are not supported.
+ * 
+ * @param ws a pointer to the workspace.
+ * @param g a pointer to the graph (expects a weighted digraph).
+ * @param s the identifier (index) of the source vertex.
+ * @param targets the vertices whose distances are needed (identifiers that 
+ * aren't vertices of g are ignored); can be NULL if ntargets is 0.
+ * @param ntargets the number of targets; if it's 0, the search only stops at 
+ * max_dist.
+ * @param max_dist the greatest distance of interest; INFINITY for no bound.
+ * @return true if the search was run; false if s isn't a vertex of g or if the
+ * workspace had to grow and the memory couldn't be allocated.
+ */
+bool spw_dijkstra_full(SPWorkspace *ws, Graph *g, int s, const int *targets, 
+                       int ntargets, double max_dist)
+{
+    if(!graph_has_vertex(g, s) || !spw_reserve(ws, graph_array_size(g)))
+        return false;
+
+    if(++ws->version == 0) {
+        // the stamps wrapped around: the old ones could be taken for valid
+        memset(ws->stamp, 0, sizeof(unsigned int) * ws->capacity);
+        memset(ws->target_stamp, 0, sizeof(unsigned int) * ws->capacity);
+        ws->version = 1;
+    }
+
+    ws->source = s;
+    ws->num_settled = ws->num_relaxed = 0;
+    ws->stamp[s] = ws->version;
+    ws->dist_to[s] = 0;
+    ws->parent[s] = -1;
+
+    int targets_left = 0;
+    for(int i = 0; i < ntargets; i++) {
+        int t = targets[i];
+        if(graph_has_vertex(g, t) && ws->target_stamp[t] != ws->version) {
+            ws->target_stamp[t] = ws->version;
+            targets_left++;
+        }
+    }
+    bool stop_at_targets = ntargets > 0;
+
+    iheap_insert(ws->pq, s, 0);
+    while(!iheap_empty(ws->pq) && (!stop_at_targets || targets_left > 0)) {
+        int v = iheap_pop_min(ws->pq);
+        ws->num_settled++;
+        if(ws->target_stamp[v] == ws->version)
+            targets_left--;
+
+        // relaxes the vertex
+        Edge *e;
+        EdgeIter it = graph_edges_begin(g, v);
+        while(edge_next(&it, &e)) {
+            int w = edge_dest(e);
+            double new_dist = ws->dist_to[v] + edge_weight(e);
+            ws->num_relaxed++;
+            if(new_dist > max_dist || new_dist >= spw_get_dist(ws, w))
+                continue;
+
+            ws->stamp[w] = ws->version;
+            ws->dist_to[w] = new_dist;
+            ws->parent[w] = v;
+            ws->parent_weight[w] = edge_weight(e);
+            if(iheap_contains(ws->pq, w))
+                iheap_decrease_key(ws->pq, w, new_dist);
+            else
+                iheap_insert(ws->pq, w, new_dist);
+        }
+    }
+
+    iheap_clear(ws->pq);    // only what's left in the queue is touched
+    return true;
+}
+
+
+/**
+ *      Runs Dijkstra's algorithm (the whole shortest paths tree) on the 
+ * workspace. Wrapper for the function spw_dijkstra_full().
+ * 
+ * @param ws a pointer to the workspace.
+ * @param g a pointer to the graph (expects a weighted digraph).
+ * @param s the identifier (index) of the source vertex.
+ * @return true if the search was run; false otherwise (see 
+ * spw_dijkstra_full()).
+ */
+bool spw_dijkstra(SPWorkspace *ws, Graph *g, int s) {
+    return spw_dijkstra_full(ws, g, s, NULL, 0, INFINITY);
+}
+
+
+/**
+ * Returns the source of the last search run on the workspace (-1 if none).
+ */
+int spw_source(SPWorkspace *ws) {
+    return ws->source;
+}
+
+
+/**
+ * Checks whether the last search run on the workspace found a path to v.
+ */
+bool spw_has_path(SPWorkspace *ws, int v) {
+    return v >= 0 && v < ws->capacity && !isinf(spw_get_dist(ws, v));
+}
+
+
+/**
+ *      Returns the weight of the path from the source of the last search to v
+ * (INFINITY if there is no path).
+ */
+double spw_path_dist(SPWorkspace *ws, int v) {
+    return (v >= 0 && v < ws->capacity) ? spw_get_dist(ws, v) : INFINITY;
+}
+
+
+/**
+ *      Returns a list with the edges from the source of the last search to the 
+ * vertex v (see spt_path_to()).
+ * 
+ * @param ws a pointer to the workspace.
+ * @param v the identifier (index) of the destination vertex.
+ * @return a list with the edges in the path from the source to v if such path
+ * exists; an empty list if v is the source vertex; NULL if there is no path.
+ */
+List* spw_path_to(SPWorkspace *ws, int v)
+{
+    if(!spw_has_path(ws, v))
+        return NULL;
+
+    List *path = list_create();
+    while(ws->parent[v] != -1) {
+        list_push(path, edge_create(ws->parent[v], v, ws->parent_weight[v]));
+        v = ws->parent[v];
+    }
+    return path;
+}
+
+
+/**
+ * Returns the number of vertices settled by the last search.
+ */
+long long spw_num_settled(SPWorkspace *ws) {
+    return ws->num_settled;
+}
+
+
+/**
+ * Returns the number of edges relaxed by the last search.
+ */
+long long spw_num_relaxed(SPWorkspace *ws) {
+    return ws->num_relaxed;
+}
+
+
+/**
+ *      Returns the greatest weight among the edges of the graph (or of the 
+ * snapshot, if csr isn't NULL) if all of them are non-negative integers; 
+ * otherwise, returns -1. Auxiliary function.
+ */
+static int max_int_weight(Graph *g, CSRGraph *csr)
+{
+    int max = 0, size = (csr != NULL) ? csr_size(csr) : graph_array_size(g);
+    for(int v = 0; v < size; v++) {
+        int x;
+        double w;
+        EdgeScan sc = scan_begin(g, csr, v);
+        while(scan_next(&sc, &x, &w)) {
+            if(w < 0 || w != floor(w) || w > SP_INT_MAX_WEIGHT)
+                return -1;
+            if(w > max)
+                max = (int) w;
+        }
+    }
+
+    return max;
+}
+
+
+/**
+ *      Dial's algorithm on the graph g or, if csr isn't NULL, on the snapshot 
+ * csr; the weights must be integers in [0, max_weight] (see dijkstra_sp_int()).
+ * Auxiliary function.
+ */
+static SPT* dial_search(Graph *g, CSRGraph *csr, int s, int max_weight)
+{
+    int size = (csr != NULL) ? csr_size(csr) : graph_array_size(g), 
+        num_buckets = max_weight + 1;
+
+    SPT *spt = spt_create(size, s);
+    int *bucket_head = malloc(sizeof(int) * num_buckets),
+        *next = malloc(sizeof(int) * size),
+        *prev = malloc(sizeof(int) * size),
+        *bucket_of = malloc(sizeof(int) * size);
+
+    if(spt == NULL || bucket_head == NULL || next == NULL || prev == NULL || bucket_of == NULL) {
+        if(spt != NULL)
+            spt_free(&spt);
+        free(bucket_head);  free(next);  free(prev);  free(bucket_of);
+        return NULL;
+    }
+
+    for(int b = 0; b < num_buckets; b++)
+        bucket_head[b] = -1;
+    for(int v = 0; v < size; v++)
+        bucket_of[v] = -1;
+
+    // the source is the only vertex in the bucket 0
+    bucket_head[0] = s;
+    next[s] = prev[s] = -1;
+    bucket_of[s] = 0;
+
+    int count = 1;          // number of vertices currently in the buckets
+    long long dist = 0;     // distance of the vertices in the current bucket
+    while(count > 0) {
+        int b = dist % num_buckets;
+        if(bucket_head[b] == -1) {
+            dist++;     // empty bucket; moves on to the next one
+            continue;
+        }
+
+        // pops a vertex from the current bucket
+        int v = bucket_head[b];
+        bucket_head[b] = next[v];
+        if(next[v] != -1)
+            prev[next[v]] = -1;
+        bucket_of[v] = -1;
+        count--;
+        spt->num_settled++;
+
+        // relaxes the vertex
+        int w;
+        double weight;
+        EdgeScan sc = scan_begin(g, csr, v);
+        while(scan_next(&sc, &w, &weight)) {
+            if(!relax(spt, v, w, weight))
+                continue;
+
+            // unlinks w from its current bucket
+            if(bucket_of[w] != -1) {
+                if(prev[w] != -1)
+                    next[prev[w]] = next[w];
+                else
+                    bucket_head[bucket_of[w]] = next[w];
+                if(next[w] != -1)
+                    prev[next[w]] = prev[w];
+                count--;
+            }
+
+            // links w at the head of its new bucket
+            int nb = ((long long) spt->dist_to[w]) % num_buckets;
+            prev[w] = -1;
+            next[w] = bucket_head[nb];
+            if(next[w] != -1)
+                prev[next[w]] = w;
+            bucket_head[nb] = w;
+            bucket_of[w] = nb;
+            count++;
+        }
+    }
+
+    free(bucket_head);  free(next);  free(prev);  free(bucket_of);
+    return spt;
+}
+
+
+/**
+ *      Implements Dial's variant of Dijkstra's algorithm, meant for graphs whose 
+ * edges have small non-negative integer weights. Instead of a heap, it uses a 
+ * circular array of C+1 buckets (C being the greatest edge weight), each 
+ * holding the vertices whose tentative distance from the source is congruent 
+ * to the bucket's index (mod C+1). Since every tentative distance lies in the 
+ * range [d, d + C], where d is the distance of the last settled vertex, each 
+ * bucket holds, at any time, only vertices with the same distance. Buckets are 
+ * doubly linked lists stored in flat arrays (indexed by the vertices), so both
+ * inserting a vertex and moving it to another bucket (decrease-key) are O(1) 
+ * operations and no comparisons between keys are needed. The running time is 
+ * O(|E| + |V|C).
+ * 
+ *      The weights are still read from the edges (stored as doubles), so the 
+ * returned SPT works with spt_path_to() and spt_path_dist() just like the one 
+ * returned by dijkstra_sp().
+ * 
+ * @param g a pointer to the graph (expects a weighted digraph).
+ * @param s the identifier (index) of the source vertex.
+ * @param max_weight the greatest weight among the graph's edges; all the 
+ * weights must be integers in the range [0, max_weight]. Pass a value lower 
+ * than 1 to have the function find it; in that case, if some weight isn't an 
+ * integer, is negative or is greater than SP_INT_MAX_WEIGHT, the function falls 
+ * back to dijkstra_sp().
+ * @return a pointer to a SPT object with relevant informations obtained from
+ * the pathfinding algorithm or NULL if the memory couldn't be allocated.
+ */
+SPT* dijkstra_sp_int(Graph *g, int s, int max_weight)
+{
+    if(max_weight < 1) {
+        max_weight = max_int_weight(g, NULL);
+        if(max_weight < 0)
+            return dijkstra_sp(g, s);   // the weights aren't small integers
+    }
+
+    return dial_search(g, NULL, s, max_weight);
+}
+
+
+/**
+ *      Same as dijkstra_sp_int(), but runs on a CSR snapshot of the graph (see 
+ * graph_freeze()). Falls back to dijkstra_sp_csr() if max_weight is lower 
+ * than 1 and the weights aren't small non-negative integers.
+ * 
+ * @param csr a pointer to the snapshot.
+ * @param s the identifier (index) of the source vertex.
+ * @param max_weight the greatest weight among the snapshot's edges (see 
+ * dijkstra_sp_int()).
+ * @return a pointer to a SPT object with relevant informations obtained from
+ * the pathfinding algorithm or NULL if the memory couldn't be allocated.
+ */
+SPT* dijkstra_sp_int_csr(CSRGraph *csr, int s, int max_weight)
+{
+    if(max_weight < 1) {
+        max_weight = max_int_weight(NULL, csr);
+        if(max_weight < 0)
+            return dijkstra_sp_csr(csr, s);
+    }
+
+    return dial_search(NULL, csr, s, max_weight);
+}
+
+
+
+/**
+ *      Searches for a cycle in the graph formed by the edges in spt->parent 
+ * (each vertex has at most one parent in it). Every cycle in that graph is a 
+ * negative cycle. Runs in O(|V|). Auxiliary function.
+ * 
+ * @return a vertex on the cycle, -1 if there is no cycle or -2 if the memory 
+ * couldn't be allocated.
+ */
+static int find_parent_cycle(SPT *spt)
+{
+    int *stamp = calloc(spt->size, sizeof(int));   // stamp[x] = 1 + the vertex from which x was reached
+    if(stamp == NULL)
+        return -2;
+
+    int found = -1;
+
+    for(int v = 0; v < spt->size && found == -1; v++) {
+        int x = v;
+        while(x != -1 && stamp[x] == 0) {
+            stamp[x] = v + 1;
+            x = spt->parent[x];
+        }
+
+        if(x != -1 && stamp[x] == v + 1)
+            found = x;  // walked back into the current chain: cycle
+    }
+
+    free(stamp);
+    return found;
+}
+
+
+/**
+ *      Queue-based Bellman-Ford on the graph g or, if csr isn't NULL, on the 
+ * snapshot csr (see bellman_ford_sp()). Auxiliary function.
+ */
+static SPT* spfa_search(Graph *g, CSRGraph *csr, int s)
+{
+    int size = (csr != NULL) ? csr_size(csr) : graph_array_size(g);
+    SPT *spt = spt_create(size, s);
+    int *queue = malloc(sizeof(int) * size);
+    bool *on_queue = calloc(size, sizeof(bool));
+
+    if(spt == NULL || queue == NULL || on_queue == NULL) {
+        if(spt != NULL)
+            spt_free(&spt);
+        free(queue);  free(on_queue);
+        return NULL;
+    }
+
+    int head = 0, count = 1;    // the queue starts with the source only
+    queue[head] = s;
+    on_queue[s] = true;
+
+    int relaxations = 0,     // successful relaxations since the last cycle check
+        num_vertices = (csr != NULL) ? csr_num_vertices(csr) : graph_num_vertices(g),
+        check_every = (num_vertices > 0) ? num_vertices : 1;
+
+    while(count > 0 && spt->cycle_vertex == -1) {
+        int v = queue[head];
+        head = (head + 1) % size;
+        count--;
+        on_queue[v] = false;
+        spt->num_settled++;
+
+        // relaxes the vertex
+        int w;
+        double weight;
+        EdgeScan sc = scan_begin(g, csr, v);
+        while(scan_next(&sc, &w, &weight)) {
+            if(relax(spt, v, w, weight)) {
+                if(!on_queue[w]) {
+                    queue[(head + count) % size] = w;
+                    on_queue[w] = true;
+                    count++;
+                }
+
+                if(++relaxations == check_every) {
+                    relaxations = 0;
+                    spt->cycle_vertex = find_parent_cycle(spt);
+                    if(spt->cycle_vertex != -1)
+                        break;
+                }
+            }
+        }
+    }
+
+    free(queue);  free(on_queue);
+    if(spt->cycle_vertex == -2)
+        spt_free(&spt);     // the cycle check couldn't run
+    return spt;
+}
+
+
+/**
+ *      Implements the queue-based Bellman-Ford algorithm (also known as SPFA). 
+ * Unlike Dijkstra's algorithm, it handles edges with negative weights. Instead 
+ * of relaxing every edge of the graph in each of |V| passes, it keeps a FIFO 
+ * queue (a ring buffer of vertex indices) of the vertices whose distance from 
+ * the source changed and only relaxes the edges leaving them; each vertex is 
+ * in the queue at most once at a time. The algorithm ends as soon as no 
+ * distance changes (the queue is empty), which in practice is much sooner than
+ * the O(|E||V|) worst case.
+ * 
+ *      If there is a negative cycle reachable from the source, the shortest 
+ * paths aren't defined and the relaxations would go on forever. To detect that,
+ * after every |V| successful relaxations the graph formed by the edges in 
+ * spt->parent is checked for a cycle (Sedgewick & Wayne, 2011); once one is 
+ * found, the algorithm stops and the cycle can be retrieved with 
+ * spt_negative_cycle(). In that case, the distances in the SPT are meaningless.
+ * 
+ * @param g a pointer to the graph (expects a weighted digraph).
+ * @param s the identifier (index) of the source vertex.
+ * @return a pointer to a SPT object with relevant informations obtained from
+ * the pathfinding algorithm or NULL if the memory couldn't be allocated.
+ */
+SPT* bellman_ford_sp(Graph *g, int s) {
+    return spfa_search(g, NULL, s);
+}
+
+
+/**
+ *      Same as bellman_ford_sp(), but runs on a CSR snapshot of the graph (see 
+ * graph_freeze()).
+ * 
+ * @param csr a pointer to the snapshot.
+ * @param s the identifier (index) of the source vertex.
+ * @return a pointer to a SPT object with relevant informations obtained from
+ * the pathfinding algorithm or NULL if the memory couldn't be allocated.
+ */
+SPT* bellman_ford_sp_csr(CSRGraph *csr, int s) {
+    return spfa_search(NULL, csr, s);
+}
+
+
+/**
+ * Checks whether a negative cycle reachable from the source was found (only 
+ * bellman_ford_sp() looks for them).
+ */
+bool spt_has_negative_cycle(SPT *spt) {
+    return spt->cycle_vertex != -1;
+}
+
+
+/**
+ *      Returns a list with the edges of the negative cycle found by 
+ * bellman_ford_sp(), in the order in which they are traversed. 
+ * 
+ * @param spt a pointer to a SPT.
+ * @return a list with the edges of the cycle (copies; it's the caller's 
+ * responsability to free them) or NULL if no negative cycle was found.
+ */
+List* spt_negative_cycle(SPT *spt)
+{
+    if(!spt_has_negative_cycle(spt))
+        return NULL;
+
+    List *cycle = list_create();
+    int v = spt->cycle_vertex;
+
+    do {
+        list_push(cycle, edge_create(spt->parent[v], v, spt->parent_weight[v]));
+        v = spt->parent[v];
+    } while(v != spt->cycle_vertex);
+
+    return cycle;
+}
+
+
+/**
+ * Growable array of integers. Auxiliary structure of delta_stepping_sp().
+ */
+typedef struct {
+    int *items;
+    int size, capacity;
+} IntVector;
+
+
+/**
+ *      Relaxation request generated by delta_stepping_sp(): the edge at the 
+ * position edge of the frozen arrays (see DeltaStepping) leads from the vertex
+ * from to the vertex to with a distance dist from the source.
+ */
+typedef struct {
+    int to, from, edge;
+    double dist;
+} RelaxRequest;
+
+
+/**
+ * Growable array of relaxation requests. Auxiliary structure of 
+ * delta_stepping_sp().
+ */
+typedef struct {
+    RelaxRequest *items;
+    int size, capacity;
+} RequestVector;
+
+
+/**
+ *      State shared by the threads running delta_stepping_sp(). 
+ * 
+ * Attributes:
+ *      . size, max_threads, delta: number of vertices (size of the graph's 
+ *      array), number of threads requested (the per-thread arrays below are 
+ *      sized for it) and width of the buckets.
+ *      . offset, split, to, weight: frozen copy of the graph's edges, grouped 
+ *      by their tails; the edges leaving v are at the positions 
+ *      [offset[v], offset[v+1]) of the arrays to (heads) and weight; the light 
+ *      edges (weight <= delta) come first and the heavy ones start at split[v].
+ *      . dist, pred, pred_edge: tentative distance of each vertex and the tail 
+ *      and position (in the frozen arrays) of the edge that led to it (-1 if 
+ *      none).
+ *      . work, work_size, heavy: the vertices whose edges are relaxed in the 
+ *      current phase and whether the heavy edges (instead of the light ones) 
+ *      should be relaxed.
+ *      . requests: max_threads^2 vectors; with T = team.nthreads threads 
+ *      running, requests[p*T + o] holds the requests generated by the thread p
+ *      for the vertices owned by the thread o (the vertex w is owned by the 
+ *      thread w % T).
+ *      . moved: one vector per thread with the vertices whose distances were 
+ *      lowered by it in the current phase.
+ *      . team, stop: the threads running the search (see thread_team.h); the 
+ *      workers quit once stop is set.
+ *      . failed: set (atomically) by any thread that couldn't grow one of the 
+ *      vectors; once set, the phases stop early and the search is abandoned.
+ */
+typedef struct {
+    int size, max_threads;
+    double delta;
+
+    int *offset, *split, *to;
+    double *weight;
+
+    double *dist;
+    int *pred, *pred_edge;
+
+    int *work, work_size;
+    bool heavy;
+
+    RequestVector *requests;
+    IntVector *moved;
+
+    ThreadTeam team;
+    bool stop, failed;
+} DeltaStepping;
+
+
+/**
+ * Arguments of a worker thread of delta_stepping_sp().
+ */
+typedef struct {
+    DeltaStepping *ds;
+    int id;
+} DeltaWorker;
+
+
+/**
+ * Appends x to the vector, doubling its capacity if needed. Auxiliary function.
+ */
+static bool int_vector_push(IntVector *vec, int x)
+{
+    if(vec->size == vec->capacity) {
+        int capacity = (vec->capacity > 0) ? 2*vec->capacity : 16;
+        int *items = realloc(vec->items, sizeof(int) * capacity);
+        if(items == NULL)
+            return false;
+
+        vec->items = items;
+        vec->capacity = capacity;
+    }
+
+    vec->items[vec->size++] = x;
+    return true;
+}
+
+
+/**
+ * Appends r to the vector, doubling its capacity if needed. Auxiliary function.
+ */
+static bool request_vector_push(RequestVector *vec, RelaxRequest r)
+{
+    if(vec->size == vec->capacity) {
+        int capacity = (vec->capacity > 0) ? 2*vec->capacity : 16;
+        RelaxRequest *items = realloc(vec->items, sizeof(RelaxRequest) * capacity);
+        if(items == NULL)
+            return false;
+
+        vec->items = items;
+        vec->capacity = capacity;
+    }
+
+    vec->items[vec->size++] = r;
+    return true;
+}
+
+
+/**
+ * Marks the search as failed (out of memory). Auxiliary function.
+ */
+static void delta_stepping_fail(DeltaStepping *ds)
+{
+    __atomic_store_n(&ds->failed, true, __ATOMIC_RELAXED);
+}
+
+
+/**
+ * Checks whether some thread marked the search as failed. Auxiliary function.
+ */
+static bool delta_stepping_failed(DeltaStepping *ds)
+{
+    return __atomic_load_n(&ds->failed, __ATOMIC_RELAXED);
+}
+
+
+/**
+ *      Runs, as the thread t, one phase of delta_stepping_sp(): first, the 
+ * light (or heavy) edges leaving the t-th chunk of the vertices in ds->work are 
+ * turned into relaxation requests; then, after all the threads are done, the 
+ * thread t applies the requests for the vertices it owns. Since each vertex is 
+ * owned by a single thread and nobody writes to the distances while the 
+ * requests are generated, no locks are needed. If the search has failed, the 
+ * thread skips its work but still waits at the barriers. Auxiliary function.
+ */
+static void delta_stepping_phase(DeltaStepping *ds, int t)
+{
+    int T = ds->team.nthreads, 
+        lo = (int) ((long long) ds->work_size * t / T), 
+        hi = (int) ((long long) ds->work_size * (t + 1) / T);
+
+    for(int o = 0; o < T; o++)
+        ds->requests[t*T + o].size = 0;
+
+    // generates the requests
+    for(int i = lo; i < hi && !delta_stepping_failed(ds); i++) {
+        int v = ds->work[i];
+        int first = ds->heavy ? ds->split[v] : ds->offset[v],
+            last = ds->heavy ? ds->offset[v + 1] : ds->split[v];
+
+        for(int e = first; e < last; e++) {
+            int w = ds->to[e];
+            double d = ds->dist[v] + ds->weight[e];
+            if(d < ds->dist[w]) {
+                RelaxRequest r = {w, v, e, d};
+                if(!request_vector_push(&ds->requests[t*T + w % T], r)) {
+                    delta_stepping_fail(ds);
+                    break;
+                }
+            }
+        }
+    }
+
+    pthread_barrier_wait(&ds->team.barrier);
+
+    // applies the requests for the vertices owned by this thread
+    ds->moved[t].size = 0;
+    for(int p = 0; p < T && !delta_stepping_failed(ds); p++) {
+        RequestVector *reqs = &ds->requests[p*T + t];
+        for(int i = 0; i < reqs->size; i++) {
+            RelaxRequest r = reqs->items[i];
+            if(r.dist < ds->dist[r.to]) {
+                ds->dist[r.to] = r.dist;
+                ds->pred[r.to] = r.from;
+                ds->pred_edge[r.to] = r.edge;
+                if(!int_vector_push(&ds->moved[t], r.to)) {
+                    delta_stepping_fail(ds);
+                    break;
+                }
+            }
+        }
+    }
+
+    pthread_barrier_wait(&ds->team.barrier);
+}
+
+
+/**
+ * Main loop of the worker threads of delta_stepping_sp(). 
+ */
+static void* delta_stepping_worker(void *arg)
+{
+    DeltaWorker *worker = arg;
+    DeltaStepping *ds = worker->ds;
+
+    team_wait(&ds->team);
+    while(1) {
+        pthread_barrier_wait(&ds->team.barrier);    // waits for a new phase
+        if(ds->stop)
+            break;
+        delta_stepping_phase(ds, worker->id);
+    }
+
+    return NULL;
+}
+
+
+/**
+ *      Runs a phase of delta_stepping_sp() on all threads (the calling thread 
+ * works as the thread 0) and then moves the vertices whose distances changed to
+ * their new buckets. Returns false if the search failed (out of memory). 
+ * Auxiliary function.
+ */
+static bool delta_stepping_run(DeltaStepping *ds, IntVector *work, bool heavy, 
+                               IntVector *buckets, int num_buckets)
+{
+    ds->work = work->items;
+    ds->work_size = work->size;
+    ds->heavy = heavy;
+
+    pthread_barrier_wait(&ds->team.barrier);    // wakes the workers up
+    delta_stepping_phase(ds, 0);
+    if(delta_stepping_failed(ds))
+        return false;
+
+    for(int t = 0; t < ds->team.nthreads; t++) {
+        for(int i = 0; i < ds->moved[t].size; i++) {
+            int w = ds->moved[t].items[i];
+            if(!int_vector_push(&buckets[(long long) (ds->dist[w] / ds->delta) % num_buckets], w)) {
+                delta_stepping_fail(ds);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ *      Freezes the edges of the graph (or of the snapshot, if csr isn't NULL) 
+ * into the flat arrays of ds, splitting them into light and heavy ones. If 
+ * ds->delta is so narrow that there would be more than SP_DELTA_MAX_BUCKETS 
+ * buckets, it's widened first (a narrower delta would only add empty buckets).
+ * Returns the greatest weight among the edges or a negative value if the 
+ * memory couldn't be allocated. Auxiliary function.
+ */
+static double delta_stepping_freeze(DeltaStepping *ds, Graph *g, CSRGraph *csr)
+{
+    int m = (csr != NULL) ? csr_num_edges(csr) : graph_num_edges(g);
+    ds->offset = malloc(sizeof(int) * (ds->size + 1));
+    ds->split = malloc(sizeof(int) * ds->size);
+    ds->to = malloc(sizeof(int) * (m > 0 ? m : 1));
+    ds->weight = malloc(sizeof(double) * (m > 0 ? m : 1));
+
+    if(ds->offset == NULL || ds->split == NULL || ds->to == NULL || ds->weight == NULL)
+        return -1;
+
+    double max_weight = 0;
+    int pos = 0;
+    for(int v = 0; v < ds->size; v++) {
+        ds->offset[v] = pos;
+
+        int x;
+        double w;
+        EdgeScan sc = scan_begin(g, csr, v);
+        while(scan_next(&sc, &x, &w)) {
+            ds->to[pos] = x;
+            ds->weight[pos++] = w;
+            if(w > max_weight)
+                max_weight = w;
+        }
+    }
+    ds->offset[ds->size] = pos;
+
+    if(max_weight / ds->delta > SP_DELTA_MAX_BUCKETS)
+        ds->delta = max_weight / SP_DELTA_MAX_BUCKETS;
+
+    // light edges first, heavy edges last
+    for(int v = 0; v < ds->size; v++) {
+        int lo = ds->offset[v], hi = ds->offset[v + 1];
+        while(lo < hi) {
+            if(ds->weight[lo] <= ds->delta) {
+                lo++;
+                continue;
+            }
+
+            hi--;
+            int x = ds->to[lo];
+            double w = ds->weight[lo];
+            ds->to[lo] = ds->to[hi];
+            ds->weight[lo] = ds->weight[hi];
+            ds->to[hi] = x;
+            ds->weight[hi] = w;
+        }
+        ds->split[v] = lo;
+    }
+
+    return max_weight;
+}
+
+
+/**
+ *      Picks a width for the buckets of delta_stepping_sp() when the caller 
+ * doesn't choose one: the greatest edge weight divided by the average degree
+ * of the vertices (Meyer & Sanders, 2003). Reads the snapshot csr instead of 
+ * the graph if it isn't NULL. Auxiliary function.
+ */
+static double default_delta(Graph *g, CSRGraph *csr)
+{
+    int size = (csr != NULL) ? csr_size(csr) : graph_array_size(g),
+        n = (csr != NULL) ? csr_num_vertices(csr) : graph_num_vertices(g),
+        m = (csr != NULL) ? csr_num_edges(csr) : graph_num_edges(g);
+
+    double max_weight = 0;
+    for(int v = 0; v < size; v++) {
+        int x;
+        double w;
+        EdgeScan sc = scan_begin(g, csr, v);
+        while(scan_next(&sc, &x, &w)) {
+            if(w > max_weight)
+                max_weight = w;
+        }
+    }
+
+    double avg_degree = (n > 0) ? (double) m / n : 1;
+    double delta = max_weight / (avg_degree > 1 ? avg_degree : 1);
+    return (delta > 0) ? delta : 1;
+}
+
+
+/**
+ *      Frees the memory allocated by the state of delta_stepping_sp(). 
+ * Auxiliary function.
+ */
+static void delta_stepping_free(DeltaStepping *ds)
+{
+    free(ds->offset);  free(ds->split);  free(ds->to);  free(ds->weight);
+    free(ds->dist);  free(ds->pred);  free(ds->pred_edge);
+
+    if(ds->requests != NULL) {
+        for(int i = 0; i < ds->max_threads * ds->max_threads; i++)
+            free(ds->requests[i].items);
+        free(ds->requests);
+    }
+
+    if(ds->moved != NULL) {
+        for(int t = 0; t < ds->max_threads; t++)
+            free(ds->moved[t].items);
+        free(ds->moved);
+    }
+}
+
+
+/**
+ *      Delta-stepping on the graph g or, if csr isn't NULL, on the snapshot csr
+ * (see delta_stepping_sp()). Auxiliary function.
+ */
+static SPT* delta_stepping_search(Graph *g, CSRGraph *csr, int s, double delta, int nthreads)
+{
+    DeltaStepping ds = {0};
+    ds.size = (csr != NULL) ? csr_size(csr) : graph_array_size(g);
+    ds.max_threads = (nthreads > 0) ? nthreads : 1;
+    ds.delta = (delta > 0) ? delta : default_delta(g, csr);
+
+    double max_weight = delta_stepping_freeze(&ds, g, csr);
+    ds.dist = malloc(sizeof(double) * ds.size);
+    ds.pred = malloc(sizeof(int) * ds.size);
+    ds.pred_edge = malloc(sizeof(int) * ds.size);
+    ds.requests = calloc(ds.max_threads * ds.max_threads, sizeof(RequestVector));
+    ds.moved = calloc(ds.max_threads, sizeof(IntVector));
+
+    // cyclic array of buckets: every tentative distance is lower than 
+    // (current bucket + 1)*delta + max_weight
+    int num_buckets = (int) (max_weight / ds.delta) + 2;
+    IntVector *buckets = calloc(num_buckets, sizeof(IntVector)),
+              frontier = {0}, removed = {0};
+    int *frontier_stamp = malloc(sizeof(int) * ds.size),
+        *removed_stamp = malloc(sizeof(int) * ds.size);
+    pthread_t *threads = malloc(sizeof(pthread_t) * ds.max_threads);
+    DeltaWorker *workers = malloc(sizeof(DeltaWorker) * ds.max_threads);
+
+    SPT *spt = NULL;
+    if(max_weight < 0 || ds.dist == NULL || ds.pred == NULL || ds.pred_edge == NULL 
+            || ds.requests == NULL || ds.moved == NULL || buckets == NULL 
+            || frontier_stamp == NULL || removed_stamp == NULL 
+            || threads == NULL || workers == NULL)
+        goto cleanup;
+
+    for(int v = 0; v < ds.size; v++) {
+        ds.dist[v] = INFINITY;
+        ds.pred[v] = ds.pred_edge[v] = -1;
+        frontier_stamp[v] = removed_stamp[v] = -1;
+    }
+    ds.dist[s] = 0;
+    if(!int_vector_push(&buckets[0], s))
+        goto cleanup;
+
+    // starts the worker threads (the search runs with the ones that could be created)
+    for(int t = 0; t < ds.max_threads; t++) {
+        workers[t].ds = &ds;
+        workers[t].id = t;
+    }
+    team_start(&ds.team, threads, ds.max_threads, &delta_stepping_worker, workers, sizeof(DeltaWorker));
+
+    long long current = 0;
+    int phase = 0, round = 0;
+    while(1) {
+        // finds the next non-empty bucket
+        int k = 0;
+        while(k < num_buckets && buckets[(current + k) % num_buckets].size == 0)
+            k++;
+        if(k == num_buckets)
+            break;  // all the buckets are empty
+        current += k;
+
+        IntVector *bucket = &buckets[current % num_buckets];
+        removed.size = 0;
+
+        // relaxes the light edges until the bucket is empty
+        while(bucket->size > 0) {
+            frontier.size = 0;
+            for(int i = 0; i < bucket->size; i++) {
+                int v = bucket->items[i];
+                if((long long) (ds.dist[v] / ds.delta) != current || frontier_stamp[v] == phase)
+                    continue;   // outdated or repeated entry
+
+                frontier_stamp[v] = phase;
+                if(!int_vector_push(&frontier, v))
+                    delta_stepping_fail(&ds);
+                if(removed_stamp[v] != round) {
+                    removed_stamp[v] = round;
+                    if(!int_vector_push(&removed, v))
+                        delta_stepping_fail(&ds);
+                }
+            }
+            bucket->size = 0;
+            phase++;
+
+            if(delta_stepping_failed(&ds)
+                    || !delta_stepping_run(&ds, &frontier, false, buckets, num_buckets))
+                break;
+        }
+
+        // relaxes the heavy edges of the vertices removed from the bucket
+        if(delta_stepping_failed(&ds)
+                || !delta_stepping_run(&ds, &removed, true, buckets, num_buckets))
+            break;
+        current++;
+        round++;
+    }
+
+    if(!delta_stepping_failed(&ds))
+        spt = spt_create(ds.size, s);
+
+    // stops the worker threads
+    ds.stop = true;
+    pthread_barrier_wait(&ds.team.barrier);
+    team_finish(&ds.team, threads);
+
+    // builds the shortest-paths tree
+    if(spt != NULL) {
+        for(int v = 0; v < ds.size; v++) {
+            spt->dist_to[v] = ds.dist[v];
+            spt->parent[v] = ds.pred[v];
+            if(ds.pred[v] != -1)
+                spt->parent_weight[v] = ds.weight[ds.pred_edge[v]];
+        }
+    }
+
+cleanup:
+    delta_stepping_free(&ds);
+    if(buckets != NULL) {
+        for(int b = 0; b < num_buckets; b++)
+            free(buckets[b].items);
+        free(buckets);
+    }
+    free(frontier.items);  free(removed.items);
+    free(frontier_stamp);  free(removed_stamp);
+    free(threads);  free(workers);
+    return spt;
+}
+
+
+/**
+ *      Implements the delta-stepping algorithm (Meyer & Sanders, 2003), a 
+ * parallel variant of Dijkstra's algorithm. The vertices are kept in buckets 
+ * of width delta according to their tentative distances from the source and 
+ * the buckets are processed in order. Edges are split into light (weight <= 
+ * delta) and heavy ones: the light edges leaving the vertices in the current 
+ * bucket are relaxed repeatedly (they may insert vertices back into it), in 
+ * parallel, until the bucket is empty; then, the heavy edges leaving every 
+ * vertex removed from the bucket are relaxed, also in parallel, just once.
+ * 
+ *      Before the search starts, the graph's edges are frozen into flat arrays,
+ * so the graph must not be changed during the call. Each phase runs on all the
+ * threads: first, every thread generates relaxation requests for a chunk of 
+ * the vertices; then, each thread applies the requests for the vertices it 
+ * owns. The distances are exactly the ones found by dijkstra_sp(). Negative 
+ * weights are not supported.
+ * 
+ * @param g a pointer to the graph (expects a weighted digraph).
+ * @param s the identifier (index) of the source vertex.
+ * @param delta the width of the buckets; pass a value lower than or equal to 0 
+ * to have it chosen from the graph's weights and average degree. It's widened
+ * if the greatest weight would span more than SP_DELTA_MAX_BUCKETS buckets.
+ * @param nthreads number of threads (including the calling thread); if some of
+ * them can't be created, the search runs on the ones that could.
+ * @return a pointer to a SPT object with relevant informations obtained from
+ * the pathfinding algorithm or NULL if the memory couldn't be allocated.
+ */
+SPT* delta_stepping_sp(Graph *g, int s, double delta, int nthreads) {
+    return delta_stepping_search(g, NULL, s, delta, nthreads);
+}
+
+
+/**
+ *      Same as delta_stepping_sp(), but runs on a CSR snapshot of the graph (see
+ * graph_freeze()); the snapshot can be shared by any number of concurrent 
+ * searches, since it's never changed.
+ * 
+ * @param csr a pointer to the snapshot.
+ * @param s the identifier (index) of the source vertex.
+ * @param delta the width of the buckets (see delta_stepping_sp()).
+ * @param nthreads number of threads (including the calling thread).
+ * @return a pointer to a SPT object with relevant informations obtained from
+ * the pathfinding algorithm or NULL if the memory couldn't be allocated.
+ */
+SPT* delta_stepping_sp_csr(CSRGraph *csr, int s, double delta, int nthreads) {
+    return delta_stepping_search(NULL, csr, s, delta, nthreads);
+}
+
+
+/**
+ *      Builds the path s -> ... -> t found by dijkstra_p2p(), through the 
+ * meeting vertex meet, as a list of new edges. pred/pred_weight hold the 
+ * forward tree (the tail and the weight of the edge that led to each vertex) 
+ * and succ/succ_weight the backward tree (the head and the weight of the edge 
+ * leaving each vertex towards t). Auxiliary function.
+ */
+static List* p2p_build_path(int meet, int *pred, double *pred_weight, 
+                            int *succ, double *succ_weight)
+{
+    List *path = list_create();
+
+    // forward half (pushed from the meeting vertex back to s)
+    for(int v = meet; pred[v] != -1; v = pred[v])
+        list_push(path, edge_create(pred[v], v, pred_weight[v]));
+
+    // backward half (appended from the meeting vertex to t)
+    for(int u = meet; succ[u] != -1; u = succ[u])
+        list_append(path, edge_create(u, succ[u], succ_weight[u]));
+
+    return path;
+}
+
+
+/**
+ *      Finds a shortest path from s to t with the bidirectional version of 
+ * Dijkstra's algorithm: one search goes forward from s, over the graph's edges,
+ * and another goes backward from t, over the reversed edges; in each step, the 
+ * search whose next vertex is closer to its origin settles it. While relaxing 
+ * the edges, the shortest known path through any vertex reached by both 
+ * searches (mu) is kept, and the algorithm stops as soon as the sum of the 
+ * keys at the top of both heaps isn't lower than mu. Since each search only has
+ * to cover about half of the distance, far fewer vertices are usually settled 
+ * than by dijkstra_sp(), which explores the whole graph.
+ * 
+ *      The backward search visits the edges arriving at each vertex with 
+ * graph_in_edges() if the graph's in-edge index is enabled; otherwise, the 
+ * reversed edges are gathered, in O(|E|), at the start of the call. Negative
+ * weights are not supported.
+ * 
+ * @param g a pointer to the graph (expects a weighted digraph).
+ * @param s the identifier (index) of the source vertex.
+ * @param t the identifier (index) of the destination vertex.
+ * @param dist if it isn't NULL, the variable pointed by it will receive the 
+ * weight of the path (INFINITY if there is no path).
+ * @return a list with copies of the edges in the path from s to t (an empty 
+ * list if s equals t) or NULL if there is no such path or the memory couldn't 
+ * be allocated.
+ */
+List* dijkstra_p2p(Graph *g, int s, int t, double *dist)
+{
+    int size = graph_array_size(g), m = graph_num_edges(g);
+    if(dist != NULL)
+        *dist = INFINITY;
+    if(!graph_has_vertex(g, s) || !graph_has_vertex(g, t))
+        return NULL;
+
+    // reverse adjacency, if the graph has no in-edge index: the edges arriving 
+    // at w are at [rev_offset[w], rev_offset[w+1])
+    bool indexed = graph_has_in_edges(g);
+    int *rev_offset = NULL, *rev_from = NULL;
+    double *rev_weight = NULL;
+    if(!indexed) {
+        rev_offset = calloc(size + 1, sizeof(int));
+        rev_from = malloc(sizeof(int) * (m > 0 ? m : 1));
+        rev_weight = malloc(sizeof(double) * (m > 0 ? m : 1));
+    }
+
+    double *dist_f = malloc(sizeof(double) * size), 
+           *dist_b = malloc(sizeof(double) * size),
+           *pred_weight = malloc(sizeof(double) * size),
+           *succ_weight = malloc(sizeof(double) * size);
+    int *pred = malloc(sizeof(int) * size), *succ = malloc(sizeof(int) * size);
+    bool *settled_f = calloc(size, sizeof(bool)), 
+         *settled_b = calloc(size, sizeof(bool));
+    IndexedHeap *pq_f = iheap_create(size), *pq_b = iheap_create(size);
+
+    List *path = NULL;
+    if((!indexed && (rev_offset == NULL || rev_from == NULL || rev_weight == NULL))
+            || dist_f == NULL || dist_b == NULL || pred == NULL || pred_weight == NULL 
+            || succ == NULL || succ_weight == NULL || settled_f == NULL || settled_b == NULL 
+            || pq_f == NULL || pq_b == NULL)
+        goto cleanup;
+
+    Edge *e;
+    if(!indexed) {
+        for(int u = 0; u < size; u++) {
+            EdgeIter it = graph_edges_begin(g, u);
+            while(edge_next(&it, &e))
+                rev_offset[edge_dest(e) + 1]++;
+        }
+        for(int w = 0; w < size; w++)
+            rev_offset[w + 1] += rev_offset[w];
+
+        int *fill = pred;  // pred isn't in use yet; it temporarily holds the insertion points
+        for(int w = 0; w < size; w++)
+            fill[w] = rev_offset[w];
+        for(int u = 0; u < size; u++) {
+            EdgeIter it = graph_edges_begin(g, u);
+            while(edge_next(&it, &e)) {
+                int i = fill[edge_dest(e)]++;
+                rev_from[i] = u;
+                rev_weight[i] = edge_weight(e);
+            }
+        }
+    }
+
+    for(int v = 0; v < size; v++) {
+        dist_f[v] = dist_b[v] = INFINITY;
+        pred[v] = succ[v] = -1;
+    }
+    dist_f[s] = dist_b[t] = 0;
+    iheap_insert(pq_f, s, 0);
+    iheap_insert(pq_b, t, 0);
+
+    double mu = (s == t) ? 0 : INFINITY;
+    int meet = (s == t) ? s : -1;
+
+    while(!iheap_empty(pq_f) && !iheap_empty(pq_b) 
+            && iheap_min_priority(pq_f) + iheap_min_priority(pq_b) < mu) {
+        if(iheap_min_priority(pq_f) <= iheap_min_priority(pq_b)) {
+            // forward step
+            int v = iheap_pop_min(pq_f);
+            settled_f[v] = true;
+
+            EdgeIter it = graph_edges_begin(g, v);
+            while(edge_next(&it, &e)) {
+                int w = edge_dest(e);
+                double d = dist_f[v] + edge_weight(e);
+                if(!settled_f[w] && d < dist_f[w]) {
+                    dist_f[w] = d;
+                    pred[w] = v;
+                    pred_weight[w] = edge_weight(e);
+                    if(iheap_contains(pq_f, w))
+                        iheap_decrease_key(pq_f, w, d);
+                    else
+                        iheap_insert(pq_f, w, d);
+                }
+                if(dist_f[w] + dist_b[w] < mu) {
+                    mu = dist_f[w] + dist_b[w];     // w was reached by both searches
+                    meet = w;
+                }
+            }
+        }
+        else {
+            // backward step
+            int w = iheap_pop_min(pq_b);
+            settled_b[w] = true;
+
+            EdgeIter it = graph_in_edges(g, w);     // empty if !indexed
+            int i = indexed ? 0 : rev_offset[w], end = indexed ? 0 : rev_offset[w + 1];
+            while(true) {
+                int u;
+                double weight;
+                if(indexed) {
+                    if(!edge_next(&it, &e))
+                        break;
+                    u = edge_source(e);
+                    weight = edge_weight(e);
+                }
+                else {
+                    if(i == end)
+                        break;
+                    u = rev_from[i];
+                    weight = rev_weight[i++];
+                }
+
+                double d = dist_b[w] + weight;
+                if(!settled_b[u] && d < dist_b[u]) {
+                    dist_b[u] = d;
+                    succ[u] = w;
+                    succ_weight[u] = weight;
+                    if(iheap_contains(pq_b, u))
+                        iheap_decrease_key(pq_b, u, d);
+                    else
+                        iheap_insert(pq_b, u, d);
+                }
+                if(dist_f[u] + dist_b[u] < mu) {
+                    mu = dist_f[u] + dist_b[u];     // u was reached by both searches
+                    meet = u;
+                }
+            }
+        }
+    }
+
+    if(meet != -1) {
+        path = p2p_build_path(meet, pred, pred_weight, succ, succ_weight);
+        if(dist != NULL)
+            *dist = mu;
+    }
+
+cleanup:
+    free(rev_offset);  free(rev_from);  free(rev_weight);
+    free(dist_f);  free(dist_b);  free(pred_weight);  free(succ_weight);
+    free(pred);  free(succ);
+    free(settled_f);  free(settled_b);
+    if(pq_f != NULL)
+        iheap_free(&pq_f);
+    if(pq_b != NULL)
+        iheap_free(&pq_b);
+    return path;
+}
@@ -5,9 +5,34 @@
  *      SPT *spt = dijkstra_sp(g, s);      // shortest paths tree of the graph g with the vertex s as the root
  *      List *path = spt_path_to(spt, v);  // shortest path from s to v
  * 
- * @todo: change the Dijkstra's algorithm implementation to use a heap-based
- * priority queue.
- * @todo: implement the Bellman-Ford algorithm (deals with negative edges weights).
+ * For graphs whose edges have small non-negative integer weights, 
+ * dijkstra_sp_int() (Dial's algorithm) avoids the heap altogether.
+ * 
+ * Graphs with negative edge weights are handled by bellman_ford_sp(), which
+ * also detects negative cycles (see spt_negative_cycle()). On multi-core 
+ * machines, delta_stepping_sp() splits the search among several threads. When 
+ * only the path between two vertices is needed, dijkstra_p2p() is usually much 
+ * faster than building the whole tree; so is astar_sp(), if a good estimate of 
+ * the distances to the target is available. When only the distances to a few 
+ * targets, or within a radius, are needed, dijkstra_sp_bounded() stops early 
+ * and doesn't pay for the size of the graph. Graphs that are built once and 
+ * queried many times can be frozen into a CSR snapshot (see csr_graph.h) and 
+ * searched with dijkstra_sp_csr(), astar_sp_csr(), dijkstra_sp_int_csr(), 
+ * bellman_ford_sp_csr() and delta_stepping_sp_csr(). dijkstra_p2p() has no 
+ * snapshot variant: the snapshot only stores the edges leaving each vertex, so
+ * its backward search would have to rebuild the reversed edges, in O(|E|), on
+ * every query. Neither has dijkstra_sp_linear(), kept only for reference.
+ * 
+ * When the weights change a few at a time, a tree can be repaired instead of
+ * built again:
+ *      graph_set_edge_weight(g, v, w, x);
+ *      spt_apply_edge_update(spt, g, v, w, x);  // only the affected vertices
+ * 
+ * Services that run many searches can avoid allocating (and initializing) a 
+ * new SPT for each one with a workspace, created once per thread:
+ *      SPWorkspace *ws = spw_create(graph_array_size(g));
+ *      spw_dijkstra(ws, g, s);                 // reset in O(1)
+ *      double d = spw_path_dist(ws, v);
  * 
  * @version 1.0
  * @author Gabriel Nogueira (Talendar)
@@ -17,17 +42,35 @@
 #ifndef SHORTEST_PATH_H
     #define SHORTEST_PATH_H
     #include "weighted_digraph.h"
+    #include "csr_graph.h"
     #include "singly_linked_list.h"
     #include <stdbool.h>
 
+    /* Constants */
+    #define SP_INT_MAX_WEIGHT 65536     // greatest edge weight accepted by dijkstra_sp_int() when detecting the weights
+    #define SP_DELTA_MAX_BUCKETS (1 << 20)  // delta_stepping_sp() widens delta if the greatest weight would span more buckets
+
     /* Structs */
     typedef struct ShortestPathsTree SPT;
+    typedef struct ShortestPathsWorkspace SPWorkspace;
 
     /* Memory freers */
     void spt_free(SPT **spt);
 
     /* Pathfinders */
     SPT* dijkstra_sp(Graph *g, int s);
+    SPT* dijkstra_sp_linear(Graph *g, int s);
+    SPT* dijkstra_sp_int(Graph *g, int s, int max_weight);
+    SPT* bellman_ford_sp(Graph *g, int s);
+    SPT* delta_stepping_sp(Graph *g, int s, double delta, int nthreads);
+    List* dijkstra_p2p(Graph *g, int s, int t, double *dist);
+    SPT* astar_sp(Graph *g, int s, int t, double (*h)(int v, void *ctx), void *ctx);
+    SPT* dijkstra_sp_bounded(Graph *g, int s, const int *targets, int ntargets, double max_dist);
+    SPT* dijkstra_sp_csr(CSRGraph *csr, int s);
+    SPT* astar_sp_csr(CSRGraph *csr, int s, int t, double (*h)(int v, void *ctx), void *ctx);
+    SPT* dijkstra_sp_int_csr(CSRGraph *csr, int s, int max_weight);
+    SPT* bellman_ford_sp_csr(CSRGraph *csr, int s);
+    SPT* delta_stepping_sp_csr(CSRGraph *csr, int s, double delta, int nthreads);
 
     /* Queries */
     int spt_source(SPT *spt);
@@ -36,4 +79,26 @@
     bool spt_has_path(SPT *spt, int v);
     List* spt_path_to(SPT *spt, int v);
     double spt_path_dist(SPT *spt, int v);
+    long long spt_num_settled(SPT *spt);
+    long long spt_num_relaxed(SPT *spt);
+
+    bool spt_has_negative_cycle(SPT *spt);
+    List* spt_negative_cycle(SPT *spt);
+
+    /* Updates */
+    bool spt_apply_edge_update(SPT *spt, Graph *g, int v, int w, double new_weight);
+    bool spt_apply_edge_insert(SPT *spt, Graph *g, int v, int w, double weight);
+
+    /* Workspaces */
+    SPWorkspace* spw_create(int size);
+    void spw_free(SPWorkspace **ws);
+    bool spw_dijkstra_full(SPWorkspace *ws, Graph *g, int s, const int *targets, int ntargets, double max_dist);
+    bool spw_dijkstra(SPWorkspace *ws, Graph *g, int s);
+
+    int spw_source(SPWorkspace *ws);
+    bool spw_has_path(SPWorkspace *ws, int v);
+    List* spw_path_to(SPWorkspace *ws, int v);
+    double spw_path_dist(SPWorkspace *ws, int v);
+    long long spw_num_settled(SPWorkspace *ws);
+    long long spw_num_relaxed(SPWorkspace *ws);
 #endif
\ No newline at end of file
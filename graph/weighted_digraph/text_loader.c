@@ -0,0 +1,512 @@
+/**
+ * Fast loader of weighted digraphs stored as text.
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+
+#define _POSIX_C_SOURCE 200112L
+#include "text_loader.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+#define TEXT_MIN_CHUNK_SIZE (1 << 20)    // smaller chunks aren't worth a thread
+#define TEXT_INITIAL_CAPACITY 4096       // initial size of a chunk's arrays
+#define TEXT_BULK_MIN_EDGES 64           // shorter runs of edges are added one by one
+#define TEXT_MAX_TOKEN 64                // longest number handed to strtod()
+#define TEXT_DETECT_LINES 64             // lines read to guess the format of a file
+
+
+/**
+ *      A command of the file that isn't an edge insertion, kept to be run
+ * between the edges in the order of the file.
+ */
+typedef struct {
+    int cmd, v, w;      // 2 (remove the edge v->w), 3 (add v) or 4 (remove v)
+    size_t at;          // number of edges of the chunk that come before it
+} TextCommand;
+
+
+/**
+ *      A piece of the file, parsed by one thread.
+ *
+ * Attributes:
+ *      . begin, end: the piece of the file ([begin, end), whole lines).
+ *      . src, dst, w: the edges found, in the order of the file.
+ *      . cmds: the other commands found, in the order of the file.
+ *      . stop: whether the command 0 (end of the input) was found.
+ *      . error: whether a line couldn't be parsed.
+ */
+typedef struct {
+    const char *begin, *end;
+    int format;
+
+    int *src, *dst;
+    double *w;
+    size_t num_edges, edges_capacity;
+
+    TextCommand *cmds;
+    size_t num_cmds, cmds_capacity;
+
+    bool stop, error;
+} TextChunk;
+
+
+/**
+ * Powers of ten that are exactly representable as doubles.
+ */
+static const double POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+static inline bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+
+/**
+ * Checks whether the token that was being read ends at s. Auxiliary function.
+ */
+static inline bool token_end(const char *s, const char *end) {
+    return s == end || is_blank(*s) || *s == '\n';
+}
+
+
+/**
+ *      Reads an integer that fits in an int, skipping the blanks before it.
+ *
+ * @param p the position where the reading starts; advanced past the number.
+ * @param end the end of the text.
+ * @param out where the number is written.
+ * @return true if a number was read; false otherwise.
+ */
+static bool parse_int(const char **p, const char *end, int *out)
+{
+    const char *s = *p;
+    bool neg = false;
+    while(s < end && is_blank(*s))
+        s++;
+    if(s < end && (*s == '-' || *s == '+'))
+        neg = *s++ == '-';
+
+    const char *digits = s;
+    long long x = 0;
+    while(s < end && (unsigned) (*s - '0') < 10) {
+        x = 10 * x + (*s - '0');
+        if(x > (long long) INT_MAX + 1)
+            return false;
+        s++;
+    }
+
+    x = neg ? -x : x;
+    if(s == digits || !token_end(s, end) || x > INT_MAX)
+        return false;
+    *out = (int) x;
+    *p = s;
+    return true;
+}
+
+
+/**
+ *      Reads a decimal number, skipping the blanks before it. Numbers with up
+ * to 19 significant digits and exponents (in base 10) up to 22 in absolute
+ * value are converted with a single (correctly rounded) multiplication or
+ * division; the others (and things like "inf") are handed to strtod(). Either
+ * way, the result is the same as the one of scanf("%lf").
+ *
+ * @param p the position where the reading starts; advanced past the number.
+ * @param end the end of the text.
+ * @param out where the number is written.
+ * @return true if a number was read; false otherwise.
+ */
+static bool parse_double(const char **p, const char *end, double *out)
+{
+    const char *s = *p;
+    while(s < end && is_blank(*s))
+        s++;
+
+    const char *start = s;
+    bool neg = false, exact = true, any_digit = false;
+    if(s < end && (*s == '-' || *s == '+'))
+        neg = *s++ == '-';
+
+    uint64_t mant = 0;
+    int digits = 0, exp10 = 0;
+    for(; s < end && (unsigned) (*s - '0') < 10; s++) {
+        any_digit = true;
+        if(digits < 19) {
+            mant = 10 * mant + (*s - '0');
+            digits += mant > 0;
+        }
+        else
+            exact = false;
+    }
+
+    if(s < end && *s == '.') {
+        for(s++; s < end && (unsigned) (*s - '0') < 10; s++) {
+            any_digit = true;
+            if(digits < 19) {
+                mant = 10 * mant + (*s - '0');
+                digits += mant > 0;
+                exp10--;
+            }
+            else
+                exact = false;
+        }
+    }
+
+    if(any_digit && s < end && (*s == 'e' || *s == 'E')) {
+        s++;
+        bool neg_exp = false;
+        if(s < end && (*s == '-' || *s == '+'))
+            neg_exp = *s++ == '-';
+
+        int e = 0;
+        const char *exp_digits = s;
+        for(; s < end && (unsigned) (*s - '0') < 10; s++)
+            e = (e < 10000) ? 10 * e + (*s - '0') : e;
+        if(s == exp_digits)
+            exact = false;
+        exp10 += neg_exp ? -e : e;
+    }
+
+    if(any_digit && exact && token_end(s, end) && mant <= (1ULL << 53) && exp10 >= -22 && exp10 <= 22) {
+        double x = (exp10 < 0) ? mant / POW10[-exp10] : mant * POW10[exp10];
+        *out = neg ? -x : x;
+        *p = s;
+        return true;
+    }
+
+    /* Slow path */
+    s = start;
+    while(!token_end(s, end))
+        s++;
+    if(s - start >= TEXT_MAX_TOKEN)
+        return false;
+
+    char buffer[TEXT_MAX_TOKEN], *parsed_end;
+    memcpy(buffer, start, s - start);
+    buffer[s - start] = '\0';
+    *out = strtod(buffer, &parsed_end);
+    *p = s;
+    return parsed_end == buffer + (s - start) && s > start;
+}
+
+
+/**
+ * Appends an edge to the chunk's arrays, doubling them when full. Edges with
+ * negative vertices are dropped (graph_add_edge() would reject them).
+ */
+static bool chunk_push_edge(TextChunk *c, int s, int d, double w)
+{
+    if(s < 0 || d < 0)
+        return true;
+
+    if(c->num_edges == c->edges_capacity) {
+        size_t capacity = (c->edges_capacity > 0) ? 2 * c->edges_capacity : TEXT_INITIAL_CAPACITY;
+        int *src = realloc(c->src, capacity * sizeof(int));
+        if(src != NULL)  c->src = src;
+        int *dst = realloc(c->dst, capacity * sizeof(int));
+        if(dst != NULL)  c->dst = dst;
+        double *weights = realloc(c->w, capacity * sizeof(double));
+        if(weights != NULL)  c->w = weights;
+
+        if(src == NULL || dst == NULL || weights == NULL)
+            return false;
+        c->edges_capacity = capacity;
+    }
+
+    c->src[c->num_edges] = s;
+    c->dst[c->num_edges] = d;
+    c->w[c->num_edges++] = w;
+    return true;
+}
+
+
+/**
+ * Appends a command (other than the insertion of an edge) to the chunk.
+ */
+static bool chunk_push_cmd(TextChunk *c, int cmd, int v, int w)
+{
+    if(c->num_cmds == c->cmds_capacity) {
+        size_t capacity = (c->cmds_capacity > 0) ? 2 * c->cmds_capacity : 16;
+        TextCommand *cmds = realloc(c->cmds, capacity * sizeof(TextCommand));
+        if(cmds == NULL)
+            return false;
+        c->cmds = cmds;
+        c->cmds_capacity = capacity;
+    }
+
+    c->cmds[c->num_cmds++] = (TextCommand) {cmd, v, w, c->num_edges};
+    return true;
+}
+
+
+/**
+ *      Parses a line in the format of main.c's commands.
+ *
+ * @return false if the line is invalid or the memory couldn't be allocated.
+ */
+static bool parse_command(TextChunk *c, const char **p, const char *end)
+{
+    int cmd, s, d;
+    double w;
+    if(!parse_int(p, end, &cmd))
+        return false;
+
+    switch(cmd) {
+        case 0:
+            c->stop = true;
+            return true;
+        case 1:
+            return parse_int(p, end, &s) && parse_int(p, end, &d) && parse_double(p, end, &w)
+                   && chunk_push_edge(c, s, d, w);
+        case 2:
+            return parse_int(p, end, &s) && parse_int(p, end, &d) && chunk_push_cmd(c, cmd, s, d);
+        case 3:
+        case 4:
+            return parse_int(p, end, &s) && chunk_push_cmd(c, cmd, s, 0);
+        default:
+            if(cmd < 0 || cmd > 9)
+                return false;
+            // queries don't change the graph
+            while(*p < end && **p != '\n')
+                (*p)++;
+            return true;
+    }
+}
+
+
+/**
+ *      Parses the lines of a chunk. Thread routine.
+ */
+static void* parse_chunk(void *arg)
+{
+    TextChunk *c = arg;
+    const char *p = c->begin, *end = c->end;
+
+    while(p < end && !c->stop && !c->error) {
+        while(p < end && is_blank(*p))
+            p++;
+
+        if(p == end || *p == '\n' || *p == '#' || *p == '%') {
+            // empty line or comment
+            const char *nl = memchr(p, '\n', end - p);
+            p = (nl != NULL) ? nl + 1 : end;
+            continue;
+        }
+
+        bool ok;
+        if(c->format == GRAPH_TEXT_COMMANDS)
+            ok = parse_command(c, &p, end);
+        else {
+            int s, d;
+            double w = 1;
+            ok = parse_int(&p, end, &s) && parse_int(&p, end, &d);
+            while(ok && p < end && is_blank(*p))
+                p++;
+            if(ok && p < end && *p != '\n')
+                ok = parse_double(&p, end, &w);
+            ok = ok && chunk_push_edge(c, s, d, w);
+        }
+
+        while(ok && p < end && is_blank(*p))
+            p++;
+        if(!ok || (!c->stop && p < end && *p != '\n'))
+            c->error = true;
+        p++;
+    }
+    return NULL;
+}
+
+
+/**
+ *      Guesses the format of the file from its first lines that aren't empty 
+ * or comments: the commands of main.c if one of them has 1 or 4 fields (edge
+ * lists have 2 or 3); an edge list otherwise.
+ */
+static int detect_format(const char *p, const char *end)
+{
+    for(int lines = 0; p < end && lines < TEXT_DETECT_LINES; ) {
+        const char *nl = memchr(p, '\n', end - p), *line_end = (nl != NULL) ? nl : end;
+        int fields = 0;
+        for(const char *s = p; s < line_end; ) {
+            while(s < line_end && is_blank(*s))
+                s++;
+            if(s == line_end)
+                break;
+            if(fields == 0 && (*s == '#' || *s == '%'))
+                break;
+            fields++;
+            while(s < line_end && !is_blank(*s))
+                s++;
+        }
+
+        if(fields == 1 || fields == 4)
+            return GRAPH_TEXT_COMMANDS;
+        lines += fields > 0;
+        p = line_end + 1;
+    }
+    return GRAPH_TEXT_EDGE_LIST;
+}
+
+
+/**
+ *      Runs, on the graph, the edges and commands of a chunk in the order of
+ * the file. Runs of edges go through graph_add_edges_bulk().
+ */
+static bool apply_chunk(Graph *g, TextChunk *c)
+{
+    size_t done = 0;
+    for(size_t i = 0; i <= c->num_cmds; i++) {
+        size_t at = (i < c->num_cmds) ? c->cmds[i].at : c->num_edges;
+        if(at - done >= TEXT_BULK_MIN_EDGES) {
+            if(!graph_add_edges_bulk(g, c->src + done, c->dst + done, c->w + done, at - done))
+                return false;
+        }
+        else {
+            for(size_t e = done; e < at; e++) {
+                if(!graph_add_edge(g, c->src[e], c->dst[e], c->w[e], true))
+                    return false;
+            }
+        }
+        done = at;
+
+        if(i == c->num_cmds)
+            break;
+        TextCommand *cmd = &c->cmds[i];
+        if(cmd->cmd == 2)
+            graph_remove_edge(g, cmd->v, cmd->w);
+        else if(cmd->cmd == 3)
+            graph_add_vertex(g, cmd->v);
+        else
+            graph_remove_vertex(g, cmd->v);
+    }
+    return true;
+}
+
+
+/**
+ *      Loads a weighted digraph from a text file (see text_loader.h for the
+ * formats). The file is split into up to nthreads chunks, which are parsed
+ * in parallel (the calling thread is one of the workers); the graph is then
+ * built, in the order of the file, by the calling thread.
+ *
+ * @param path the path of the file.
+ * @param format GRAPH_TEXT_COMMANDS, GRAPH_TEXT_EDGE_LIST or GRAPH_TEXT_AUTO
+ * (guesses the format from the first line).
+ * @param nthreads maximum number of threads used to parse the file (chunks
+ * smaller than 1 MB aren't given a thread of their own).
+ * @return a pointer to the new graph or NULL if the file couldn't be read, if
+ * a line (before the end of the input) is invalid or if the memory couldn't be
+ * allocated.
+ */
+Graph* graph_load_text_full(const char *path, int format, int nthreads)
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+        return NULL;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = st.st_size;
+    if(size == 0) {
+        close(fd);
+        return graph_create();
+    }
+
+    char *text = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // the mapping stays valid
+    if(text == MAP_FAILED)
+        return NULL;
+
+    const char *end = text + size;
+    if(format == GRAPH_TEXT_AUTO)
+        format = detect_format(text, end);
+    if(nthreads > (int) (size / TEXT_MIN_CHUNK_SIZE) + 1)
+        nthreads = size / TEXT_MIN_CHUNK_SIZE + 1;
+    if(nthreads < 1)
+        nthreads = 1;
+
+    TextChunk *chunks = calloc(nthreads, sizeof(TextChunk));
+    pthread_t *threads = malloc(sizeof(pthread_t) * nthreads);
+    Graph *g = (chunks != NULL && threads != NULL) ? graph_create() : NULL;
+
+    if(g != NULL) {
+        /* Splitting the file at line boundaries */
+        const char *begin = text;
+        for(int i = 0; i < nthreads; i++) {
+            const char *split = (i == nthreads - 1) ? end : text + size / nthreads * (i + 1);
+            if(split < begin)
+                split = begin;
+            if(split < end && split > text && split[-1] != '\n') {
+                const char *nl = memchr(split, '\n', end - split);
+                split = (nl != NULL) ? nl + 1 : end;
+            }
+
+            chunks[i].begin = begin;
+            chunks[i].end = split;
+            chunks[i].format = format;
+            begin = split;
+        }
+
+        int started = 1;
+        for(; started < nthreads; started++) {
+            if(pthread_create(&threads[started], NULL, &parse_chunk, &chunks[started]) != 0)
+                break;
+        }
+        parse_chunk(&chunks[0]);
+        for(int t = 1; t < started; t++)
+            pthread_join(threads[t], NULL);
+        for(int t = started; t < nthreads; t++)
+            parse_chunk(&chunks[t]);    // threads that couldn't be created
+
+        /* Building the graph */
+        bool ok = true;
+        for(int i = 0; ok && i < nthreads; i++) {
+            ok = !chunks[i].error && apply_chunk(g, &chunks[i]);
+            if(chunks[i].stop)
+                break;
+        }
+        if(!ok)
+            graph_free(&g);
+    }
+
+    for(int i = 0; chunks != NULL && i < nthreads; i++) {
+        free(chunks[i].src);  free(chunks[i].dst);  free(chunks[i].w);
+        free(chunks[i].cmds);
+    }
+    free(chunks);
+    free(threads);
+    munmap(text, size);
+    return g;
+}
+
+
+/**
+ *      Loads a weighted digraph from a text file, guessing its format. Wrapper
+ * for the function graph_load_text_full().
+ *
+ * @param path the path of the file.
+ * @param nthreads maximum number of threads used to parse the file.
+ * @return a pointer to the new graph or NULL if the file couldn't be loaded.
+ */
+Graph* graph_load_text(const char *path, int nthreads) {
+    return graph_load_text_full(path, GRAPH_TEXT_AUTO, nthreads);
+}
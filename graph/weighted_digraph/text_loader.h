@@ -0,0 +1,38 @@
+/**
+ * Fast loader of weighted digraphs stored as text, for files too big to be
+ * read with scanf() (see main.c).
+ *
+ * The file is mapped into memory, split into chunks (at line boundaries) and
+ * each chunk is parsed by a thread with a hand-written scanner of integers and
+ * decimal numbers. The edges are then added to the graph in the order of the
+ * file with graph_add_edges_bulk(), so the adjacency lists come out as if the
+ * lines had been executed one by one.
+ *
+ * Two formats are accepted, with one command or edge per line:
+ *      . GRAPH_TEXT_COMMANDS: the commands of main.c. "1 s d w" adds an edge,
+ *      "2 v w" removes an edge, "3 v" adds a vertex, "4 v" removes a vertex and
+ *      "0" ends the input. The other commands (queries) are skipped.
+ *      . GRAPH_TEXT_EDGE_LIST: lines "s d w" (or "s d", with weight 1).
+ * In both formats, empty lines and lines starting with '#' or '%' (comments)
+ * are skipped.
+ *
+ * Example of use:
+ *      Graph *g = graph_load_text("edges.txt", 8);     // 8 threads
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+#ifndef TEXT_LOADER_H
+    #define TEXT_LOADER_H
+    #include "weighted_digraph.h"
+
+    /* Constants */
+    #define GRAPH_TEXT_AUTO 0         // commands if one of the first lines has 1 or 4 fields; edge list otherwise
+    #define GRAPH_TEXT_COMMANDS 1     // the commands of main.c ("1 s d w", "3 v", ...)
+    #define GRAPH_TEXT_EDGE_LIST 2    // "s d w" or "s d"
+
+    /* Load */
+    Graph* graph_load_text_full(const char *path, int format, int nthreads);
+    Graph* graph_load_text(const char *path, int nthreads);
+#endif
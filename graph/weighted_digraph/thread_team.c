@@ -0,0 +1,80 @@
+/**
+ * Start-up and shutdown of a team of worker threads that synchronize with a
+ * barrier. The team runs with the threads that could be created.
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+
+#define _POSIX_C_SOURCE 200112L
+#include "thread_team.h"
+
+
+/**
+ *      Creates the members 1, ..., nthreads - 1 of the team (the calling thread
+ * is the member 0). The i-th member runs worker with the i-th element of the 
+ * array args (whose elements have arg_size bytes) as its argument. If some 
+ * thread can't be created, no more are tried; then team->nthreads is set to 
+ * the number of threads running, the barrier is initialized with it and the 
+ * workers waiting in team_wait() are released.
+ * 
+ * @param team a pointer to the team.
+ * @param threads an array with room for nthreads identifiers.
+ * @param nthreads number of threads requested (including the calling thread).
+ * @param worker the function run by the created threads.
+ * @param args the arguments of the threads (the element 0, if any, isn't used).
+ * @param arg_size size of each element of args.
+ * @return the number of threads running (at least 1).
+ */
+int team_start(ThreadTeam *team, pthread_t *threads, int nthreads, 
+               void* (*worker)(void *arg), void *args, size_t arg_size)
+{
+    pthread_mutex_init(&team->gate, NULL);
+    pthread_cond_init(&team->gate_open, NULL);
+    team->open = false;
+
+    int started = 1;
+    for(; started < nthreads; started++) {
+        void *arg = (char*) args + started * arg_size;
+        if(pthread_create(&threads[started], NULL, worker, arg) != 0)
+            break;
+    }
+
+    team->nthreads = started;
+    pthread_barrier_init(&team->barrier, NULL, started);
+
+    pthread_mutex_lock(&team->gate);
+    team->open = true;
+    pthread_cond_broadcast(&team->gate_open);
+    pthread_mutex_unlock(&team->gate);
+    return started;
+}
+
+
+/**
+ *      Called by each created member before it touches the barrier (or reads 
+ * team->nthreads): waits until all the members were created.
+ */
+void team_wait(ThreadTeam *team)
+{
+    pthread_mutex_lock(&team->gate);
+    while(!team->open)
+        pthread_cond_wait(&team->gate_open, &team->gate);
+    pthread_mutex_unlock(&team->gate);
+}
+
+
+/**
+ *      Joins the created members of the team (they must be about to return) 
+ * and frees the resources of the team.
+ */
+void team_finish(ThreadTeam *team, pthread_t *threads)
+{
+    for(int t = 1; t < team->nthreads; t++)
+        pthread_join(threads[t], NULL);
+
+    pthread_barrier_destroy(&team->barrier);
+    pthread_mutex_destroy(&team->gate);
+    pthread_cond_destroy(&team->gate_open);
+}
@@ -0,0 +1,42 @@
+/**
+ * Start-up and shutdown of a team of worker threads that synchronize with a
+ * barrier (see delta_stepping_sp(), apsp_floyd_warshall_matrix() and 
+ * mst_boruvka()).
+ *
+ * The calling thread is the member 0 of the team. The other members are 
+ * created by team_start() and wait, in team_wait(), until all of them were 
+ * created; the barrier is then initialized with the number of threads that 
+ * could actually be created, so the work is split among the ones that are 
+ * running instead of failing when the system can't create as many threads as
+ * requested.
+ *
+ * Example of use:
+ *      team_start(&team, threads, nthreads, &worker, args, sizeof(*args));
+ *      ...                                 // the workers call team_wait() first
+ *      team_finish(&team, threads);        // joins the threads
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+#ifndef THREAD_TEAM_H
+    #define THREAD_TEAM_H
+    #include <pthread.h>
+    #include <stdbool.h>
+    #include <stddef.h>
+
+    /* Structs */
+    typedef struct {
+        int nthreads;                   // number of threads running (including the calling thread)
+        pthread_barrier_t barrier;      // initialized with nthreads
+        pthread_mutex_t gate;
+        pthread_cond_t gate_open;
+        bool open;                      // whether the workers may start
+    } ThreadTeam;
+
+    /* Start/Finish */
+    int team_start(ThreadTeam *team, pthread_t *threads, int nthreads, 
+                   void* (*worker)(void *arg), void *args, size_t arg_size);
+    void team_wait(ThreadTeam *team);
+    void team_finish(ThreadTeam *team, pthread_t *threads);
+#endif
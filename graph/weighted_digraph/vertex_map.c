@@ -0,0 +1,249 @@
+/**
+ * Implementation of a hash map from (sparse, 64-bit) vertex keys to slots, with
+ * open addressing and Robin Hood hashing.
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+
+#include "vertex_map.h"
+#include <stdlib.h>
+
+
+/**
+ * A bucket of the map (16 bytes).
+ *
+ * Attributes:
+ *      . key: the vertex's key.
+ *      . slot: the value associated with the key.
+ *      . dist: 0 if the bucket is empty; otherwise, 1 + the distance between
+ *      the bucket and the key's home bucket (the one given by its hash).
+ */
+typedef struct {
+    long long key;
+    int slot, dist;
+} Bucket;
+
+
+/**
+ *      Structure of the map.
+ *
+ * Attributes:
+ *      . buckets: array of buckets.
+ *      . mask: number of buckets - 1 (the number of buckets is a power of 2).
+ *      . size: number of keys in the map.
+ */
+struct VertexHashMap {
+    Bucket *buckets;
+    int mask, size;
+};
+
+
+/**
+ * Mixes the bits of the key (finalizer of splitmix64), so that keys following
+ * a pattern (multiples of 1000, for example) still spread over the buckets.
+ */
+static inline unsigned long long hash_key(long long key)
+{
+    unsigned long long x = (unsigned long long) key;
+    x ^= x >> 30;  x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;  x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+
+/**
+ * Allocates an array of n empty buckets (NULL if the memory couldn't be allocated).
+ */
+static Bucket* buckets_create(int n) {
+    return calloc(n, sizeof(Bucket));
+}
+
+
+/**
+ *      Creates a new empty map and returns a pointer to it.
+ *
+ * @param expected_size number of keys the map will hold without having to 
+ * grow (it may be 0).
+ * @return a pointer to the newly created map if all the required memory could
+ * be allocated; NULL otherwise.
+ */
+VertexMap* vmap_create(int expected_size)
+{
+    int capacity = VMAP_MIN_CAPACITY;
+    while(capacity * VMAP_MAX_LOAD < expected_size)
+        capacity *= 2;
+
+    VertexMap *m = malloc(sizeof(VertexMap));
+    if(m != NULL) {
+        m->buckets = buckets_create(capacity);
+        if(m->buckets == NULL) {
+            free(m);
+            return NULL;
+        }
+
+        m->mask = capacity - 1;
+        m->size = 0;
+    }
+
+    return m;
+}
+
+
+/**
+ * Frees the memory allocated by the map.
+ *
+ * @param m a pointer to the variable that is holding a pointer to the map; by
+ * the end of the call, the variable will be set to NULL.
+ */
+void vmap_free(VertexMap **m)
+{
+    free((*m)->buckets);
+    free(*m);
+    *m = NULL;
+}
+
+
+/**
+ *      Places the entry b in the bucket array, displacing (Robin Hood) the 
+ * entries closer to their home buckets. The key must not be in the array.
+ */
+static void buckets_insert(Bucket *buckets, int mask, Bucket b)
+{
+    int i = hash_key(b.key) & mask;
+    b.dist = 1;
+    while(buckets[i].dist != 0) {
+        if(buckets[i].dist < b.dist) {
+            Bucket t = buckets[i];      // the richer entry gives its place
+            buckets[i] = b;
+            b = t;
+        }
+        i = (i + 1) & mask;
+        b.dist++;
+    }
+    buckets[i] = b;
+}
+
+
+/**
+ * Doubles the number of buckets, reinserting all the keys. Returns false if
+ * the memory couldn't be allocated (the map remains unchanged).
+ */
+static bool vmap_grow(VertexMap *m)
+{
+    int old_capacity = m->mask + 1, capacity = 2 * old_capacity;
+    Bucket *buckets = buckets_create(capacity);
+    if(buckets == NULL)
+        return false;
+
+    for(int i = 0; i < old_capacity; i++) {
+        if(m->buckets[i].dist != 0)
+            buckets_insert(buckets, capacity - 1, m->buckets[i]);
+    }
+
+    free(m->buckets);
+    m->buckets = buckets;
+    m->mask = capacity - 1;
+    return true;
+}
+
+
+/**
+ * Returns the index of the bucket holding the key or -1 if it's not in the map.
+ */
+static int vmap_find(VertexMap *m, long long key)
+{
+    int i = hash_key(key) & m->mask;
+    for(int dist = 1; m->buckets[i].dist >= dist; dist++) {
+        if(m->buckets[i].key == key)
+            return i;
+        i = (i + 1) & m->mask;
+    }
+    return -1;  // an empty bucket or an entry closer to home: the key can't be further
+}
+
+
+/**
+ *      Associates the slot with the key, replacing the previous slot if the key 
+ * was already in the map. Amortized O(1).
+ *
+ * @param m a pointer to the map.
+ * @param key the vertex's key.
+ * @param slot the value to be associated with the key.
+ * @return true if the key is in the map; false if the map had to grow, but the
+ * memory couldn't be allocated.
+ */
+bool vmap_put(VertexMap *m, long long key, int slot)
+{
+    int i = vmap_find(m, key);
+    if(i >= 0) {
+        m->buckets[i].slot = slot;
+        return true;
+    }
+
+    if(m->size + 1 > (m->mask + 1) * VMAP_MAX_LOAD && !vmap_grow(m))
+        return false;
+
+    buckets_insert(m->buckets, m->mask, (Bucket) {key, slot, 0});
+    m->size++;
+    return true;
+}
+
+
+/**
+ *      Removes the key from the map. The entries after it, in the same run of 
+ * buckets, are shifted back one position, so no tombstones are left.
+ *
+ * @param m a pointer to the map.
+ * @param key the vertex's key.
+ * @return true if the key was removed; false if it wasn't in the map.
+ */
+bool vmap_remove(VertexMap *m, long long key)
+{
+    int i = vmap_find(m, key);
+    if(i < 0)
+        return false;
+
+    int next = (i + 1) & m->mask;
+    while(m->buckets[next].dist > 1) {
+        m->buckets[i] = m->buckets[next];
+        m->buckets[i].dist--;
+        i = next;
+        next = (next + 1) & m->mask;
+    }
+
+    m->buckets[i].dist = 0;
+    m->size--;
+    return true;
+}
+
+
+/**
+ *      Returns the slot associated with the key.
+ *
+ * @param m a pointer to the map.
+ * @param key the vertex's key.
+ * @return the slot associated with the key or -1 if it's not in the map.
+ */
+int vmap_get(VertexMap *m, long long key)
+{
+    int i = vmap_find(m, key);
+    return (i >= 0) ? m->buckets[i].slot : -1;
+}
+
+
+/**
+ * Returns the number of keys in the map.
+ */
+int vmap_size(VertexMap *m) {
+    return m->size;
+}
+
+
+/**
+ * Returns the number of bytes allocated by the map.
+ */
+size_t vmap_memory_size(VertexMap *m) {
+    return sizeof(VertexMap) + sizeof(Bucket) * (size_t) (m->mask + 1);
+}
@@ -0,0 +1,46 @@
+/**
+ * Implementation of a hash map from (sparse, 64-bit) vertex keys to slots 
+ * (dense indices of a graph's array of adjacency lists).
+ *
+ * The map uses open addressing with linear probing and Robin Hood hashing: 
+ * while an entry is being inserted, it takes the place of any entry that is 
+ * closer to its home position than the new entry is to its own. This keeps 
+ * the probe sequences short and evenly sized, even with a high load factor, 
+ * and lets a failed lookup stop as soon as it reaches an entry closer to home 
+ * than the key being searched. Removals shift the following entries back 
+ * instead of leaving tombstones.
+ *
+ * Example of use:
+ *      VertexMap *m = vmap_create(0);
+ *      vmap_put(m, 10000000000LL, 0);
+ *      int slot = vmap_get(m, 10000000000LL);     // 0
+ *
+ * @version 1.0
+ * @author Gabriel Nogueira (Talendar)
+ */
+
+#ifndef VERTEX_MAP_H
+    #define VERTEX_MAP_H
+    #include <stdbool.h>
+    #include <stddef.h>
+
+    /* Constants */
+    #define VMAP_MIN_CAPACITY 16      // minimum number of buckets of a map (always a power of 2)
+    #define VMAP_MAX_LOAD 0.875       // the number of buckets doubles when this load factor would be exceeded
+
+    /* Structs */
+    typedef struct VertexHashMap VertexMap;
+
+    /* Create/Free */
+    VertexMap* vmap_create(int expected_size);
+    void vmap_free(VertexMap **m);
+
+    /* Insertions/Removals */
+    bool vmap_put(VertexMap *m, long long key, int slot);
+    bool vmap_remove(VertexMap *m, long long key);
+
+    /* Queries */
+    int vmap_get(VertexMap *m, long long key);
+    int vmap_size(VertexMap *m);
+    size_t vmap_memory_size(VertexMap *m);
+#endif
@@ -2,16 +2,28 @@
  * Implementation of a weighted directed graph. 
  * 
  * Each vertex is identified by it's index in the graph's array of adjacency lists. 
- * Each adjacency list will hold all the edges (with their destinations and weights)
- * leaving the associated vertex. This array's initial size can be chosen by the 
- * client (alternatively, default values can be used, hiding the internal details 
- * from the client). Note that when a vertex v has an ID greater than the graph's 
- * array of adjacency lists, the array must be expanded (memory reallocation) in
- * order to accommodate v. This might be improved later on through the use of hashing.
+ * Each adjacency list is a contiguous, growable array holding the destination 
+ * and the weight of every edge leaving the associated vertex (the source isn't 
+ * stored, since it's the index of the list itself). This array's initial size
+ * can be chosen by the client (alternatively, default values can be used, 
+ * hiding the internal details from the client). Note that when a vertex v has
+ * an ID greater than the graph's array of adjacency lists, the array must be 
+ * expanded (memory reallocation) in order to accommodate v. By default, the 
+ * array doubles in size each time (so n insertions cost O(n) copies in total); 
+ * graph_reserve() allocates it (and the edges' arrays) ahead of a bulk load and
+ * graph_shrink_to_fit() gives the unused memory back.
  * 
- * @todo function to shrink the graph's array of adjacency lists to a desired size.
- * @todo reduce, by the use of hashing, the memory required by the graph to store 
- * its adjacency lists.
+ *      Optionally (see graph_enable_in_edges()), the graph also keeps, for each 
+ * vertex, an array with the edges arriving at it. The index doubles the memory 
+ * used by the edges, but it makes the removal of a vertex proportional to the 
+ * degrees of the vertex and of its neighbours (instead of O(|V| + |E|)) and 
+ * allows reverse traversals (see graph_in_edges()).
+ * 
+ *      Vertices with sparse identifiers (64-bit keys) should be added through 
+ * graph_vertex_slot(), which maps each key to the lowest free index (slot) of 
+ * the array with a hash map (see vertex_map.h): the array's size then depends 
+ * on the number of vertices, not on the highest key. All the other functions 
+ * (and the algorithms of the other modules) work on the slots.
  * 
  * @version 1.0
  * @author Gabriel Nogueira (Talendar)
@@ -19,11 +31,40 @@
 
 
 #include "weighted_digraph.h"
-#include "singly_linked_list.h"
+#include "vertex_map.h"
 #include <stdlib.h>
 #include <stdio.h>
 
 
+/**
+ * An edge as stored in the adjacency list of its source vertex (16 bytes).
+ * 
+ * Attributes:
+ *      . to: the edge's head.
+ *      . weight: the edge's weight.
+ */
+struct AdjEntry {
+    int to;
+    double weight;
+};
+
+
+/**
+ *      Adjacency list of a vertex: a growable array of edges. Its capacity 
+ * doubles every time it's full.
+ * 
+ * Attributes:
+ *      . edges: the edges leaving the vertex (NULL while the capacity is 0).
+ *      . size: number of edges in the array; -1 if the vertex is not in the 
+ *      graph.
+ *      . capacity: number of edges the array can hold before being reallocated.
+ */
+typedef struct {
+    struct AdjEntry *edges;
+    int size, capacity;
+} AdjVector;
+
+
 /**
  *      General structure of a weighted digraph implemented with adjacency lists 
  * that stores edges connecting each pair of adjacent vertices. An array is used 
@@ -31,34 +72,36 @@
  * is full, it's reallocated in order to grow in size.
  * 
  * Attributes:
- *      . adj_lists: array of adjacency lists (lists of edges leaving each vertex); 
- *      each index represents a vertex in the graph; if adj_lists[i] is NULL, then
- *      the vertex i is not in the graph.
+ *      . adj_lists: array of adjacency lists (arrays of edges leaving each 
+ *      vertex); each index represents a vertex in the graph; if 
+ *      adj_lists[i].size is -1, then the vertex i is not in the graph.
+ *      . in_lists: NULL if the in-edge index is disabled; otherwise, an array 
+ *      with the same size as adj_lists holding the edges arriving at each 
+ *      vertex (the attribute "to" of those entries is the edge's tail).
+ *      . key_map: NULL if no vertex was added through a key; otherwise, maps 
+ *      the vertices' keys to their slots.
+ *      . keys: NULL if key_map is NULL; otherwise, an array with the same size
+ *      as adj_lists holding the key of each slot (GRAPH_NO_KEY if the slot 
+ *      isn't associated with a key).
+ *      . next_slot: no slot below it is free (lower bound for the next slot 
+ *      given to a key).
  *      . adj_size: the current size of adj_lists.
- *      . delta_realloc: how much adj_lists will grow in each realloc.
+ *      . delta_realloc: how much adj_lists will grow in each realloc; if it's 
+ *      not positive, the size of adj_lists doubles instead.
+ *      . first_capacity: capacity of a vertex's array of edges when the first
+ *      edge is added to it (set by graph_reserve(), reset by 
+ *      graph_shrink_to_fit()).
  *      . num_vertices: number of vertices in the graph.
  *      . num_edges: number of edges in the graph (parallel edges do NOT count as 
  *      a single edge).
  * 
  */
 struct WeightedDigraph {
-    List **adj_lists;       
-    int adj_size, delta_realloc, 
-        num_vertices, num_edges;          
-};
-
-
-/**
- * General structure of a directed and weighted edge of a graph. 
- * 
- * Attributes:
- *      . from: the edge's tail.
- *      . to: the edge's head.
- *      . weight: the edge's weight.
- */
-struct DirectedWeightedEdge {
-    int from, to;
-    double weight;
+    AdjVector *adj_lists, *in_lists;
+    VertexMap *key_map;
+    long long *keys;
+    int adj_size, delta_realloc, first_capacity,
+        num_vertices, num_edges, next_slot;
 };
 
 
@@ -70,7 +113,8 @@ struct DirectedWeightedEdge {
  * @param initial_size initial size of the graph's adjacency lists array (once 
  * it's full, realloc will be called to increase its size).
  * @param delta_realloc defines how much the graph's adjacency lists array will 
- * grow in each realloc.
+ * grow in each realloc; use ADJL_ARRAY_GEOMETRIC_GROWTH (or any value that 
+ * isn't positive) to double its size instead.
  * @return a pointer to the newly created graph if all the required memory could 
  * be allocated; NULL otherwise.
  */
@@ -78,14 +122,19 @@ Graph* graph_create_full(int initial_size, int delta_realloc)
 {
     Graph *g = malloc(sizeof(Graph));
     if(g != NULL) {
-        g->adj_lists = malloc(initial_size * sizeof(List*));
+        g->adj_lists = malloc(initial_size * sizeof(AdjVector));
 
         if(g->adj_lists != NULL) {
             for(int i = 0; i < initial_size; i++)
-                g->adj_lists[i] = NULL;     // initialising pointers as NULL
+                g->adj_lists[i] = (AdjVector) {NULL, -1, 0};    // no vertices yet
 
+            g->in_lists = NULL;
+            g->key_map = NULL;
+            g->keys = NULL;
+            g->next_slot = 0;
             g->adj_size = initial_size;
             g->delta_realloc = delta_realloc;
+            g->first_capacity = ADJ_VECTOR_INITIAL_CAPACITY;
             g->num_vertices = g->num_edges = 0;
         }
         else {
@@ -120,41 +169,160 @@ Graph* graph_create() {
  */
 void graph_free(Graph **g) {
     for(int i = 0; i < (*g)->adj_size; i++) {
-        if((*g)->adj_lists[i] != NULL)
-            list_free(&((*g)->adj_lists[i]), &free);
+        free((*g)->adj_lists[i].edges);
+        if((*g)->in_lists != NULL)
+            free((*g)->in_lists[i].edges);
     }
 
     free((*g)->adj_lists);
+    free((*g)->in_lists);
+    free((*g)->keys);
+    if((*g)->key_map != NULL)
+        vmap_free(&(*g)->key_map);
     free((*g));
     (*g) = NULL;
 }
 
 
 /**
- * Increases the size of a graph's array of adjacency lists by g->delta_realloc.
+ *      Changes the size of a graph's array of adjacency lists (and of the 
+ * arrays that go along with it). When shrinking, the slots being dropped must 
+ * be empty.
  * 
  * @param g a pointer to the graph.
- * @param num the array will be increased by num*g->delta_realloc.
+ * @param new_size the new size of the array (at least 1).
  * @return true if the operation was successful; false if the memory couldn't be 
- * reallocated (in this case, g->adj_lists will remain unchanged).
+ * reallocated (in this case, g->adj_size will be the smallest of the old and 
+ * the new sizes).
  */
-static bool graph_grow(Graph *g, int num) 
+static bool graph_resize(Graph *g, int new_size) 
 {
-    int new_size = g->adj_size + num*g->delta_realloc;
-    List **new_arr = realloc(g->adj_lists, new_size*sizeof(List*));
+    int old_size = g->adj_size;
+    AdjVector *new_arr = realloc(g->adj_lists, new_size*sizeof(AdjVector));
 
     if(new_arr == NULL)
         return false;    // realloc failed
 
-    for(int i = g->adj_size; i < new_size; i++)
-        new_arr[i] = NULL;
-
+    for(int i = old_size; i < new_size; i++)
+        new_arr[i] = (AdjVector) {NULL, -1, 0};
     g->adj_lists = new_arr;
+    if(new_size < old_size)
+        g->adj_size = new_size;     // the other arrays are, at least, this big
+
+    if(g->in_lists != NULL) {
+        new_arr = realloc(g->in_lists, new_size*sizeof(AdjVector));
+        if(new_arr == NULL)
+            return false;
+
+        for(int i = old_size; i < new_size; i++)
+            new_arr[i] = (AdjVector) {NULL, 0, 0};
+        g->in_lists = new_arr;
+    }
+
+    if(g->keys != NULL) {
+        long long *new_keys = realloc(g->keys, new_size*sizeof(long long));
+        if(new_keys == NULL)
+            return false;
+
+        for(int i = old_size; i < new_size; i++)
+            new_keys[i] = GRAPH_NO_KEY;
+        g->keys = new_keys;
+    }
+
     g->adj_size = new_size;
     return true;
 }
 
 
+/**
+ *      Increases the size of a graph's array of adjacency lists so that it 
+ * holds at least min_size slots: by multiples of g->delta_realloc or, if it 
+ * isn't positive, by doubling its size.
+ * 
+ * @param g a pointer to the graph.
+ * @param min_size minimum size of the array after the call.
+ * @return true if the operation was successful; false if the memory couldn't be 
+ * reallocated (in this case, g->adj_size will remain unchanged).
+ */
+static bool graph_grow(Graph *g, int min_size) 
+{
+    int new_size;
+    if(g->delta_realloc > 0) {
+        int steps = (min_size - g->adj_size + g->delta_realloc - 1) / g->delta_realloc;
+        new_size = g->adj_size + steps * g->delta_realloc;
+    }
+    else {
+        new_size = (g->adj_size > 0) ? 2 * g->adj_size : ADJL_ARRAY_INITIAL_SIZE;
+        if(new_size < min_size)
+            new_size = min_size;
+    }
+
+    return graph_resize(g, new_size);
+}
+
+
+/**
+ *      Appends an edge to an adjacency list, doubling its capacity if it's 
+ * full (amortized O(1)).
+ * 
+ * @param adj a pointer to the adjacency list.
+ * @param w the edge's head.
+ * @param weight the edge's weight.
+ * @param first_capacity the list's capacity if it has none yet.
+ * @return true if the edge was added; false if the memory couldn't be 
+ * reallocated (in this case, the list remains unchanged).
+ */
+static bool adj_push(AdjVector *adj, int w, double weight, int first_capacity)
+{
+    if(adj->size == adj->capacity) {
+        int new_capacity = (adj->capacity > 0) ? 2 * adj->capacity : first_capacity;
+        struct AdjEntry *new_edges = realloc(adj->edges, new_capacity * sizeof(struct AdjEntry));
+        if(new_edges == NULL)
+            return false;
+
+        adj->edges = new_edges;
+        adj->capacity = new_capacity;
+    }
+
+    adj->edges[adj->size++] = (struct AdjEntry) {w, weight};
+    return true;
+}
+
+
+/**
+ *      Removes from an adjacency list all the edges pointing to w, in O(size).
+ * 
+ * @param adj a pointer to the adjacency list.
+ * @param w the head of the edges to be removed.
+ * @param stable if true, the remaining edges keep their relative order; if 
+ * false, each removed edge is replaced by the last one of the list (cheaper, 
+ * since fewer edges are moved).
+ * @return the number of edges removed.
+ */
+static int adj_remove_all(AdjVector *adj, int w, bool stable)
+{
+    int old_size = adj->size;
+    if(stable) {
+        int j = 0;
+        for(int i = 0; i < adj->size; i++) {
+            if(adj->edges[i].to != w)
+                adj->edges[j++] = adj->edges[i];
+        }
+        adj->size = j;
+    }
+    else {
+        for(int i = 0; i < adj->size; ) {
+            if(adj->edges[i].to == w)
+                adj->edges[i] = adj->edges[--adj->size];
+            else
+                i++;
+        }
+    }
+
+    return old_size - adj->size;
+}
+
+
 /**
  * Checks whether the vertex v is in the graph g.
  * 
@@ -165,7 +333,7 @@ static bool graph_grow(Graph *g, int num)
 bool graph_has_vertex(Graph *g, int v) {
     if(v < 0 || v >= g->adj_size)   // checking if the index is out of bounds
         return false;
-    return g->adj_lists[v] != NULL;
+    return g->adj_lists[v].size >= 0;
 }
 
 
@@ -202,7 +370,7 @@ int graph_array_size(Graph *g) {
  * in this implementation will have an adjacency lists array with a size greater 
  * than or equal to the highest indexed vertex added to it. Once a graph's 
  * adjacency lists array is increased in size, it won't automatically be shrunk 
- * back!
+ * back (see graph_shrink_to_fit())!
  * 
  * @param g a pointer to the graph.
  * @param v the identifier (index) of the new vertex.
@@ -211,23 +379,20 @@ int graph_array_size(Graph *g) {
  */
 bool graph_add_vertex(Graph *g, int v) 
 {
+    if(v < 0)
+        return false;
+
     /* Should the size of the graph's array of adjacency lists be increased? */
     if(v >= g->adj_size) {             
-        int n = 1;
-        while(v >= (g->adj_size + (n++) * g->delta_realloc));
-        
-        if(!graph_grow(g, --n))
+        if(!graph_grow(g, v + 1))
             return false;  // realloc failed (graph's adjacency lists array couldn't grow)
     }
     /* Checking if v is already in the graph */
     else if(graph_has_vertex(g, v))
         return false;  // the vertex is already in the graph
 
-    /* Adding the vertex*/
-    g->adj_lists[v] = list_create();
-    if(g->adj_lists[v] == NULL)
-        return false;  // couldn't allocate the needed memory for v's adjacency list
-    
+    /* Adding the vertex (its edges array is only allocated with the first edge) */
+    g->adj_lists[v].size = 0;
     g->num_vertices++;
     return true;
 }
@@ -245,7 +410,8 @@ bool graph_add_vertex(Graph *g, int v)
  * if they do not exist.
  * @return true if the edge was successfuly added. 
  * @return false if: either v or w doesn't exist and create_if_needed is set to 
- * false OR the memory needed to create either v or w couldn't be allocated.
+ * false OR the memory needed to create either v, w or the edge couldn't be 
+ * allocated.
  */
 bool graph_add_edge(Graph *g, int v, int w, double weight, bool create_if_needed) 
 {
@@ -267,50 +433,366 @@ bool graph_add_edge(Graph *g, int v, int w, double weight, bool create_if_needed
     }
 
     /* Adding the edge v->w */
-    Edge *edge = malloc(sizeof(Edge));
-    edge->from = v;  edge->to = w;
-    edge->weight = weight;
+    if(!adj_push(&g->adj_lists[v], w, weight, g->first_capacity))
+        return false;
+    if(g->in_lists != NULL && !adj_push(&g->in_lists[w], v, weight, g->first_capacity)) {
+        g->adj_lists[v].size--;     // undoing the insertion
+        return false;
+    }
 
-    list_append(g->adj_lists[v], edge);
     g->num_edges++;
     return true;
 } 
 
 
 /**
- * @todo NOT IMPLEMENTED 
+ *      Makes room, in each of the given adjacency lists, for the number of 
+ * edges counted for it (count[v] edges for the list v), with at most one 
+ * reallocation per list. Auxiliary function of graph_add_edges_bulk_full().
  * 
- * @param g 
- * @param num 
- * @return true 
- * @return false 
+ * @return true if the memory could be allocated; false otherwise (the lists 
+ * that were already enlarged stay that way).
  */
-static bool graph_shrink(Graph *g, int num) {
-    return false;
+static bool adj_reserve_counts(AdjVector *lists, const int *count, int size)
+{
+    for(int v = 0; v < size; v++) {
+        AdjVector *adj = &lists[v];
+        if(count[v] == 0 || adj->size + count[v] <= adj->capacity)
+            continue;
+
+        int new_capacity = adj->size + count[v];
+        struct AdjEntry *new_edges = realloc(adj->edges, new_capacity * sizeof(struct AdjEntry));
+        if(new_edges == NULL)
+            return false;
+
+        adj->edges = new_edges;
+        adj->capacity = new_capacity;
+    }
+    return true;
 }
 
 
 /**
- * Returns true if the given edge points to the given vertex. Auxiliary function.
+ *      An edge being bulk-inserted (see graph_add_edges_bulk_full()).
+ */
+typedef struct {
+    int src, dst;
+    double weight;
+} BulkEdge;
+
+
+/**
+ *      Sorts the edges by their sources with a (stable) least significant 
+ * digit radix sort, 8 bits per pass, so that the edges of each vertex keep
+ * the order in which they were given.
  * 
- * @param edge the edge; pointer to Edge.
- * @param v the destination vertex's id; pointer to int.
- * @return true if edge->to equals to v.
+ * @param edges the edges to be sorted.
+ * @param tmp an auxiliary array with the same size.
+ * @param n number of edges.
+ * @param max_src the highest source among the edges.
+ * @return the array (edges or tmp) that holds the sorted edges.
+ */
+static BulkEdge* bulk_radix_sort(BulkEdge *edges, BulkEdge *tmp, size_t n, int max_src)
+{
+    for(int shift = 0; shift < 32 && (shift == 0 || (max_src >> shift) > 0); shift += 8) {
+        size_t count[257] = {0};
+        for(size_t i = 0; i < n; i++)
+            count[((edges[i].src >> shift) & 0xFF) + 1]++;
+        for(int d = 0; d < 256; d++)
+            count[d + 1] += count[d];
+
+        for(size_t i = 0; i < n; i++)
+            tmp[count[(edges[i].src >> shift) & 0xFF]++] = edges[i];
+
+        BulkEdge *t = edges;
+        edges = tmp;
+        tmp = t;
+    }
+    return edges;
+}
+
+
+/**
+ *      Adds n weighted directed edges (src[i] -> dst[i], with weight w[i]) to 
+ * the graph at once, creating the vertices that don't exist yet. Instead of n 
+ * calls to graph_add_edge(): the array of adjacency lists grows (at most) once,
+ * the degrees are counted so that the array of edges of each vertex (and of 
+ * the in-edge index) is reallocated (at most) once, and the edges are then 
+ * copied in a single pass. The edges of each vertex are appended in the order
+ * they were given.
+ * 
+ * @param g a pointer to the graph.
+ * @param src the tails of the edges.
+ * @param dst the heads of the edges.
+ * @param w the weights of the edges (if NULL, all the weights are 1).
+ * @param n number of edges.
+ * @param radix_sort whether the edges should be sorted by their sources (with 
+ * a radix sort, using 32 extra bytes per edge) before being copied, so that 
+ * each vertex's edges are written at once instead of in random order. Since 
+ * each vertex has its own array, the direct copy is usually faster (see the 
+ * bulk section of benchmark.c); the sort is meant for inputs with many edges 
+ * per vertex spread over memory much larger than the cache.
+ * @return true if all the edges were added; false if an identifier is negative
+ * (nothing is changed) or if the memory couldn't be allocated (no edge is 
+ * added, but the vertices may have been).
+ */
+bool graph_add_edges_bulk_full(Graph *g, const int *src, const int *dst, const double *w, 
+                               size_t n, bool radix_sort)
+{
+    if(n == 0)
+        return true;
+    if(n > (size_t) INT_MAX - g->num_edges)
+        return false;
+
+    int max_id = -1;
+    for(size_t i = 0; i < n; i++) {
+        if(src[i] < 0 || dst[i] < 0)
+            return false;
+        if(src[i] > max_id)  max_id = src[i];
+        if(dst[i] > max_id)  max_id = dst[i];
+    }
+
+    /* Adding the vertices */
+    if(max_id >= g->adj_size && !graph_grow(g, max_id + 1))
+        return false;
+    for(size_t i = 0; i < n; i++) {
+        if(!graph_has_vertex(g, src[i]))  graph_add_vertex(g, src[i]);
+        if(!graph_has_vertex(g, dst[i]))  graph_add_vertex(g, dst[i]);
+    }
+
+    /* Counting the degrees and making room for the edges */
+    int *count = calloc(g->adj_size, sizeof(int));
+    if(count == NULL)
+        return false;
+
+    for(size_t i = 0; i < n; i++)
+        count[src[i]]++;
+    bool ok = adj_reserve_counts(g->adj_lists, count, g->adj_size);
+
+    if(ok && g->in_lists != NULL) {
+        for(int v = 0; v < g->adj_size; v++)
+            count[v] = 0;
+        for(size_t i = 0; i < n; i++)
+            count[dst[i]]++;
+        ok = adj_reserve_counts(g->in_lists, count, g->adj_size);
+    }
+    free(count);
+
+    BulkEdge *edges = NULL, *tmp = NULL;
+    if(ok && radix_sort) {
+        edges = malloc(sizeof(BulkEdge) * n);
+        tmp = malloc(sizeof(BulkEdge) * n);
+        ok = edges != NULL && tmp != NULL;
+    }
+
+    if(!ok) {
+        free(edges);  free(tmp);
+        return false;
+    }
+
+    /* Copying the edges (no reallocation is needed anymore) */
+    if(radix_sort) {
+        for(size_t i = 0; i < n; i++)
+            edges[i] = (BulkEdge) {src[i], dst[i], (w != NULL) ? w[i] : 1};
+
+        BulkEdge *sorted = bulk_radix_sort(edges, tmp, n, max_id);
+        for(size_t i = 0; i < n; i++) {
+            AdjVector *adj = &g->adj_lists[sorted[i].src];
+            adj->edges[adj->size++] = (struct AdjEntry) {sorted[i].dst, sorted[i].weight};
+        }
+        free(edges);  free(tmp);
+    }
+    else {
+        for(size_t i = 0; i < n; i++) {
+            AdjVector *adj = &g->adj_lists[src[i]];
+            adj->edges[adj->size++] = (struct AdjEntry) {dst[i], (w != NULL) ? w[i] : 1};
+        }
+    }
+
+    if(g->in_lists != NULL) {
+        for(size_t i = 0; i < n; i++) {
+            AdjVector *in = &g->in_lists[dst[i]];
+            in->edges[in->size++] = (struct AdjEntry) {src[i], (w != NULL) ? w[i] : 1};
+        }
+    }
+
+    g->num_edges += (int) n;
+    return true;
+}
+
+
+/**
+ *      Adds n weighted directed edges to the graph at once. Wrapper for the 
+ * function graph_add_edges_bulk_full() (the edges aren't sorted).
+ * 
+ * @param g a pointer to the graph.
+ * @param src the tails of the edges.
+ * @param dst the heads of the edges.
+ * @param w the weights of the edges (if NULL, all the weights are 1).
+ * @param n number of edges.
+ * @return true if all the edges were added; false otherwise (see 
+ * graph_add_edges_bulk_full()).
+ */
+bool graph_add_edges_bulk(Graph *g, const int *src, const int *dst, const double *w, size_t n) {
+    return graph_add_edges_bulk_full(g, src, dst, w, n, false);
+}
+
+
+/**
+ *      Prepares the graph for a bulk load: the array of adjacency lists grows,
+ * at once, to hold the vertices in the range [0, vertices), and the array of 
+ * edges of each vertex that gets its first edge from now on starts with room
+ * for the average degree (edges / vertices) instead of 
+ * ADJ_VECTOR_INITIAL_CAPACITY edges. Nothing is shrunk by this function.
+ * 
+ *      The larger first capacity lasts until the bulk load ends with 
+ * graph_shrink_to_fit(), which restores ADJ_VECTOR_INITIAL_CAPACITY (so the 
+ * vertices added later don't get it); calling graph_reserve() again with 
+ * other numbers replaces it.
+ * 
+ * @param g a pointer to the graph.
+ * @param vertices number of slots of the array of adjacency lists.
+ * @param edges expected number of edges (0 if unknown).
+ * @return true if the operation was successful; false if the memory couldn't be 
+ * allocated.
+ */
+bool graph_reserve(Graph *g, int vertices, int edges)
+{
+    if(vertices > 0 && edges > 0) {
+        int degree = (int) (((long long) edges + vertices - 1) / vertices);
+        g->first_capacity = (degree > ADJ_VECTOR_INITIAL_CAPACITY) ? degree : ADJ_VECTOR_INITIAL_CAPACITY;
+    }
+
+    if(vertices <= g->adj_size)
+        return true;
+    return graph_resize(g, vertices);
+}
+
+
+/**
+ *      Gives back the memory the graph isn't using: the array of adjacency 
+ * lists loses the empty slots after the highest indexed vertex and the arrays 
+ * of edges (including the in-edge index) lose their unused capacity. It also
+ * ends the bulk load started by graph_reserve(): the vertices' arrays of edges 
+ * start again with ADJ_VECTOR_INITIAL_CAPACITY edges.
+ * 
+ * @param g a pointer to the graph.
+ * @return true if the operation was successful; false if some memory couldn't 
+ * be reallocated (the graph remains valid, just not as compact).
+ */
+bool graph_shrink_to_fit(Graph *g)
+{
+    g->first_capacity = ADJ_VECTOR_INITIAL_CAPACITY;
+
+    bool ok = true;
+    for(int v = 0; v < g->adj_size; v++) {
+        AdjVector *lists[2] = {&g->adj_lists[v], (g->in_lists != NULL) ? &g->in_lists[v] : NULL};
+        for(int i = 0; i < 2; i++) {
+            AdjVector *adj = lists[i];
+            if(adj == NULL || adj->capacity <= adj->size)
+                continue;
+
+            if(adj->size <= 0) {
+                free(adj->edges);
+                adj->edges = NULL;
+                adj->capacity = 0;
+            }
+            else {
+                struct AdjEntry *edges = realloc(adj->edges, adj->size * sizeof(struct AdjEntry));
+                if(edges == NULL) {
+                    ok = false;
+                    continue;
+                }
+                adj->edges = edges;
+                adj->capacity = adj->size;
+            }
+        }
+    }
+
+    int new_size = g->adj_size;
+    while(new_size > 1 && !graph_has_vertex(g, new_size - 1))
+        new_size--;
+
+    if(new_size < g->adj_size)
+        ok = graph_resize(g, new_size) && ok;
+    if(g->next_slot > g->adj_size)
+        g->next_slot = g->adj_size;
+    return ok;
+}
+
+
+/**
+ *      Enables the in-edge index: from now on, the graph keeps, for each vertex, 
+ * the edges arriving at it. The index is built in O(|V| + |E|) and then kept 
+ * up to date by the insertions and removals. It can't be disabled.
+ * 
+ * @param g a pointer to the graph.
+ * @return true if the index is enabled; false if the memory couldn't be 
+ * allocated (in this case, the graph remains unchanged).
+ */
+bool graph_enable_in_edges(Graph *g)
+{
+    if(g->in_lists != NULL)
+        return true;
+
+    AdjVector *in = malloc(sizeof(AdjVector) * (g->adj_size > 0 ? g->adj_size : 1));
+    if(in == NULL)
+        return false;
+
+    // the arrays are allocated with their exact final sizes
+    for(int w = 0; w < g->adj_size; w++)
+        in[w] = (AdjVector) {NULL, 0, 0};
+    for(int v = 0; v < g->adj_size; v++) {
+        for(int i = 0; i < g->adj_lists[v].size; i++)
+            in[g->adj_lists[v].edges[i].to].capacity++;
+    }
+
+    bool failed = false;
+    for(int w = 0; w < g->adj_size && !failed; w++) {
+        if(in[w].capacity > 0) {
+            in[w].edges = malloc(sizeof(struct AdjEntry) * in[w].capacity);
+            failed = in[w].edges == NULL;
+        }
+    }
+
+    if(failed) {
+        for(int w = 0; w < g->adj_size; w++)
+            free(in[w].edges);
+        free(in);
+        return false;
+    }
+
+    for(int v = 0; v < g->adj_size; v++) {
+        for(int i = 0; i < g->adj_lists[v].size; i++) {
+            struct AdjEntry *e = &g->adj_lists[v].edges[i];
+            in[e->to].edges[in[e->to].size++] = (struct AdjEntry) {v, e->weight};
+        }
+    }
+
+    g->in_lists = in;
+    return true;
+}
+
+
+/**
+ * Returns true if the graph's in-edge index is enabled.
  */
-static bool is_edge_head(void *edge, void *v) {
-    return ((Edge*) edge)->to == *((int*) v);
+bool graph_has_in_edges(Graph *g) {
+    return g->in_lists != NULL;
 }
 
 
 /**
  * Removes a vertex from the given graph, along with all the edges associated
- * with it.
+ * with it. The edges that remain keep their order. If the in-edge index is 
+ * enabled, only the adjacency lists of v's neighbours are visited; otherwise,
+ * all of them are.
  * 
  * WARNING: be careful when adding/removing vertices from a graph, for the graphs 
  * in this implementation will have an adjacency lists array with a size greater 
  * than or equal to the highest indexed vertex added to it. Once a graph's 
  * adjacency lists array is increased in size, it won't automatically be shrunk 
- * back!
+ * back (see graph_shrink_to_fit())!
  * 
  * @param g pointer to the graph.
  * @param v index that identifies the vertex to be removed.
@@ -321,23 +803,148 @@ bool graph_remove_vertex(Graph *g, int v)
     if(!graph_has_vertex(g, v))
         return false;       // the vertex doesn't exist
 
-    /* Removing v and edges leaving it */
+    AdjVector *out = &g->adj_lists[v];
     g->num_vertices--;
-    g->num_edges -= list_size(g->adj_lists[v]);
+    g->num_edges -= out->size;
+
+    if(g->in_lists != NULL) {
+        /* Removing edges pointing to v, from the lists of their tails */
+        AdjVector *in = &g->in_lists[v];
+        for(int i = 0; i < in->size; i++) {
+            int u = in->edges[i].to;
+            if(u != v)  // self-loops are removed with v's edges
+                g->num_edges -= adj_remove_all(&g->adj_lists[u], v, true);
+        }
+
+        /* Removing the entries of v's edges from the in-lists of their heads */
+        for(int i = 0; i < out->size; i++) {
+            int w = out->edges[i].to;
+            if(w != v)
+                adj_remove_all(&g->in_lists[w], v, false);
+        }
+
+        free(in->edges);
+        *in = (AdjVector) {NULL, 0, 0};
+    }
+    else {
+        /* Removing edges pointing to v */
+        for(int w = 0; w < g->adj_size; w++) {
+            if(w != v && g->adj_lists[w].size > 0) 
+                g->num_edges -= adj_remove_all(&g->adj_lists[w], v, true);
+        }
+    }
 
-    list_free(&g->adj_lists[v], &free);
-    g->adj_lists[v] = NULL;
+    /* Removing v and edges leaving it */
+    free(out->edges);
+    *out = (AdjVector) {NULL, -1, 0};
 
-    /* Removing edges pointing to v */
-    for(int w = 0; w < g->adj_size; w++) {
-        if(g->adj_lists[w] != NULL) 
-            g->num_edges -= list_remove_all(g->adj_lists[w], &v, &is_edge_head, &free);
+    if(g->keys != NULL && g->keys[v] != GRAPH_NO_KEY) {
+        vmap_remove(g->key_map, g->keys[v]);
+        g->keys[v] = GRAPH_NO_KEY;
     }
+    if(v < g->next_slot)
+        g->next_slot = v;
+    return true;
 }
 
 
 /**
- * Removes the edge v->w from the graph. Parallel edges are also removed.
+ *      Returns the slot (index) of the vertex identified by the given key, 
+ * adding the vertex to the graph, in the lowest free slot, if needed. The slot
+ * can then be used with all the other functions. Once the vertex is removed 
+ * (with graph_remove_vertex()), the key is forgotten and the slot may be 
+ * given to another key.
+ * 
+ * @param g a pointer to the graph.
+ * @param key the vertex's key (any value but GRAPH_NO_KEY).
+ * @param create_if_needed whether the vertex should be added to the graph if
+ * there is no vertex with the given key.
+ * @return the vertex's slot or -1 if: there's no vertex with the key and 
+ * create_if_needed is false OR the required memory couldn't be allocated.
+ */
+int graph_vertex_slot(Graph *g, long long key, bool create_if_needed)
+{
+    if(key == GRAPH_NO_KEY)
+        return -1;
+
+    if(g->key_map != NULL) {
+        int slot = vmap_get(g->key_map, key);
+        if(slot >= 0 || !create_if_needed)
+            return slot;
+    }
+    else {
+        if(!create_if_needed)
+            return -1;
+
+        // the map and the array of keys are only created when the first key is used
+        g->key_map = vmap_create(0);
+        g->keys = malloc(sizeof(long long) * (g->adj_size > 0 ? g->adj_size : 1));
+        if(g->key_map == NULL || g->keys == NULL) {
+            if(g->key_map != NULL)
+                vmap_free(&g->key_map);
+            free(g->keys);
+            g->keys = NULL;
+            return -1;
+        }
+
+        for(int i = 0; i < g->adj_size; i++)
+            g->keys[i] = GRAPH_NO_KEY;
+    }
+
+    int slot = g->next_slot;
+    while(graph_has_vertex(g, slot))
+        slot++;
+
+    if(!graph_add_vertex(g, slot))
+        return -1;
+    if(!vmap_put(g->key_map, key, slot)) {
+        graph_remove_vertex(g, slot);
+        return -1;
+    }
+
+    g->keys[slot] = key;
+    g->next_slot = slot + 1;
+    return slot;
+}
+
+
+/**
+ * Returns the key of the vertex in the slot v or GRAPH_NO_KEY if v isn't in 
+ * the graph or if it wasn't added through a key.
+ */
+long long graph_vertex_key(Graph *g, int v) {
+    if(g->keys == NULL || !graph_has_vertex(g, v))
+        return GRAPH_NO_KEY;
+    return g->keys[v];
+}
+
+
+/**
+ *      Adds to the graph a weighted directed edge between the vertices with the 
+ * given keys (see graph_vertex_slot()).
+ * 
+ * @param g a pointer to the graph.
+ * @param v the key of the source vertex (edge's tail).
+ * @param w the key of the destination vertex (edge's head).
+ * @param weight the edge's weight.
+ * @param create_if_needed whether the vertices should be added to the graph 
+ * if they do not exist.
+ * @return true if the edge was successfuly added; false otherwise.
+ */
+bool graph_add_edge_keys(Graph *g, long long v, long long w, double weight, bool create_if_needed)
+{
+    int sv = graph_vertex_slot(g, v, create_if_needed), 
+        sw = graph_vertex_slot(g, w, create_if_needed);
+    if(sv < 0 || sw < 0)
+        return false;
+    return graph_add_edge(g, sv, sw, weight, false);
+}
+
+
+/**
+ *      Removes the edge v->w from the graph. Parallel edges are also removed. 
+ * Each removed edge is replaced by the last edge of v's adjacency list, so the 
+ * order of v's edges changes (see graph_remove_edge_stable()).
  * 
  * @param g pointer to the graph.
  * @param v index that identifies the first vertex.
@@ -348,17 +955,77 @@ bool graph_remove_edge(Graph *g, int v, int w) {
      if(!graph_has_vertex(g, v) || !graph_has_vertex(g, w))
         return false;   // either v or w isn't in the graph!
 
-    int count = list_remove_all(g->adj_lists[v], &w, &is_edge_head, &free);
+    int count = adj_remove_all(&g->adj_lists[v], w, false);
+    if(count > 0 && g->in_lists != NULL)
+        adj_remove_all(&g->in_lists[w], v, false);
     g->num_edges -= count;
     return count > 0;
 }
 
 
+/**
+ *      Same as graph_remove_edge(), but the remaining edges of v keep their 
+ * order (the edges after the removed ones are shifted back).
+ * 
+ * @param g pointer to the graph.
+ * @param v index that identifies the first vertex.
+ * @param w index that identifies the second vertex.
+ * @return true if at least one edge was removed; false otherwise.
+ */
+bool graph_remove_edge_stable(Graph *g, int v, int w) {
+     if(!graph_has_vertex(g, v) || !graph_has_vertex(g, w))
+        return false;   // either v or w isn't in the graph!
+
+    int count = adj_remove_all(&g->adj_lists[v], w, true);
+    if(count > 0 && g->in_lists != NULL)
+        adj_remove_all(&g->in_lists[w], v, false);
+    g->num_edges -= count;
+    return count > 0;
+}
+
+
+/**
+ *      Changes the weight of the edge v->w in place (its position in v's 
+ * adjacency list is kept). Parallel edges get the same weight. Cheaper than 
+ * removing and adding the edge again; see also spt_apply_edge_update(), which
+ * repairs a shortest paths tree after the change.
+ * 
+ * @param g pointer to the graph.
+ * @param v index that identifies the first vertex.
+ * @param w index that identifies the second vertex.
+ * @param weight the new weight of the edge.
+ * @return true if the edge exists; false otherwise.
+ */
+bool graph_set_edge_weight(Graph *g, int v, int w, double weight) 
+{
+    if(!graph_has_vertex(g, v) || !graph_has_vertex(g, w))
+        return false;   // either v or w isn't in the graph!
+
+    bool found = false;
+    AdjVector *out = &g->adj_lists[v];
+    for(int i = 0; i < out->size; i++) {
+        if(out->edges[i].to == w) {
+            out->edges[i].weight = weight;
+            found = true;
+        }
+    }
+
+    if(found && g->in_lists != NULL) {
+        AdjVector *in = &g->in_lists[w];
+        for(int i = 0; i < in->size; i++) {
+            if(in->edges[i].to == v)
+                in->edges[i].weight = weight;
+        }
+    }
+    return found;
+}
+
+
 /**
  *      Returns an array containing the IDs (indices) of all of the graph's 
  * vertices. This function makes it possible for the caller to safely iterate 
  * through a graph from which one or more vertices were removed (remember that 
- * if v was removed from g, than g->adj_lists[v] is NULL, so simply iterating 
+ * if v was removed from g, than g->adj_lists[v] is empty, so simply iterating 
  * through the graph based on the number of vertices it currently have might 
  * lead to undefined behaviour).
  * 
@@ -373,7 +1040,7 @@ int* graph_vertices(Graph *g) {
 
     int i = 0, *arr = malloc(g->num_vertices * sizeof(int));
     for(int v = 0; v < g->adj_size; v++) {
-        if(g->adj_lists[v] != NULL) 
+        if(g->adj_lists[v].size >= 0) 
             arr[i++] = v;
     }
 
@@ -382,21 +1049,35 @@ int* graph_vertices(Graph *g) {
 
 
 /**
- * Returns a pointer to a copy of the given edge.
+ *      Creates a new edge from v to w, not attached to any graph (used, for 
+ * example, to rebuild paths from the indices stored by the pathfinders).
  * 
- * @param e a pointer to the edge being copied.
- * @return a pointer to the copy edge or NULL if the memory couldn't be allocated.
+ * @param v the edge's source vertex.
+ * @param w the edge's destination vertex.
+ * @param weight the edge's weight.
+ * @return a pointer to the edge or NULL if the memory couldn't be allocated.
  */
-Edge* copy_edge(Edge *e)
+Edge* edge_create(int v, int w, double weight)
 {
-    Edge *e_cpy = malloc(sizeof(Edge));
-    if(e_cpy != NULL) {
-        e_cpy->from = e->from;
-        e_cpy->to = e->to;
-        e_cpy->weight = e->weight;
+    Edge *e = malloc(sizeof(Edge));
+    if(e != NULL) {
+        e->from = v;
+        e->to = w;
+        e->weight = weight;
     }
 
-    return e_cpy;
+    return e;
+}
+
+
+/**
+ * Returns a pointer to a copy of the given edge.
+ * 
+ * @param e a pointer to the edge being copied.
+ * @return a pointer to the copy edge or NULL if the memory couldn't be allocated.
+ */
+Edge* copy_edge(Edge *e) {
+    return edge_create(e->from, e->to, e->weight);
 }
 
 
@@ -410,16 +1091,60 @@ Edge* copy_edge(Edge *e)
  */
 int vertex_adj_size(Graph *g, int v) {
     if(graph_has_vertex(g, v))
-        return list_size(g->adj_lists[v]);
+        return g->adj_lists[v].size;
     else 
         return 0;
 }
 
 
+/**
+ *      Returns the number of edges arriving at the vertex v: O(1) if the 
+ * in-edge index is enabled; O(|V| + |E|) otherwise.
+ * 
+ * @param g a pointer to the graph.
+ * @param v the identifier (index) of the vertex.
+ * @return v's in-degree or 0 if it's not in the graph.
+ */
+int vertex_in_degree(Graph *g, int v) 
+{
+    if(!graph_has_vertex(g, v))
+        return 0;
+    if(g->in_lists != NULL)
+        return g->in_lists[v].size;
+
+    int count = 0;
+    for(int u = 0; u < g->adj_size; u++) {
+        for(int i = 0; i < g->adj_lists[u].size; i++)
+            count += g->adj_lists[u].edges[i].to == v;
+    }
+    return count;
+}
+
+
+/**
+ *      Returns the number of bytes allocated by the graph, including the edges,
+ * the in-edge index and the map of keys.
+ */
+size_t graph_memory_size(Graph *g)
+{
+    size_t bytes = sizeof(Graph) + sizeof(AdjVector) * (size_t) g->adj_size;
+    for(int v = 0; v < g->adj_size; v++) {
+        bytes += sizeof(struct AdjEntry) * (size_t) g->adj_lists[v].capacity;
+        if(g->in_lists != NULL)
+            bytes += sizeof(AdjVector) + sizeof(struct AdjEntry) * (size_t) g->in_lists[v].capacity;
+    }
+    if(g->key_map != NULL)
+        bytes += sizeof(long long) * (size_t) g->adj_size + vmap_memory_size(g->key_map);
+
+    return bytes;
+}
+
+
 /**
  *      Returns an array with all the edges leaving the vertex v (i.e. the 
  * adjacency list of v). The array is generated from v's adjacency list, so keep 
- * in mind that this is NOT an O(1) operation!
+ * in mind that this is NOT an O(1) operation! To just visit the edges, prefer 
+ * graph_edges_begin(), which doesn't copy them.
  * 
  * @param g a pointer to the graph.
  * @param v the identifier (index) of vertex v.
@@ -432,24 +1157,96 @@ Edge** edges_from_vertix(Graph *g, int v)
     if(!graph_has_vertex(g, v))
         return NULL;
 
-    int size = list_size(g->adj_lists[v]);
+    int size = g->adj_lists[v].size;
     if(size == 0)  
         return NULL;
 
-    int i = 0; 
     Edge **arr = malloc(size * sizeof(Edge*));
-    Node *n = list_head(g->adj_lists[v]);
+    struct AdjEntry *edges = g->adj_lists[v].edges;
 
-    while(n != NULL) {
-        Edge *edge = list_node_item(n);
-        arr[i++] = copy_edge(edge);
-        n = list_next_node(n);
-    }
+    for(int i = 0; i < size; i++)
+        arr[i] = edge_create(v, edges[i].to, edges[i].weight);
 
     return arr;
 }
 
 
+/**
+ *      Returns an iterator over the edges leaving the vertex v. Unlike 
+ * edges_from_vertix(), nothing is copied or allocated: edge_next() walks v's 
+ * array of edges in place.
+ * 
+ * Example of use:
+ *      Edge *e;
+ *      EdgeIter it = graph_edges_begin(g, v);
+ *      while(edge_next(&it, &e))
+ *          printf("%d -> %d\n", edge_source(e), edge_dest(e));
+ * 
+ * @param g a pointer to the graph.
+ * @param v the identifier (index) of the vertex.
+ * @return the iterator (empty if v doesn't exist in the graph). It's 
+ * invalidated by any change to v's edges.
+ */
+EdgeIter graph_edges_begin(Graph *g, int v) 
+{
+    EdgeIter it = {NULL, NULL, {v, -1, 0}, false};
+    if(graph_has_vertex(g, v)) {
+        it.next = g->adj_lists[v].edges;
+        it.end = it.next + g->adj_lists[v].size;
+    }
+    return it;
+}
+
+
+/**
+ *      Returns an iterator over the edges arriving at the vertex v, in no 
+ * particular order (used with edge_next(), just like graph_edges_begin()). 
+ * Requires the in-edge index (see graph_enable_in_edges()).
+ * 
+ * @param g a pointer to the graph.
+ * @param v the identifier (index) of the vertex.
+ * @return the iterator (empty if v doesn't exist in the graph or if the 
+ * in-edge index is disabled). It's invalidated by any change to the edges 
+ * arriving at v.
+ */
+EdgeIter graph_in_edges(Graph *g, int v) 
+{
+    EdgeIter it = {NULL, NULL, {-1, v, 0}, true};
+    if(g->in_lists != NULL && graph_has_vertex(g, v)) {
+        it.next = g->in_lists[v].edges;
+        it.end = it.next + g->in_lists[v].size;
+    }
+    return it;
+}
+
+
+/**
+ *      Advances the iterator. The edge returned is stored in the iterator 
+ * itself and is overwritten by the next call: it must not be freed (use 
+ * copy_edge() to keep it).
+ * 
+ * @param it a pointer to the iterator.
+ * @param e a pointer to the variable that will receive a pointer to the next
+ * edge.
+ * @return true if there was a next edge; false if all the edges were visited.
+ */
+bool edge_next(EdgeIter *it, Edge **e)
+{
+    if(it->next == it->end)
+        return false;
+
+    if(it->in)
+        it->edge.from = it->next->to;
+    else
+        it->edge.to = it->next->to;
+    it->edge.weight = it->next->weight;
+    it->next++;
+
+    *e = &it->edge;
+    return true;
+}
+
+
 /**
  *      Frees the memory allocated by an array of edges (possibly generated with 
  * the function edges_from_vertix).
@@ -502,16 +1299,7 @@ double edge_weight(Edge *e) {
  * @return size of vertex v's adjacency list.
  */
 int graph_adj_count(Graph *g, int v) {
-    return list_size(g->adj_lists[v]);
-}
-
-
-/**
- * Auxialiary function used by list_print.
- */
-static void print_vertex_adj(void *edge) {
-    Edge *e = edge;
-    printf("(%d, %.1f) ", e->to, e->weight);
+    return g->adj_lists[v].size;
 }
 
 
@@ -520,10 +1308,11 @@ static void print_vertex_adj(void *edge) {
  */
 void graph_print(Graph *g) {
     for(int i = 0; i < g->adj_size; i++) {
-        if(g->adj_lists[i] != NULL) {
+        if(g->adj_lists[i].size >= 0) {
             printf("[%d]: { ", i);
-            list_print(g->adj_lists[i], &print_vertex_adj);
+            for(int j = 0; j < g->adj_lists[i].size; j++)
+                printf("(%d, %.1f) ", g->adj_lists[i].edges[j].to, g->adj_lists[i].edges[j].weight);
             printf("}\n");
         }
     }
-}
\ No newline at end of file
+}
@@ -2,16 +2,18 @@
  * Implementation of a weighted directed graph. 
  * 
  * Each vertex is identified by it's index in the graph's array of adjacency lists. 
- * Each adjacency list will hold all the edges (with their destinations and weights)
- * leaving the associated vertex. This array's initial size can be chosen by the 
+ * Each adjacency list is a contiguous array holding the destination and the weight
+ * of every edge leaving the associated vertex (16 bytes per edge). This array's initial size can be chosen by the 
  * client (alternatively, default values can be used, hiding the internal details 
  * from the client). Note that when a vertex v has an ID greater than the graph's 
  * array of adjacency lists, the array must be expanded (memory reallocation) in
- * order to accommodate v. This might be improved later on through the use of hashing.
+ * order to accommodate v. For sparse identifiers, the vertices can instead be added 
+ * through 64-bit keys (see graph_vertex_slot()), which a hash map associates with 
+ * dense indices (slots).
  * 
- * @todo function to shrink the graph's array of adjacency lists to a desired size.
- * @todo reduce, by the use of hashing, the memory required by the graph to store 
- * its adjacency lists.
+ * By default, the array of adjacency lists doubles in size when it's full. Before
+ * a bulk load, graph_reserve() can allocate it (and the edges' arrays) at once; 
+ * graph_shrink_to_fit() gives the unused memory back and ends the bulk load.
  * 
  * @version 1.0
  * @author Gabriel Nogueira (Talendar)
@@ -20,38 +22,75 @@
 #ifndef WEIGHTED_DIGRAPH_H
     #define WEIGHTED_DIGRAPH_H
     #include <stdbool.h>
+    #include <stddef.h>
+    #include <limits.h>
 
     /* Constants */
     #define ADJL_ARRAY_INITIAL_SIZE 20    // the initial size of a graph's adjacency lists array
-    #define ADJL_ARRAY_DELTA_REALLOC 10   // how much a graph's adjacency lists array will grow in each realloc
+    #define ADJL_ARRAY_GEOMETRIC_GROWTH 0 // delta_realloc that makes a graph's adjacency lists array double in size when full
+    #define ADJL_ARRAY_DELTA_REALLOC ADJL_ARRAY_GEOMETRIC_GROWTH    // default growth of a graph's adjacency lists array
+    #define ADJ_VECTOR_INITIAL_CAPACITY 4 // capacity of a vertex's array of edges when its first edge is added (doubles when full)
+    #define GRAPH_NO_KEY LLONG_MIN        // key of the vertices that weren't added through a key
 
     /* Structs */
     typedef struct WeightedDigraph Graph;
-    typedef struct DirectedWeightedEdge Edge;
+    typedef struct DirectedWeightedEdge {
+        int from, to;           // the edge's tail and head
+        double weight;
+    } Edge;
+    typedef struct {
+        const struct AdjEntry *next, *end;  // edges of the adjacency list not visited yet
+        Edge edge;                          // the last edge handed out by edge_next()
+        bool in;                            // whether the edges visited arrive at the vertex
+    } EdgeIter;
 
     /* Create/Free */
     Graph* graph_create_full(int initial_size, int delta_realloc);
     Graph* graph_create();
     void graph_free(Graph **g);
+    bool graph_reserve(Graph *g, int vertices, int edges);
+    bool graph_shrink_to_fit(Graph *g);
     void free_edges_array(Edge **arr[], int n);
+    Edge* edge_create(int v, int w, double weight);
+
+    /* In-edge index */
+    bool graph_enable_in_edges(Graph *g);
+    bool graph_has_in_edges(Graph *g);
 
     /* Insertions */
     bool graph_add_vertex(Graph *g, int v);
     bool graph_add_edge(Graph *g, int v, int w, double weight, bool create_if_needed);
+    bool graph_add_edges_bulk_full(Graph *g, const int *src, const int *dst, const double *w, 
+                                   size_t n, bool radix_sort);
+    bool graph_add_edges_bulk(Graph *g, const int *src, const int *dst, const double *w, size_t n);
+
+    /* Keyed vertices */
+    int graph_vertex_slot(Graph *g, long long key, bool create_if_needed);
+    long long graph_vertex_key(Graph *g, int v);
+    bool graph_add_edge_keys(Graph *g, long long v, long long w, double weight, bool create_if_needed);
 
     /* Removals */
     bool graph_remove_vertex(Graph *g, int v);
     bool graph_remove_edge(Graph *g, int v, int w);
+    bool graph_remove_edge_stable(Graph *g, int v, int w);
+
+    /* Updates */
+    bool graph_set_edge_weight(Graph *g, int v, int w, double weight);
 
     /* Queries */
     int graph_num_vertices(Graph *g);
     int graph_num_edges(Graph *g);
     int graph_array_size(Graph *g);
+    size_t graph_memory_size(Graph *g);
 
     int vertex_adj_size(Graph *g, int v);
     bool graph_has_vertex(Graph *g, int v);
     int* graph_vertices(Graph *g);
     Edge** edges_from_vertix(Graph *g, int v);
+    EdgeIter graph_edges_begin(Graph *g, int v);
+    EdgeIter graph_in_edges(Graph *g, int v);
+    bool edge_next(EdgeIter *it, Edge **e);
+    int vertex_in_degree(Graph *g, int v);
 
     int edge_source(Edge *e);
     int edge_dest(Edge *e);